@@ -0,0 +1,11 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+// Runtime checks for instruction sets that kernels are compiled for
+// separately. Results are computed once and cached.
+
+// AVX2 and FMA together, with the OS saving YMM registers; the *_avx2
+// kernels use both
+bool cpuSupportsAvx2Fma();
+
+#endif // CPU_FEATURES_H
@@ -0,0 +1,36 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+// Accumulates variable frame times and hands out whole fixed-size steps so
+// simulation code always advances by the same dt regardless of frame rate.
+class FixedTimestep {
+public:
+    explicit FixedTimestep(double stepSeconds = 1.0 / 60.0, int maxStepsPerFrame = 5)
+        : m_step(stepSeconds), m_maxSteps(maxStepsPerFrame) {}
+
+    // Adds the frame time and returns how many fixed steps to run now.
+    // Time beyond maxStepsPerFrame is dropped so a long stall cannot snowball.
+    int advance(double frameSeconds) {
+        m_accumulator += frameSeconds;
+        int steps = 0;
+        while (m_accumulator >= m_step && steps < m_maxSteps) {
+            m_accumulator -= m_step;
+            ++steps;
+        }
+        if (steps == m_maxSteps && m_accumulator >= m_step) {
+            m_accumulator = 0.0;
+        }
+        return steps;
+    }
+
+    double getStep() const { return m_step; }
+    // Fraction of a step left in the accumulator, for render interpolation
+    double getAlpha() const { return m_accumulator / m_step; }
+
+private:
+    double m_step;
+    int m_maxSteps;
+    double m_accumulator = 0.0;
+};
+
+#endif // FIXED_TIMESTEP_H
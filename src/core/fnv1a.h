@@ -0,0 +1,24 @@
+#ifndef FNV1A_H
+#define FNV1A_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit FNV-1a, shared by the data file checksums, string ids and text
+// layout keys. Usable in constant expressions.
+constexpr uint64_t FNV1A_PRIME = 1099511628211ULL;
+constexpr uint64_t FNV1A_OFFSET_BASIS = 14695981039346656037ULL;
+
+constexpr uint64_t fnv1aByte(uint64_t hash, unsigned char byte) {
+    return (hash ^ byte) * FNV1A_PRIME;
+}
+
+// Continues hash over length bytes, so inputs can be hashed in pieces
+constexpr uint64_t fnv1a(const char* data, size_t length, uint64_t hash = FNV1A_OFFSET_BASIS) {
+    for (size_t i = 0; i < length; ++i) {
+        hash = fnv1aByte(hash, static_cast<unsigned char>(data[i]));
+    }
+    return hash;
+}
+
+#endif // FNV1A_H
@@ -0,0 +1,73 @@
+#include "string_id.h"
+#include "../log/log.h"
+
+#include <mutex>
+#include <unordered_map>
+
+#ifndef STRING_ID_NAMES
+#ifdef NDEBUG
+#define STRING_ID_NAMES 0
+#else
+#define STRING_ID_NAMES 1
+#endif
+#endif
+
+#if STRING_ID_NAMES
+namespace {
+
+// Reverse lookup table, only ever written at registration. Node-based so
+// the returned name pointers stay valid as the table grows.
+std::mutex& registryMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::unordered_map<uint64_t, std::string>& registry() {
+    static std::unordered_map<uint64_t, std::string> names;
+    return names;
+}
+
+} // namespace
+#endif
+
+bool registerStringId(StringId id, const char* name, size_t length) {
+    if (!id.isValid()) {
+        return false;
+    }
+#if STRING_ID_NAMES
+    std::lock_guard<std::mutex> lock(registryMutex());
+    auto inserted = registry().emplace(id.getHash(), std::string(name, length));
+    if (!inserted.second && inserted.first->second.compare(0, std::string::npos, name, length) != 0) {
+        return false;
+    }
+#else
+    (void)name;
+    (void)length;
+#endif
+    return true;
+}
+
+StringId internStringId(const std::string& name) {
+    StringId id(name);
+    if (!registerStringId(id, name.data(), name.size())) {
+        const char* existing = getStringIdName(id);
+        LOG_WARN("String id collision: \"{}\" and \"{}\" both hash to {}", name, existing ? existing : "",
+                 id.getHash());
+    }
+    return id;
+}
+
+const char* getStringIdName(StringId id) {
+#if STRING_ID_NAMES
+    std::lock_guard<std::mutex> lock(registryMutex());
+    auto it = registry().find(id.getHash());
+    return (it != registry().end()) ? it->second.c_str() : nullptr;
+#else
+    (void)id;
+    return nullptr;
+#endif
+}
+
+bool stringIdNamesEnabled() {
+    return STRING_ID_NAMES != 0;
+}
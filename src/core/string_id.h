@@ -0,0 +1,66 @@
+#ifndef STRING_ID_H
+#define STRING_ID_H
+
+#include "fnv1a.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Names of assets, events and components as 64-bit FNV-1a hashes.
+//
+// Ids from literals are computed by the compiler, "player"_sid costs
+// nothing at runtime, and comparing or looking them up never touches the
+// characters again. Names only survive in debug builds: registering a name
+// records it for getStringIdName and checks it against every name already
+// registered under the same id, so a collision shows up where the second
+// name is introduced rather than as a wrong lookup later. Release builds
+// keep no table and registration is only the hash.
+//
+// Hash 0 is reserved as the invalid id; no name hashes to it in practice,
+// and registration rejects one that does.
+class StringId {
+public:
+    constexpr StringId() : m_hash(0) {}
+    constexpr explicit StringId(uint64_t hash) : m_hash(hash) {}
+    constexpr StringId(const char* name, size_t length) : m_hash(fnv1a(name, length)) {}
+    explicit StringId(const std::string& name) : m_hash(fnv1a(name.data(), name.size())) {}
+
+    constexpr uint64_t getHash() const { return m_hash; }
+    constexpr bool isValid() const { return m_hash != 0; }
+
+    constexpr bool operator==(StringId other) const { return m_hash == other.m_hash; }
+    constexpr bool operator!=(StringId other) const { return m_hash != other.m_hash; }
+    constexpr bool operator<(StringId other) const { return m_hash < other.m_hash; }
+
+private:
+    uint64_t m_hash;
+};
+
+constexpr StringId operator""_sid(const char* name, size_t length) {
+    return StringId(name, length);
+}
+
+// Records name as the string behind id. Returns false if a different name
+// is already registered under id, or id is the reserved invalid id. Safe
+// to call from any thread; does nothing but the id check in release builds.
+bool registerStringId(StringId id, const char* name, size_t length);
+
+// Hashes name at runtime and registers it, logging a warning on collisions
+StringId internStringId(const std::string& name);
+
+// Registered name of id, or nullptr if unknown or names are compiled out
+const char* getStringIdName(StringId id);
+
+// Whether this build keeps names (debug builds, or STRING_ID_NAMES=1)
+bool stringIdNamesEnabled();
+
+namespace std {
+template <>
+struct hash<StringId> {
+    size_t operator()(StringId id) const { return static_cast<size_t>(id.getHash()); }
+};
+} // namespace std
+
+#endif // STRING_ID_H
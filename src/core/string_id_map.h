@@ -0,0 +1,157 @@
+#ifndef STRING_ID_MAP_H
+#define STRING_ID_MAP_H
+
+#include "string_id.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Open-addressing hash map keyed by StringId.
+//
+// Ids are already hashes, so finding the bucket is a shift and an xor and
+// matching a key is one integer compare: no string hashing, no character
+// compares and no allocation per entry. Keys live in their own array, eight
+// to a cache line, so probing never drags values through the cache; the
+// parallel value array is only touched on a hit. Linear probing with
+// backward-shift deletion keeps probe runs short without tombstones.
+//
+// T must be default constructible and movable. The invalid id is used as
+// the empty marker and cannot be inserted.
+template <typename T>
+class StringIdMap {
+public:
+    StringIdMap() = default;
+    explicit StringIdMap(size_t expectedSize) { reserve(expectedSize); }
+
+    T* find(StringId id) {
+        size_t index = findIndex(id.getHash());
+        return (index != NOT_FOUND) ? &m_values[index] : nullptr;
+    }
+    const T* find(StringId id) const {
+        size_t index = findIndex(id.getHash());
+        return (index != NOT_FOUND) ? &m_values[index] : nullptr;
+    }
+    bool contains(StringId id) const { return findIndex(id.getHash()) != NOT_FOUND; }
+
+    // Adds id unless it is present or invalid, returns whether it was added
+    bool insert(StringId id, T value) {
+        const uint64_t hash = id.getHash();
+        if (hash == EMPTY || findIndex(hash) != NOT_FOUND) {
+            return false;
+        }
+        if ((m_count + 1) * 4 > m_keys.size() * 3) {
+            rehash(m_keys.empty() ? 16 : m_keys.size() * 2);
+        }
+        size_t index = bucketOf(hash);
+        while (m_keys[index] != EMPTY) {
+            index = (index + 1) & m_mask;
+        }
+        m_keys[index] = hash;
+        m_values[index] = std::move(value);
+        ++m_count;
+        return true;
+    }
+
+    bool erase(StringId id) {
+        size_t hole = findIndex(id.getHash());
+        if (hole == NOT_FOUND) {
+            return false;
+        }
+        // Pull later entries of the probe run back unless their home
+        // bucket lies after the hole
+        for (size_t j = (hole + 1) & m_mask; m_keys[j] != EMPTY; j = (j + 1) & m_mask) {
+            size_t home = bucketOf(m_keys[j]);
+            bool staysPut = (hole <= j) ? (home > hole && home <= j) : (home > hole || home <= j);
+            if (!staysPut) {
+                m_keys[hole] = m_keys[j];
+                m_values[hole] = std::move(m_values[j]);
+                hole = j;
+            }
+        }
+        m_keys[hole] = EMPTY;
+        m_values[hole] = T();
+        --m_count;
+        return true;
+    }
+
+    // Makes room for count entries without growing again
+    void reserve(size_t count) {
+        size_t buckets = 16;
+        while (buckets * 3 < count * 4) {
+            buckets *= 2;
+        }
+        if (buckets > m_keys.size()) {
+            rehash(buckets);
+        }
+    }
+
+    void clear() {
+        std::fill(m_keys.begin(), m_keys.end(), EMPTY);
+        std::fill(m_values.begin(), m_values.end(), T());
+        m_count = 0;
+    }
+
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+
+    // Calls func(StringId, T&) for every entry, in no particular order
+    template <typename Func>
+    void forEach(Func func) {
+        for (size_t i = 0; i < m_keys.size(); ++i) {
+            if (m_keys[i] != EMPTY) {
+                func(StringId(m_keys[i]), m_values[i]);
+            }
+        }
+    }
+
+private:
+    static constexpr uint64_t EMPTY = 0;
+    static constexpr size_t NOT_FOUND = ~static_cast<size_t>(0);
+
+    size_t bucketOf(uint64_t hash) const {
+        return static_cast<size_t>(hash ^ (hash >> 32)) & m_mask;
+    }
+
+    size_t findIndex(uint64_t hash) const {
+        if (m_count == 0 || hash == EMPTY) {
+            return NOT_FOUND;
+        }
+        for (size_t index = bucketOf(hash);; index = (index + 1) & m_mask) {
+            if (m_keys[index] == hash) {
+                return index;
+            }
+            if (m_keys[index] == EMPTY) {
+                return NOT_FOUND;
+            }
+        }
+    }
+
+    void rehash(size_t bucketCount) {
+        std::vector<uint64_t> oldKeys(bucketCount, EMPTY);
+        std::vector<T> oldValues(bucketCount);
+        oldKeys.swap(m_keys);
+        oldValues.swap(m_values);
+        m_mask = bucketCount - 1;
+        for (size_t i = 0; i < oldKeys.size(); ++i) {
+            if (oldKeys[i] == EMPTY) {
+                continue;
+            }
+            size_t index = bucketOf(oldKeys[i]);
+            while (m_keys[index] != EMPTY) {
+                index = (index + 1) & m_mask;
+            }
+            m_keys[index] = oldKeys[i];
+            m_values[index] = std::move(oldValues[i]);
+        }
+    }
+
+    std::vector<uint64_t> m_keys;
+    std::vector<T> m_values;
+    size_t m_count = 0;
+    size_t m_mask = 0;
+};
+
+#endif // STRING_ID_MAP_H
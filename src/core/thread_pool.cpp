@@ -0,0 +1,88 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_workers.reserve(threadCount - 1);
+    for (size_t i = 1; i < threadCount; ++i) {
+        m_workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeCondition.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grainSize, const RangeFunc& func) {
+    if (count == 0) {
+        return;
+    }
+    grainSize = std::max<size_t>(1, grainSize);
+
+    // Not worth waking anybody for a single chunk
+    if (m_workers.empty() || count <= grainSize) {
+        func(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_func = &func;
+        m_count = count;
+        m_grainSize = grainSize;
+        m_nextIndex.store(0, std::memory_order_relaxed);
+        m_busyWorkers = m_workers.size();
+        ++m_generation;
+    }
+    m_wakeCondition.notify_all();
+
+    runChunks();
+
+    // Workers still hold a pointer to func, wait until all of them let go
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this] { return m_busyWorkers == 0; });
+    m_func = nullptr;
+}
+
+void ThreadPool::runChunks() {
+    for (;;) {
+        size_t begin = m_nextIndex.fetch_add(m_grainSize, std::memory_order_relaxed);
+        if (begin >= m_count) {
+            break;
+        }
+        size_t end = std::min(begin + m_grainSize, m_count);
+        (*m_func)(begin, end);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeCondition.wait(lock, [&] { return m_stop || m_generation != seenGeneration; });
+            if (m_stop) {
+                return;
+            }
+            seenGeneration = m_generation;
+        }
+
+        runChunks();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_busyWorkers;
+        }
+        m_doneCondition.notify_one();
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that split index ranges between them.
+// The calling thread takes part in every parallelFor, so a pool built with
+// one thread runs everything inline and never spawns a worker.
+class ThreadPool {
+public:
+    // Body of a parallel loop, called with a half-open range [begin, end)
+    using RangeFunc = std::function<void(size_t begin, size_t end)>;
+
+    // threadCount includes the calling thread; 0 picks hardware_concurrency
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Runs func over [0, count) in chunks of at most grainSize and blocks
+    // until every chunk has finished. Not re-entrant.
+    void parallelFor(size_t count, size_t grainSize, const RangeFunc& func);
+
+    size_t getThreadCount() const { return m_workers.size() + 1; }
+
+private:
+    void workerLoop();
+    void runChunks();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeCondition;
+    std::condition_variable m_doneCondition;
+
+    // State of the loop currently being executed
+    const RangeFunc* m_func = nullptr;
+    size_t m_count = 0;
+    size_t m_grainSize = 1;
+    std::atomic<size_t> m_nextIndex{0};
+    size_t m_busyWorkers = 0;
+    uint64_t m_generation = 0;
+    bool m_stop = false;
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,107 @@
+#include "frame_pool.h"
+
+#include <new>
+#include <vector>
+
+namespace {
+
+const size_t CHUNK_SIZE = 64 * 1024;
+const size_t CLASS_COUNT = MAX_POOLED_FRAME / FRAME_ALIGNMENT;
+
+struct FreeFrame {
+    FreeFrame* next;
+};
+
+struct FramePool {
+    FreeFrame* freeLists[CLASS_COUNT] = {};
+    // Unused tail of the newest chunk, shared by every size class
+    char* cursor = nullptr;
+    char* end = nullptr;
+    std::vector<void*> chunks;
+    FramePoolStats stats;
+
+    ~FramePool() {
+        for (void* chunk : chunks) {
+            ::operator delete(chunk, std::align_val_t(FRAME_ALIGNMENT));
+        }
+    }
+};
+
+// The pool itself is not a thread_local object, so it outlives the
+// thread's thread_locals. A Scheduler with static storage is destroyed
+// after the main thread's thread_locals and frees its frames then; if
+// frames are still live when the thread exits, the pool is left for them
+// rather than freed under them.
+thread_local FramePool* threadPool = nullptr;
+thread_local bool threadExiting = false;
+
+struct PoolOwner {
+    ~PoolOwner() {
+        threadExiting = true;
+        if (threadPool && threadPool->stats.liveFrames == 0) {
+            delete threadPool;
+            threadPool = nullptr;
+        }
+    }
+};
+
+FramePool& localPool() {
+    if (!threadPool) {
+        threadPool = new FramePool;
+        if (!threadExiting) {
+            thread_local PoolOwner owner;
+            (void)owner;
+        }
+    }
+    return *threadPool;
+}
+
+size_t sizeClass(size_t size) {
+    return (size + FRAME_ALIGNMENT - 1) / FRAME_ALIGNMENT - 1;
+}
+
+} // namespace
+
+void* allocateCoroutineFrame(size_t size) {
+    FramePool& pool = localPool();
+    if (size > MAX_POOLED_FRAME) {
+        ++pool.stats.heapFrames;
+        ++pool.stats.liveFrames;
+        return ::operator new(size);
+    }
+    const size_t cls = sizeClass(size);
+    ++pool.stats.liveFrames;
+    if (FreeFrame* frame = pool.freeLists[cls]) {
+        pool.freeLists[cls] = frame->next;
+        return frame;
+    }
+    const size_t bytes = (cls + 1) * FRAME_ALIGNMENT;
+    if (static_cast<size_t>(pool.end - pool.cursor) < bytes) {
+        // The leftover tail is dropped; at most one frame's worth per chunk
+        char* chunk = static_cast<char*>(::operator new(CHUNK_SIZE, std::align_val_t(FRAME_ALIGNMENT)));
+        pool.chunks.push_back(chunk);
+        pool.stats.pooledBytes += CHUNK_SIZE;
+        pool.cursor = chunk;
+        pool.end = chunk + CHUNK_SIZE;
+    }
+    void* frame = pool.cursor;
+    pool.cursor += bytes;
+    return frame;
+}
+
+void freeCoroutineFrame(void* frame, size_t size) {
+    FramePool& pool = localPool();
+    --pool.stats.liveFrames;
+    if (size > MAX_POOLED_FRAME) {
+        ::operator delete(frame);
+        return;
+    }
+    const size_t cls = sizeClass(size);
+    FreeFrame* node = static_cast<FreeFrame*>(frame);
+    node->next = pool.freeLists[cls];
+    pool.freeLists[cls] = node;
+}
+
+FramePoolStats getFramePoolStats() {
+    return localPool().stats;
+}
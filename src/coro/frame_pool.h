@@ -0,0 +1,29 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <cstddef>
+
+// Allocator for coroutine frames. Frames are rounded up to whole cache
+// lines and served from per-size free lists carved out of 64 KB chunks, so
+// spawning and finishing a task never touches the general heap once the
+// pool has warmed up, and frames created together sit next to each other.
+// Frames larger than MAX_POOLED_FRAME go to operator new.
+//
+// The pool is per thread. A frame must be freed on the thread that
+// allocated it, which holds for everything driven by a Scheduler.
+constexpr size_t FRAME_ALIGNMENT = 64;
+constexpr size_t MAX_POOLED_FRAME = 1024;
+
+void* allocateCoroutineFrame(size_t size);
+void freeCoroutineFrame(void* frame, size_t size);
+
+struct FramePoolStats {
+    size_t liveFrames = 0;
+    size_t pooledBytes = 0; // Chunk memory owned by the pool
+    size_t heapFrames = 0; // Frames too large for the pool, ever allocated
+};
+
+// Counters of the calling thread's pool
+FramePoolStats getFramePoolStats();
+
+#endif // FRAME_POOL_H
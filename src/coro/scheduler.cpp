@@ -0,0 +1,161 @@
+#include "scheduler.h"
+
+#include <algorithm>
+#if !defined(__GNUC__) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+// How many handles ahead of the one being resumed to prefetch
+const size_t PREFETCH_DISTANCE = 16;
+
+inline void prefetchFrame(void* frame) {
+#if defined(__GNUC__)
+    __builtin_prefetch(frame);
+#elif defined(_M_X64) || defined(_M_IX86)
+    _mm_prefetch(static_cast<const char*>(frame), _MM_HINT_T0);
+#else
+    (void)frame;
+#endif
+}
+
+} // namespace
+
+struct Scheduler::RootPromise {
+    Scheduler* scheduler = nullptr;
+    size_t index = 0; // Position in m_roots
+    std::exception_ptr error;
+
+    // Unlinks the root from the scheduler, then lets the frame free itself
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(RootHandle handle) noexcept {
+            handle.promise().scheduler->finishRoot(handle.promise());
+            return false;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    RootTask get_return_object() { return RootTask{RootHandle::from_promise(*this)}; }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { error = std::current_exception(); }
+
+    static void* operator new(size_t size) { return allocateCoroutineFrame(size); }
+    static void operator delete(void* frame, size_t size) { freeCoroutineFrame(frame, size); }
+};
+
+Scheduler::~Scheduler() {
+    // Destroying a root destroys the task it owns and everything that task
+    // is awaiting, which covers every handle still queued below
+    for (RootHandle root : m_roots) {
+        root.destroy();
+    }
+}
+
+Scheduler::RootTask Scheduler::runRoot(Scheduler& scheduler, Task<void> task) {
+    (void)scheduler; // Reached through the promise
+    co_await task;
+}
+
+void Scheduler::spawn(Task<void> task) {
+    RootHandle root = runRoot(*this, std::move(task)).handle;
+    root.promise().scheduler = this;
+    root.promise().index = m_roots.size();
+    m_roots.push_back(root);
+    m_nextFrame.push_back(root);
+}
+
+void Scheduler::finishRoot(RootPromise& root) {
+    if (root.error && !m_error) {
+        m_error = root.error;
+    }
+    RootHandle last = m_roots.back();
+    last.promise().index = root.index;
+    m_roots[root.index] = last;
+    m_roots.pop_back();
+}
+
+void Scheduler::addTimer(double wakeTime, std::coroutine_handle<> handle) {
+    const uint64_t slot = timerSlot(wakeTime);
+    if (slot - m_wheelSlot < TIMER_WHEEL_SIZE) {
+        m_timerWheel[slot % TIMER_WHEEL_SIZE].push_back(Timer{wakeTime, handle});
+    } else {
+        m_longTimers.push_back(Timer{wakeTime, handle});
+        std::push_heap(m_longTimers.begin(), m_longTimers.end(), laterTimer);
+    }
+}
+
+void Scheduler::collectTimers() {
+    // Every wait in a slot the clock has moved past is due, since none is
+    // placed a full turn of the wheel ahead. The slot the clock is in now
+    // is only partly due.
+    const uint64_t nowSlot = timerSlot(m_time);
+    const uint64_t lastSlot = std::min(nowSlot, m_wheelSlot + TIMER_WHEEL_SIZE - 1);
+    for (uint64_t slot = m_wheelSlot; slot < lastSlot; ++slot) {
+        std::vector<Timer>& timers = m_timerWheel[slot % TIMER_WHEEL_SIZE];
+        for (const Timer& timer : timers) {
+            m_resuming.push_back(timer.handle);
+        }
+        timers.clear();
+    }
+    std::vector<Timer>& current = m_timerWheel[lastSlot % TIMER_WHEEL_SIZE];
+    size_t kept = 0;
+    for (const Timer& timer : current) {
+        if (timer.wakeTime <= m_time) {
+            m_resuming.push_back(timer.handle);
+        } else {
+            current[kept++] = timer;
+        }
+    }
+    current.resize(kept);
+    m_wheelSlot = nowSlot;
+
+    while (!m_longTimers.empty() && m_longTimers.front().wakeTime <= m_time) {
+        m_resuming.push_back(m_longTimers.front().handle);
+        std::pop_heap(m_longTimers.begin(), m_longTimers.end(), laterTimer);
+        m_longTimers.pop_back();
+    }
+}
+
+void Scheduler::update(float dt) {
+    ++m_frame;
+    m_time += dt;
+
+    // Coroutines that suspend during this pass land in m_nextFrame again
+    m_resuming.clear();
+    std::swap(m_resuming, m_nextFrame);
+
+    collectTimers();
+
+    for (size_t i = 0; i < m_loads.size();) {
+        if (m_loads[i].load->isDone()) {
+            m_resuming.push_back(m_loads[i].handle);
+            m_loads[i] = std::move(m_loads.back());
+            m_loads.pop_back();
+        } else {
+            ++i;
+        }
+    }
+
+    // Frames are scattered over the pool, so fetch them ahead of time
+    // instead of stalling on each one in turn
+    const size_t count = m_resuming.size();
+    const std::coroutine_handle<>* handles = m_resuming.data();
+    for (size_t i = 0; i < std::min(count, PREFETCH_DISTANCE); ++i) {
+        prefetchFrame(handles[i].address());
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (i + PREFETCH_DISTANCE < count) {
+            prefetchFrame(handles[i + PREFETCH_DISTANCE].address());
+        }
+        handles[i].resume();
+    }
+    m_resumeCount = count;
+
+    if (m_error) {
+        std::rethrow_exception(std::exchange(m_error, nullptr));
+    }
+}
@@ -0,0 +1,157 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "task.h"
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <vector>
+
+// Completion signal for work finished outside the game thread, such as an
+// asset read on a loader thread. The loader fills in data and calls
+// complete() once; coroutines wait for it with Scheduler::waitFor.
+struct AssetLoad {
+    std::vector<uint8_t> data;
+    bool succeeded = false;
+
+    // Publishes data and succeeded to the game thread
+    void complete(bool success) {
+        succeeded = success;
+        m_done.store(true, std::memory_order_release);
+    }
+    bool isDone() const { return m_done.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<bool> m_done{false};
+};
+
+// Runs gameplay coroutines on the game thread, one update per frame.
+//
+// Suspended coroutines are kept as plain handles in flat arrays rather than
+// linked through their frames, and each update resumes them in one pass
+// that prefetches a few frames ahead, so the cost per resume stays close
+// to the resume itself with a hundred thousand tasks alive. Waits go into
+// a timer wheel, so starting and expiring one is constant time. Tasks run
+// in the order they were queued: next-frame waits first, then expired
+// waits by time slot, then finished loads.
+//
+//     Task<void> blink(Scheduler& scheduler, Light& light) {
+//         for (;;) {
+//             light.on = !light.on;
+//             co_await scheduler.wait(0.5f);
+//         }
+//     }
+//     scheduler.spawn(blink(scheduler, light));
+//
+// Everything runs on the thread calling update(); only AssetLoad may be
+// completed from elsewhere.
+class Scheduler {
+public:
+    Scheduler() = default;
+    ~Scheduler();
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    // Takes ownership of task and starts it in the next update. Finished
+    // tasks are freed right away; tasks still running when the scheduler
+    // is destroyed are destroyed with it.
+    void spawn(Task<void> task);
+
+    // Advances the clock by dt seconds and resumes every coroutine that is
+    // due: those waiting for the next frame, expired waits and finished
+    // loads. The first exception to escape a spawned task is rethrown
+    // here once the pass is complete.
+    void update(float dt);
+
+    // co_await nextFrame() resumes in the next update
+    auto nextFrame() {
+        struct Awaiter {
+            Scheduler& scheduler;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { scheduler.m_nextFrame.push_back(handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+    // co_await wait(seconds) resumes in the first update at or past the
+    // given time, and never in the current one
+    auto wait(float seconds) {
+        struct Awaiter {
+            Scheduler& scheduler;
+            double wakeTime;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { scheduler.addTimer(wakeTime, handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this, m_time + std::max(seconds, 0.0f)};
+    }
+
+    // co_await waitFor(load) resumes in the first update after the load
+    // completes, or carries on at once if it already has
+    auto waitFor(std::shared_ptr<AssetLoad> load) {
+        struct Awaiter {
+            Scheduler& scheduler;
+            std::shared_ptr<AssetLoad> load;
+            bool await_ready() const noexcept { return load->isDone(); }
+            void await_suspend(std::coroutine_handle<> handle) { scheduler.m_loads.push_back(LoadWait{load, handle}); }
+            AssetLoad& await_resume() const noexcept { return *load; }
+        };
+        return Awaiter{*this, std::move(load)};
+    }
+
+    double getTime() const { return m_time; }
+    uint64_t getFrame() const { return m_frame; }
+    size_t getTaskCount() const { return m_roots.size(); }
+    // Coroutines resumed by the last update
+    size_t getResumeCount() const { return m_resumeCount; }
+
+private:
+    // Promise of the wrapper coroutine that owns each spawned task
+    struct RootPromise;
+    using RootHandle = std::coroutine_handle<RootPromise>;
+    struct RootTask {
+        using promise_type = RootPromise;
+        RootHandle handle;
+    };
+
+    struct Timer {
+        double wakeTime;
+        std::coroutine_handle<> handle;
+    };
+
+    // Waits are bucketed into a wheel of short time slots covering the
+    // next few seconds; only longer waits go to a heap
+    static constexpr double TIMER_SLOTS_PER_SECOND = 256.0;
+    static constexpr size_t TIMER_WHEEL_SIZE = 2048;
+
+    struct LoadWait {
+        std::shared_ptr<AssetLoad> load;
+        std::coroutine_handle<> handle;
+    };
+
+    static bool laterTimer(const Timer& a, const Timer& b) { return a.wakeTime > b.wakeTime; }
+    static uint64_t timerSlot(double time) { return static_cast<uint64_t>(time * TIMER_SLOTS_PER_SECOND); }
+    static RootTask runRoot(Scheduler& scheduler, Task<void> task);
+    void finishRoot(RootPromise& root);
+    void addTimer(double wakeTime, std::coroutine_handle<> handle);
+    void collectTimers();
+
+    std::vector<RootHandle> m_roots;
+    std::vector<std::coroutine_handle<>> m_nextFrame;
+    std::vector<std::coroutine_handle<>> m_resuming; // Swapped with m_nextFrame
+    std::vector<std::vector<Timer>> m_timerWheel = std::vector<std::vector<Timer>>(TIMER_WHEEL_SIZE);
+    uint64_t m_wheelSlot = 0; // Slot of the clock as of the last update
+    std::vector<Timer> m_longTimers; // Min-heap on wake time
+    std::vector<LoadWait> m_loads;
+    double m_time = 0.0;
+    uint64_t m_frame = 0;
+    size_t m_resumeCount = 0;
+    std::exception_ptr m_error;
+};
+
+#endif // SCHEDULER_H
@@ -0,0 +1,210 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include "frame_pool.h"
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class Task;
+
+// Shared by the tasks passed to one whenAll. The last task to finish
+// resumes the coroutine that awaited them.
+struct WhenAllLatch {
+    size_t remaining = 0;
+    std::coroutine_handle<> awaiting;
+};
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    WhenAllLatch* latch = nullptr;
+    std::exception_ptr error;
+
+    // Resumes whoever awaited the task, by symmetric transfer so that long
+    // chains of nested tasks do not grow the stack
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            TaskPromiseBase& promise = handle.promise();
+            if (promise.latch) {
+                if (--promise.latch->remaining == 0) {
+                    return promise.latch->awaiting;
+                }
+                return std::noop_coroutine();
+            }
+            if (promise.continuation) {
+                return promise.continuation;
+            }
+            return std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() { error = std::current_exception(); }
+
+    static void* operator new(size_t size) { return allocateCoroutineFrame(size); }
+    static void operator delete(void* frame, size_t size) { freeCoroutineFrame(frame, size); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    template <typename U>
+    void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+
+    T takeResult() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+
+    void takeResult() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+// Lazily started coroutine producing a T. Nothing runs until the task is
+// awaited (or handed to Scheduler::spawn); the awaiting coroutine is
+// resumed directly when the task finishes. Exceptions thrown inside the
+// task are rethrown to whoever awaits it.
+//
+//     Task<int> countdown(Scheduler& scheduler) {
+//         co_await scheduler.wait(3.0f);
+//         co_return 0;
+//     }
+//
+// Tasks own their frame: destroying a suspended task destroys the frame
+// and, through its locals, any tasks it is awaiting.
+template <typename T = void>
+class Task {
+public:
+    using promise_type = TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() = default;
+    explicit Task(Handle handle) : m_handle(handle) {}
+    Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { reset(); }
+
+    bool isValid() const { return static_cast<bool>(m_handle); }
+    bool isDone() const { return m_handle && m_handle.done(); }
+    Handle getHandle() const { return m_handle; }
+
+    // Awaiting starts the task; it must not have been awaited before
+    auto operator co_await() const noexcept {
+        struct Awaiter {
+            Handle handle;
+            bool await_ready() const noexcept { return handle.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            T await_resume() { return handle.promise().takeResult(); }
+        };
+        return Awaiter{m_handle};
+    }
+
+private:
+    void reset() {
+        if (m_handle) {
+            m_handle.destroy();
+            m_handle = nullptr;
+        }
+    }
+
+    Handle m_handle;
+};
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// Starts every task and suspends until the last one has finished. Tasks
+// that finish without suspending count down too, so the awaiting coroutine
+// only suspends if something is still running once all have started.
+template <typename T>
+struct WhenAllAwaiter {
+    std::vector<Task<T>>& tasks;
+    WhenAllLatch latch;
+
+    bool await_ready() const noexcept { return tasks.empty(); }
+    bool await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        latch.remaining = tasks.size() + 1;
+        latch.awaiting = awaiting;
+        for (Task<T>& task : tasks) {
+            if (task.isDone()) {
+                --latch.remaining;
+                continue;
+            }
+            task.getHandle().promise().latch = &latch;
+            task.getHandle().resume();
+        }
+        return --latch.remaining != 0;
+    }
+    void await_resume() const noexcept {}
+};
+
+// Runs the tasks side by side and finishes when all of them have. Results
+// come back in the order of the input; the first exception is rethrown
+// once every task has finished.
+template <typename T>
+Task<std::vector<T>> whenAll(std::vector<Task<T>> tasks) {
+    co_await WhenAllAwaiter<T>{tasks, {}};
+    std::vector<T> results;
+    results.reserve(tasks.size());
+    for (Task<T>& task : tasks) {
+        results.push_back(task.getHandle().promise().takeResult());
+    }
+    co_return results;
+}
+
+inline Task<void> whenAll(std::vector<Task<void>> tasks) {
+    co_await WhenAllAwaiter<void>{tasks, {}};
+    for (Task<void>& task : tasks) {
+        task.getHandle().promise().takeResult();
+    }
+}
+
+template <typename... Tasks>
+Task<void> whenAll(Task<void> first, Tasks... rest) {
+    std::vector<Task<void>> tasks;
+    tasks.reserve(1 + sizeof...(rest));
+    tasks.push_back(std::move(first));
+    (tasks.push_back(std::move(rest)), ...);
+    co_await whenAll(std::move(tasks));
+}
+
+#endif // TASK_H
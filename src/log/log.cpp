@@ -0,0 +1,561 @@
+#include "log.h"
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Text collected for a sink is written out once it grows past this
+const size_t BATCH_BYTES = 64u << 10;
+const size_t MIN_RING_BYTES = 4 * LOG_MAX_STRING;
+
+// A record waits, from the start of the ring at worst, for the whole of
+// it to be free, which must happen
+static_assert(sizeof(LogRecordHeader) + LOG_MAX_ARG_BYTES + 7 <= MIN_RING_BYTES, "Longest record must fit in a ring");
+
+const char* levelName(LogLevel level) {
+    switch (level) {
+    case LogLevel::Trace: return "TRACE";
+    case LogLevel::Debug: return "DEBUG";
+    case LogLevel::Info: return "INFO ";
+    case LogLevel::Warn: return "WARN ";
+    case LogLevel::Error: return "ERROR";
+    }
+    return "?    ";
+}
+
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 1024;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+template <typename T>
+void appendInteger(T value, std::string& out, int base = 10) {
+    char text[24];
+    const std::to_chars_result result = std::to_chars(text, text + sizeof(text), value, base);
+    out.append(text, result.ptr);
+}
+
+// Appends the argument at args and returns the one after it
+const uint8_t* appendArg(const uint8_t* args, std::string& out) {
+    switch (args[0]) {
+    case LOG_ARG_INT: {
+        int64_t value;
+        std::memcpy(&value, args + 1, 8);
+        appendInteger(value, out);
+        return args + 9;
+    }
+    case LOG_ARG_UINT: {
+        uint64_t value;
+        std::memcpy(&value, args + 1, 8);
+        appendInteger(value, out);
+        return args + 9;
+    }
+    case LOG_ARG_DOUBLE: {
+        double value;
+        std::memcpy(&value, args + 1, 8);
+        // %g, which is what iostream prints by default
+        char text[32];
+#if defined(__cpp_lib_to_chars)
+        out.append(text, std::to_chars(text, text + sizeof(text), value, std::chars_format::general, 6).ptr);
+#else
+        out.append(text, std::snprintf(text, sizeof(text), "%g", value));
+#endif
+        return args + 9;
+    }
+    case LOG_ARG_POINTER: {
+        uint64_t value;
+        std::memcpy(&value, args + 1, 8);
+        out += "0x";
+        appendInteger(value, out, 16);
+        return args + 9;
+    }
+    case LOG_ARG_BOOL:
+        out += args[1] ? "true" : "false";
+        return args + 2;
+    case LOG_ARG_CHAR:
+        out += static_cast<char>(args[1]);
+        return args + 2;
+    case LOG_ARG_STRING: {
+        uint32_t size;
+        std::memcpy(&size, args + 1, 4);
+        out.append(reinterpret_cast<const char*>(args + 5), size);
+        return args + 5 + size;
+    }
+    }
+    return args;
+}
+
+} // namespace
+
+LogThreadBuffer::LogThreadBuffer(size_t capacity)
+    : m_data(new uint8_t[capacity]), m_capacity(capacity), m_mask(capacity - 1) {}
+
+LogThreadBuffer::~LogThreadBuffer() {
+    delete[] m_data;
+}
+
+// Owns every thread's ring and the thread that writes them out
+class Logger {
+public:
+    Logger() : m_startTime(logTimestamp()), m_startClock(std::chrono::steady_clock::now()) {
+        m_writer = std::thread([this] { run(); });
+    }
+
+    LogThreadBuffer* addThread() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Big enough for a couple of the longest records
+        const size_t capacity = roundUpToPowerOfTwo(std::max(m_threadBufferBytes, MIN_RING_BYTES));
+        m_buffers.emplace_back(new LogThreadBuffer(capacity));
+        LogThreadBuffer* buffer = m_buffers.back().get();
+        buffer->m_direct.store(m_stop, std::memory_order_relaxed);
+        return buffer;
+    }
+
+    // Stops the writer once it has written everything, after which each
+    // thread writes its own records as it commits them
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop) {
+                return;
+            }
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_writer.join();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& buffer : m_buffers) {
+                buffer->m_direct.store(true, std::memory_order_relaxed);
+            }
+        }
+        // Records committed since the writer's last pass
+        writeDirect();
+    }
+
+    // One pass of the writer on the calling thread
+    void writeDirect() {
+        std::lock_guard<std::mutex> sinkLock(m_sinkMutex);
+        std::vector<Cursor> cursors;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& buffer : m_buffers) {
+                cursors.push_back(Cursor{buffer.get(), 0, 0, nullptr});
+            }
+        }
+        calibrate();
+        drain(cursors);
+        writeBatches();
+    }
+
+    void flush() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_stop) {
+            return;
+        }
+        const uint64_t ticket = ++m_flushRequested;
+        m_wake.notify_one();
+        m_flushed.wait(lock, [&] { return m_flushDone >= ticket; });
+    }
+
+    // Wakes the writer early, for a thread that found its ring full
+    void requestDrain() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_drainRequested = true;
+        }
+        m_wake.notify_one();
+    }
+
+    void configure(const LogConfig& config) {
+        flush();
+        std::lock_guard<std::mutex> sinkLock(m_sinkMutex);
+        closeFile();
+        m_config = config;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_threadBufferBytes = config.threadBufferBytes;
+            m_flushIntervalMs = config.flushIntervalMs;
+        }
+        openFile();
+    }
+
+    static void retire(LogThreadBuffer* buffer) { buffer->m_retired.store(true, std::memory_order_release); }
+
+    LogStats getStats() {
+        LogStats stats;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stats.messages = m_messages.load(std::memory_order_relaxed);
+        stats.bytes = m_bytes.load(std::memory_order_relaxed);
+        stats.waits = m_retiredWaits;
+        for (const auto& buffer : m_buffers) {
+            stats.waits += buffer->m_waits.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+private:
+    // Where the writer has got to in one ring during a pass
+    struct Cursor {
+        LogThreadBuffer* buffer;
+        uint64_t tail;
+        uint64_t head;
+        const LogRecordHeader* record; // Next to write, nullptr once caught up
+    };
+
+    void run() {
+        std::vector<Cursor> cursors;
+        for (;;) {
+            uint64_t ticket;
+            bool stop;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait_for(lock, std::chrono::milliseconds(m_flushIntervalMs),
+                                [&] { return m_stop || m_drainRequested || m_flushRequested != m_flushDone; });
+                m_drainRequested = false;
+                ticket = m_flushRequested;
+                stop = m_stop;
+                cursors.clear();
+                for (const auto& buffer : m_buffers) {
+                    cursors.push_back(Cursor{buffer.get(), 0, 0, nullptr});
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> sinkLock(m_sinkMutex);
+                calibrate();
+                drain(cursors);
+                writeBatches();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                removeRetired();
+                m_flushDone = ticket;
+            }
+            m_flushed.notify_all();
+            if (stop) {
+                return;
+            }
+        }
+    }
+
+    // Timestamp units to microseconds, measured over the logger's lifetime
+    void calibrate() {
+#if LOG_TSC
+        const int64_t ticks = logTimestamp() - m_startTime;
+        const double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_startClock).count();
+        if (ticks > 0 && micros > 0.0) {
+            m_microsPerTick = micros / static_cast<double>(ticks);
+        }
+#endif
+    }
+
+    // Next real record at or after cursor.tail, skipping padding
+    void advance(Cursor& cursor) {
+        LogThreadBuffer& buffer = *cursor.buffer;
+        cursor.record = nullptr;
+        while (cursor.tail < cursor.head) {
+            const size_t offset = static_cast<size_t>(cursor.tail & buffer.m_mask);
+            if (buffer.m_capacity - offset < sizeof(LogRecordHeader)) {
+                cursor.tail += buffer.m_capacity - offset;
+                continue;
+            }
+            const LogRecordHeader* record = reinterpret_cast<const LogRecordHeader*>(buffer.m_data + offset);
+            if (!record->site) {
+                cursor.tail += record->size;
+                continue;
+            }
+            cursor.record = record;
+            return;
+        }
+    }
+
+    // Writes out every record committed when the pass started, oldest first
+    void drain(std::vector<Cursor>& cursors) {
+        for (Cursor& cursor : cursors) {
+            cursor.tail = cursor.buffer->m_tail.load(std::memory_order_relaxed);
+            cursor.head = cursor.buffer->m_head.load(std::memory_order_acquire);
+            advance(cursor);
+        }
+        for (;;) {
+            Cursor* oldest = nullptr;
+            for (Cursor& cursor : cursors) {
+                if (cursor.record && (!oldest || cursor.record->time < oldest->record->time)) {
+                    oldest = &cursor;
+                }
+            }
+            if (!oldest) {
+                break;
+            }
+            format(*oldest->record);
+            oldest->tail += oldest->record->size;
+            oldest->buffer->m_tail.store(oldest->tail, std::memory_order_release);
+            advance(*oldest);
+        }
+        // Padding at the end of a ring is free once skipped, even when no
+        // record follows it yet
+        for (Cursor& cursor : cursors) {
+            cursor.buffer->m_tail.store(cursor.tail, std::memory_order_release);
+        }
+    }
+
+    void format(const LogRecordHeader& record) {
+        const LogSite& site = *record.site;
+        m_line.clear();
+        // Seconds since the logger started, to the microsecond
+        const uint64_t micros = static_cast<uint64_t>(std::max<int64_t>(0, record.time - m_startTime) * m_microsPerTick);
+        char seconds[24];
+        char* secondsEnd = std::to_chars(seconds, seconds + sizeof(seconds), micros / 1000000).ptr;
+        m_line.append(std::max<ptrdiff_t>(0, 5 - (secondsEnd - seconds)), ' ');
+        m_line.append(seconds, secondsEnd);
+        char fraction[] = ".000000 ";
+        uint64_t rest = micros % 1000000;
+        for (int i = 6; i >= 1; --i) {
+            fraction[i] = static_cast<char>('0' + rest % 10);
+            rest /= 10;
+        }
+        m_line.append(fraction, 8);
+        m_line += levelName(site.level);
+        m_line += ' ';
+
+        const uint8_t* args = reinterpret_cast<const uint8_t*>(&record + 1);
+        const uint8_t* argsEnd = args + record.argBytes;
+        for (const char* c = site.format; *c; ++c) {
+            if (c[0] == '{' && c[1] == '}') {
+                if (args < argsEnd) {
+                    args = appendArg(args, m_line);
+                } else {
+                    m_line += "{}";
+                }
+                ++c;
+            } else if ((c[0] == '{' && c[1] == '{') || (c[0] == '}' && c[1] == '}')) {
+                m_line += c[0];
+                ++c;
+            } else {
+                m_line += c[0];
+            }
+        }
+        m_line += '\n';
+
+        if (m_config.console) {
+            // One batch at a time keeps stdout and stderr lines in order
+            const bool error = site.level >= LogLevel::Warn;
+            if (error != m_consoleIsError || m_consoleBatch.size() >= BATCH_BYTES) {
+                writeConsole();
+                m_consoleIsError = error;
+            }
+            m_consoleBatch += m_line;
+        }
+        if (m_file) {
+            appendFile(m_line);
+        }
+        m_messages.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void writeConsole() {
+        if (!m_consoleBatch.empty()) {
+            FILE* stream = m_consoleIsError ? stderr : stdout;
+            std::fwrite(m_consoleBatch.data(), 1, m_consoleBatch.size(), stream);
+            std::fflush(stream);
+            m_bytes.fetch_add(m_consoleBatch.size(), std::memory_order_relaxed);
+            m_consoleBatch.clear();
+        }
+    }
+
+    void appendFile(const std::string& line) {
+        if (m_fileBytes + m_fileBatch.size() + line.size() > m_config.maxFileBytes &&
+            m_fileBytes + m_fileBatch.size() > 0) {
+            writeFile();
+            rotateFile();
+        }
+        m_fileBatch += line;
+        if (m_fileBatch.size() >= BATCH_BYTES) {
+            writeFile();
+        }
+    }
+
+    void writeFile() {
+        if (m_file && !m_fileBatch.empty()) {
+            std::fwrite(m_fileBatch.data(), 1, m_fileBatch.size(), m_file);
+            std::fflush(m_file);
+            m_fileBytes += m_fileBatch.size();
+            m_bytes.fetch_add(m_fileBatch.size(), std::memory_order_relaxed);
+        }
+        m_fileBatch.clear();
+    }
+
+    void writeBatches() {
+        writeConsole();
+        writeFile();
+    }
+
+    // path becomes path.1, path.1 becomes path.2 and so on
+    void rotateFile() {
+        closeFile();
+        const std::string& path = m_config.filePath;
+        if (m_config.maxFiles > 0) {
+            std::remove((path + "." + std::to_string(m_config.maxFiles)).c_str());
+            for (int i = m_config.maxFiles - 1; i >= 1; --i) {
+                std::rename((path + "." + std::to_string(i)).c_str(), (path + "." + std::to_string(i + 1)).c_str());
+            }
+            std::rename(path.c_str(), (path + ".1").c_str());
+        }
+        m_file = std::fopen(path.c_str(), "wb");
+        m_fileBytes = 0;
+    }
+
+    void openFile() {
+        if (m_config.filePath.empty()) {
+            return;
+        }
+        m_file = std::fopen(m_config.filePath.c_str(), "ab");
+        if (!m_file) {
+            std::fprintf(stderr, "Could not open log file %s\n", m_config.filePath.c_str());
+            return;
+        }
+        std::fseek(m_file, 0, SEEK_END);
+        m_fileBytes = static_cast<size_t>(std::max(0L, std::ftell(m_file)));
+    }
+
+    void closeFile() {
+        if (m_file) {
+            std::fclose(m_file);
+            m_file = nullptr;
+        }
+        m_fileBytes = 0;
+    }
+
+    // Rings whose thread has exited go once they have been read to the end
+    void removeRetired() {
+        auto done = [this](const std::unique_ptr<LogThreadBuffer>& buffer) {
+            if (!buffer->m_retired.load(std::memory_order_acquire) ||
+                buffer->m_tail.load(std::memory_order_relaxed) != buffer->m_head.load(std::memory_order_acquire)) {
+                return false;
+            }
+            m_retiredWaits += buffer->m_waits.load(std::memory_order_relaxed);
+            return true;
+        };
+        m_buffers.erase(std::remove_if(m_buffers.begin(), m_buffers.end(), done), m_buffers.end());
+    }
+
+    const int64_t m_startTime;
+    const std::chrono::steady_clock::time_point m_startClock;
+    double m_microsPerTick = 1e-3; // Exact when timestamps are nanoseconds
+
+    // Guards the ring list, the flush handshake and stopping
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_flushed;
+    std::vector<std::unique_ptr<LogThreadBuffer>> m_buffers;
+    size_t m_threadBufferBytes = LogConfig().threadBufferBytes;
+    int m_flushIntervalMs = LogConfig().flushIntervalMs;
+    uint64_t m_flushRequested = 0;
+    uint64_t m_flushDone = 0;
+    uint64_t m_retiredWaits = 0;
+    bool m_drainRequested = false;
+    bool m_stop = false;
+
+    // Held by the writer while it formats and writes, and while reconfiguring
+    std::mutex m_sinkMutex;
+    LogConfig m_config;
+    FILE* m_file = nullptr;
+    size_t m_fileBytes = 0;
+    std::string m_line;
+    std::string m_consoleBatch;
+    bool m_consoleIsError = false;
+    std::string m_fileBatch;
+    std::atomic<uint64_t> m_messages{0};
+    std::atomic<uint64_t> m_bytes{0};
+
+    std::thread m_writer;
+};
+
+namespace {
+
+// Never destroyed, so static destructors can still log; the writer is
+// stopped at exit instead
+Logger& logger() {
+    static Logger* instance = [] {
+        Logger* created = new Logger;
+        std::atexit([] { logger().stop(); });
+        return created;
+    }();
+    return *instance;
+}
+
+// Set once the thread's thread_locals are being destroyed
+thread_local bool threadExiting = false;
+
+// Marks the thread's ring for removal when the thread exits
+struct ThreadRetirer {
+    LogThreadBuffer* buffer = nullptr;
+    ~ThreadRetirer() {
+        threadExiting = true;
+        if (buffer) {
+            logThreadBufferCache = nullptr;
+            Logger::retire(buffer);
+        }
+    }
+};
+
+thread_local ThreadRetirer threadRetirer;
+
+} // namespace
+
+void LogThreadBuffer::waitForWriter(uint64_t end) {
+    m_cachedTail = m_tail.load(std::memory_order_acquire);
+    if (end - m_cachedTail <= m_capacity) {
+        return;
+    }
+    m_waits.fetch_add(1, std::memory_order_relaxed);
+    logger().requestDrain();
+    while (end - m_cachedTail > m_capacity) {
+        // With the writer stopped there is nobody else to make room
+        if (m_direct.load(std::memory_order_relaxed)) {
+            logger().writeDirect();
+        } else {
+            std::this_thread::yield();
+        }
+        m_cachedTail = m_tail.load(std::memory_order_acquire);
+    }
+}
+
+void LogThreadBuffer::writeDirect() {
+    logger().writeDirect();
+}
+
+LogThreadBuffer* registerLogThread() {
+    // A thread logging from a thread_local destructor after its ring was
+    // retired gets a new ring that is never retired, as nothing says when
+    // the thread is done with it
+    LogThreadBuffer* buffer = logger().addThread();
+    if (!threadExiting) {
+        threadRetirer.buffer = buffer;
+    }
+    logThreadBufferCache = buffer;
+    return buffer;
+}
+
+void configureLog(const LogConfig& config) {
+    logger().configure(config);
+}
+
+void flushLog() {
+    logger().flush();
+}
+
+LogStats getLogStats() {
+    return logger().getStats();
+}
@@ -0,0 +1,372 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Asynchronous logging for engine code.
+//
+//     LOG_INFO("Loaded {} in {} ms", path, elapsedMs);
+//
+// A call copies a pointer to its call site, a timestamp and the raw bytes
+// of its arguments into a ring buffer owned by the calling thread, and
+// returns. Nothing is formatted and no lock is taken: the format string is
+// a constant at the call site, so its address is all the record needs. A
+// background thread drains every thread's ring a few times per frame,
+// formats the records in timestamp order and writes them in one go per
+// batch, to the console and optionally to a file it rotates by size.
+//
+// Placeholders are "{}", filled in order; "{{" and "}}" print a brace.
+// Arguments can be integers, floating point, bool, char, pointers, C
+// strings, std::string and std::string_view. Strings are copied, so
+// temporaries are fine.
+//
+// A thread whose ring is full waits for the writer rather than dropping
+// messages, so anything logged is eventually written. flushLog waits for
+// everything logged so far, which is worth doing before a crash is likely
+// or before handing the console to something else. The writer stops at
+// exit; static destructors and anything else that logs after that write
+// their messages out themselves, synchronously.
+
+enum class LogLevel : uint8_t { Trace, Debug, Info, Warn, Error };
+
+// Lowest level compiled in: 0 trace, 1 debug, 2 info, 3 warn, 4 error,
+// 5 none. Calls below it disappear, arguments included.
+#ifndef GAME_ENGINE_LOG_LEVEL
+#ifdef NDEBUG
+#define GAME_ENGINE_LOG_LEVEL 2
+#else
+#define GAME_ENGINE_LOG_LEVEL 1
+#endif
+#endif
+
+// One per call site; its address identifies the format string
+struct LogSite {
+    LogLevel level;
+    const char* format;
+    const char* file;
+    int line;
+};
+
+struct LogConfig {
+    bool console = true; // Warn and Error to stderr, the rest to stdout
+    std::string filePath; // Every level is also written here unless empty
+    size_t maxFileBytes = 16u << 20; // Rotate before the file grows past this
+    int maxFiles = 4; // Rotated files kept, path.1 being the newest
+    size_t threadBufferBytes = 1u << 18; // Ring size for threads that log from now on
+    int flushIntervalMs = 5; // How often the writer looks for new records
+};
+
+struct LogStats {
+    uint64_t messages = 0; // Written so far
+    uint64_t bytes = 0; // Formatted text written, summed over sinks
+    uint64_t waits = 0; // Times a thread found its ring full
+};
+
+// Takes effect once everything logged before the call is written
+void configureLog(const LogConfig& config);
+
+// Blocks until everything logged before the call is written
+void flushLog();
+
+LogStats getLogStats();
+
+// Longest string argument kept; the rest is cut off
+const size_t LOG_MAX_STRING = 4096;
+// Most argument bytes in one record, so every record fits in a ring;
+// strings are cut off from the last one back to stay within it
+const size_t LOG_MAX_ARG_BYTES = 2 * LOG_MAX_STRING;
+
+enum LogArgType : uint8_t {
+    LOG_ARG_INT,
+    LOG_ARG_UINT,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_BOOL,
+    LOG_ARG_CHAR,
+    LOG_ARG_POINTER,
+    LOG_ARG_STRING,
+};
+
+struct LogRecordHeader {
+    const LogSite* site; // nullptr marks padding up to the end of the ring
+    int64_t time; // From logTimestamp
+    uint32_t size; // Whole record including this header, a multiple of 8
+    uint32_t argBytes;
+};
+
+// Single producer, single consumer byte ring: the owning thread appends
+// records, the writer thread consumes them. Records never wrap; when one
+// does not fit before the end, the rest of the ring is skipped.
+class LogThreadBuffer {
+public:
+    explicit LogThreadBuffer(size_t capacity);
+    ~LogThreadBuffer();
+
+    LogThreadBuffer(const LogThreadBuffer&) = delete;
+    LogThreadBuffer& operator=(const LogThreadBuffer&) = delete;
+
+    // Room for a record of size bytes, a multiple of 8; commit publishes it
+    uint8_t* reserve(size_t size) {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        const size_t offset = static_cast<size_t>(head & m_mask);
+        if (offset + size > m_capacity) {
+            // The padding is published on its own, so the record then waits
+            // only for its own size from the start of the ring
+            const size_t pad = m_capacity - offset;
+            waitForRoom(head + pad);
+            if (pad >= sizeof(LogRecordHeader)) {
+                LogRecordHeader header = {nullptr, 0, static_cast<uint32_t>(pad), 0};
+                std::memcpy(m_data + offset, &header, sizeof(header));
+            }
+            head += pad;
+            m_head.store(head, std::memory_order_release);
+        }
+        waitForRoom(head + size);
+        m_pending = head + size;
+        return m_data + (head & m_mask);
+    }
+
+    void commit() {
+        m_head.store(m_pending, std::memory_order_release);
+        if (m_direct.load(std::memory_order_relaxed)) {
+            writeDirect();
+        }
+    }
+
+private:
+    friend class Logger;
+
+    void waitForRoom(uint64_t end) {
+        if (end - m_cachedTail > m_capacity) {
+            waitForWriter(end);
+        }
+    }
+    void waitForWriter(uint64_t end);
+    void writeDirect();
+
+    uint8_t* m_data;
+    size_t m_capacity;
+    uint64_t m_mask;
+    uint64_t m_pending = 0;
+    uint64_t m_cachedTail = 0; // Producer's last look at m_tail
+    std::atomic<bool> m_direct{false}; // Set once the writer has stopped
+
+    alignas(64) std::atomic<uint64_t> m_head{0};
+    alignas(64) std::atomic<uint64_t> m_tail{0};
+    std::atomic<uint64_t> m_waits{0};
+    std::atomic<bool> m_retired{false}; // Owning thread has exited
+};
+
+// Ring of the calling thread, created on its first message and cleared
+// when the thread exits
+inline thread_local LogThreadBuffer* logThreadBufferCache = nullptr;
+
+LogThreadBuffer* registerLogThread();
+
+inline LogThreadBuffer& logThreadBuffer() {
+    LogThreadBuffer* buffer = logThreadBufferCache;
+    return buffer ? *buffer : *registerLogThread();
+}
+
+// Record timestamps: the CPU's time stamp counter where there is one, as
+// it costs a fraction of a clock call; the writer converts to seconds
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define LOG_TSC 1
+inline int64_t logTimestamp() {
+    return static_cast<int64_t>(__rdtsc());
+}
+#else
+#define LOG_TSC 0
+inline int64_t logTimestamp() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+template <typename T>
+struct LogIsString {
+    static const bool value = std::is_same<T, const char*>::value || std::is_same<T, char*>::value ||
+                              std::is_same<T, std::string>::value || std::is_same<T, std::string_view>::value;
+};
+
+inline std::string_view logStringArg(const char* value) {
+    return value ? std::string_view(value, strnlen(value, LOG_MAX_STRING)) : std::string_view("(null)");
+}
+
+inline std::string_view logStringArg(std::string_view value) {
+    return value.substr(0, LOG_MAX_STRING);
+}
+
+inline const char* logStringData(const char* value) {
+    return value ? value : "(null)";
+}
+
+inline const char* logStringData(std::string_view value) {
+    return value.data();
+}
+
+// Bytes an argument takes in a record: a type tag, then the value
+template <typename T>
+inline size_t logArgSize(const T& value) {
+    using D = std::decay_t<T>;
+    if constexpr (std::is_same<D, bool>::value || std::is_same<D, char>::value) {
+        return 2;
+    } else if constexpr (LogIsString<D>::value) {
+        return 5 + logStringArg(value).size();
+    } else {
+        static_assert(std::is_arithmetic<D>::value || std::is_enum<D>::value || std::is_pointer<D>::value,
+                      "Unsupported log argument type");
+        return 9;
+    }
+}
+
+// Writes an argument of size bytes, as measured by logArgSize
+template <typename T>
+inline uint8_t* logWriteArg(uint8_t* out, const T& value, size_t size) {
+    using D = std::decay_t<T>;
+    (void)size;
+    if constexpr (std::is_same<D, bool>::value) {
+        out[0] = LOG_ARG_BOOL;
+        out[1] = value ? 1 : 0;
+        return out + 2;
+    } else if constexpr (std::is_same<D, char>::value) {
+        out[0] = LOG_ARG_CHAR;
+        out[1] = static_cast<uint8_t>(value);
+        return out + 2;
+    } else if constexpr (LogIsString<D>::value) {
+        const uint32_t length = static_cast<uint32_t>(size - 5);
+        out[0] = LOG_ARG_STRING;
+        std::memcpy(out + 1, &length, 4);
+        std::memcpy(out + 5, logStringData(value), length);
+        return out + 5 + length;
+    } else if constexpr (std::is_floating_point<D>::value) {
+        const double wide = static_cast<double>(value);
+        out[0] = LOG_ARG_DOUBLE;
+        std::memcpy(out + 1, &wide, 8);
+        return out + 9;
+    } else if constexpr (std::is_pointer<D>::value) {
+        const uint64_t address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+        out[0] = LOG_ARG_POINTER;
+        std::memcpy(out + 1, &address, 8);
+        return out + 9;
+    } else if constexpr (std::is_enum<D>::value) {
+        const int64_t wide = static_cast<int64_t>(value);
+        out[0] = LOG_ARG_INT;
+        std::memcpy(out + 1, &wide, 8);
+        return out + 9;
+    } else if constexpr (std::is_signed<D>::value) {
+        const int64_t wide = value;
+        out[0] = LOG_ARG_INT;
+        std::memcpy(out + 1, &wide, 8);
+        return out + 9;
+    } else {
+        const uint64_t wide = value;
+        out[0] = LOG_ARG_UINT;
+        std::memcpy(out + 1, &wide, 8);
+        return out + 9;
+    }
+}
+
+// Shortens string arguments, last first, until argBytes is within
+// LOG_MAX_ARG_BYTES
+inline size_t logTrimArgs(size_t* argSizes, const bool* isString, size_t count, size_t argBytes) {
+    for (size_t i = count; i-- > 0 && argBytes > LOG_MAX_ARG_BYTES;) {
+        if (isString[i]) {
+            const size_t cut = std::min(argBytes - LOG_MAX_ARG_BYTES, argSizes[i] - 5);
+            argSizes[i] -= cut;
+            argBytes -= cut;
+        }
+    }
+    return argBytes;
+}
+
+// What the macros expand to; format is already in site
+template <typename... Args>
+inline void logWrite(const LogSite& site, const char*, const Args&... args) {
+    static_assert(9 * sizeof...(Args) <= LOG_MAX_ARG_BYTES, "Too many arguments for one log record");
+    LogThreadBuffer& buffer = logThreadBuffer();
+    const int64_t time = logTimestamp();
+    // Strings are measured once, the extra slot keeps the array non-empty
+    size_t argSizes[sizeof...(Args) + 1] = {logArgSize(args)..., 0};
+    size_t argBytes = 0;
+    for (size_t argSize : argSizes) {
+        argBytes += argSize;
+    }
+    if (argBytes > LOG_MAX_ARG_BYTES) {
+        const bool isString[sizeof...(Args) + 1] = {LogIsString<std::decay_t<Args>>::value..., false};
+        argBytes = logTrimArgs(argSizes, isString, sizeof...(Args), argBytes);
+    }
+    const size_t size = (sizeof(LogRecordHeader) + argBytes + 7) & ~size_t(7);
+    uint8_t* out = buffer.reserve(size);
+    const LogRecordHeader header = {&site, time, static_cast<uint32_t>(size), static_cast<uint32_t>(argBytes)};
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    size_t index = 0;
+    ((out = logWriteArg(out, args, argSizes[index++])), ...);
+    (void)index;
+    buffer.commit();
+}
+
+// Never defined; lets compiled-out calls still check their arguments
+template <typename... Args>
+int logCheckArgs(const char* format, const Args&... args);
+
+#define LOG_EXPAND(x) x
+#define LOG_FORMAT_(format, ...) format
+#define LOG_FORMAT(...) LOG_EXPAND(LOG_FORMAT_(__VA_ARGS__, 0))
+
+#define LOG_AT(level, ...)                                                                         \
+    do {                                                                                           \
+        static constexpr LogSite logSite = {level, LOG_FORMAT(__VA_ARGS__), __FILE__, __LINE__};   \
+        logWrite(logSite, __VA_ARGS__);                                                            \
+    } while (0)
+
+#define LOG_DISABLED(...)                                                                          \
+    do {                                                                                           \
+        (void)sizeof(logCheckArgs(__VA_ARGS__));                                                   \
+    } while (0)
+
+#if GAME_ENGINE_LOG_LEVEL <= 0
+#define LOG_TRACE(...) LOG_AT(LogLevel::Trace, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if GAME_ENGINE_LOG_LEVEL <= 1
+#define LOG_DEBUG(...) LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if GAME_ENGINE_LOG_LEVEL <= 2
+#define LOG_INFO(...) LOG_AT(LogLevel::Info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if GAME_ENGINE_LOG_LEVEL <= 3
+#define LOG_WARN(...) LOG_AT(LogLevel::Warn, __VA_ARGS__)
+#else
+#define LOG_WARN(...) LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if GAME_ENGINE_LOG_LEVEL <= 4
+#define LOG_ERROR(...) LOG_AT(LogLevel::Error, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#endif // LOG_H
@@ -1,5 +1,12 @@
 #include "../include/header.h" // Include the header file for the hello function
 #include "class/MyClass.h" // Include the header file
+#include "core/fixed_timestep.h" // Include the fixed timestep accumulator for the simulation
+#include "physics/physics_world.h" // Include the physics world for rigid body simulation
+#include "particles/particle_system.h" // Include the particle system for effects
+#include "renderer/vertex_batch.h" // Include the vertex batch for batched quad drawing
+#include "renderer/builtin_font.h" // Include the built-in font for the debug overlay
+#include "renderer/text_renderer.h" // Include the text renderer for on-screen text
+#include "log/log.h" // Include the logger for console output
 
 int main(int argc, char const *argv[])
 {   
@@ -8,24 +15,24 @@ int main(int argc, char const *argv[])
 
     MyClass obj(42); // Create an instance of MyClass
     
-    std::cout << "Value: " << obj.getValue() << std::endl;
+    LOG_INFO("Value: {}", obj.getValue());
     
     obj.setValue(100);
-    std::cout << "New value: " << obj.getValue() << std::endl;
+    LOG_INFO("New value: {}", obj.getValue());
 
-    std::cout << "Hello, World!" << std::endl; // Print a message to the console
-    std::cout << "Welcome to the C++ Game Engine" << std::endl; // Print another message
+    LOG_INFO("Hello, World!"); // Print a message to the console
+    LOG_INFO("Welcome to the C++ Game Engine"); // Print another message
     
     // Initialize SDL
     if (!SDL_Init(SDL_INIT_VIDEO)) {
-        std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
+        LOG_ERROR("SDL could not initialize! SDL_Error: {}", SDL_GetError());
         return -1;
     }
 
     // Create window - SDL3 changed the window creation syntax
     SDL_Window* window = SDL_CreateWindow("Game Engine - SDL3 Window", 800, 600, 0);
     if (!window) {
-        std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+        LOG_ERROR("Window could not be created! SDL_Error: {}", SDL_GetError());
         SDL_Quit();
         return -1;
     }
@@ -34,12 +41,53 @@ int main(int argc, char const *argv[])
     // Just passing 0 for default flags which gives hardware acceleration
     SDL_Renderer* renderer = SDL_CreateRenderer(window, NULL);
     if (!renderer) {
-        std::cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+        LOG_ERROR("Renderer could not be created! SDL_Error: {}", SDL_GetError());
         SDL_DestroyWindow(window);
         SDL_Quit();
         return -1;
     }
 
+    // Physics runs in meters with y up, the window is 20 x 15 meters
+    const float pixelsPerMeter = 40.0f;
+    PhysicsWorld world;
+    BodyDef groundDef;
+    groundDef.type = BodyType::Static;
+    groundDef.position = Vec2(10.0f, 0.5f);
+    groundDef.shape = makeBox(10.0f, 0.5f);
+    world.createBody(groundDef);
+    for (int i = 0; i < 12; ++i) {
+        BodyDef def;
+        def.position = Vec2(7.0f + static_cast<float>(i % 4) * 1.5f, 4.0f + static_cast<float>(i / 4) * 1.5f);
+        def.angle = 0.3f * static_cast<float>(i);
+        def.shape = (i % 2 == 0) ? makeBox(0.5f, 0.5f) : makeCircle(0.5f);
+        world.createBody(def);
+    }
+    // Alpha blending for the fading particles
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+    // A fountain of sparks bouncing off the bottom of the window
+    ParticleSystem particles;
+    EmitterDesc fountain;
+    fountain.x = 650.0f;
+    fountain.y = 560.0f;
+    fountain.rate = 400.0f;
+    fountain.capacity = 4000;
+    fountain.speedMin = 200.0f;
+    fountain.speedMax = 350.0f;
+    fountain.spread = 0.3f;
+    fountain.accelY = 400.0f;
+    fountain.planes.push_back(ParticlePlane{0.0f, -1.0f, -580.0f});
+    fountain.colorCurve = { {0.0f, 255, 230, 140, 255}, {0.6f, 255, 110, 40, 220}, {1.0f, 80, 80, 80, 0} };
+    particles.addEmitter(fountain);
+    VertexBatch batch;
+
+    // Debug overlay text; owns a texture, so it goes before the renderer
+    std::unique_ptr<TextRenderer> hud(new TextRenderer(renderer));
+    FontId hudFont = hud->addFont(makeBuiltinFont());
+
+    FixedTimestep timestep(1.0 / 60.0);
+    Uint64 lastTicks = SDL_GetTicksNS();
+
     // Main loop flag
     bool quit = false;
 
@@ -64,14 +112,54 @@ int main(int argc, char const *argv[])
             }
         }
 
+        // Advance the simulation in fixed steps
+        Uint64 nowTicks = SDL_GetTicksNS();
+        int steps = timestep.advance(static_cast<double>(nowTicks - lastTicks) * 1e-9);
+        lastTicks = nowTicks;
+        for (int i = 0; i < steps; ++i) {
+            world.step(static_cast<float>(timestep.getStep()));
+            particles.update(static_cast<float>(timestep.getStep()));
+        }
+
         // Clear screen
         SDL_SetRenderDrawColor(renderer, 0x20, 0x20, 0x40, 0xFF);
         SDL_RenderClear(renderer);
 
-        // Draw a rectangle in the middle of the screen
-        SDL_FRect rect = {300.0f, 200.0f, 200.0f, 200.0f};
-        SDL_SetRenderDrawColor(renderer, 0xFF, 0x80, 0x40, 0xFF);
-        SDL_RenderFillRect(renderer, &rect);
+        // Draw every body as an outline, flipping y to screen space
+        for (size_t i = 0; i < world.getBodyCount(); ++i) {
+            const Body& body = world.getBody(static_cast<BodyId>(i));
+            if (body.awake || body.type == BodyType::Static) {
+                SDL_SetRenderDrawColor(renderer, 0xFF, 0x80, 0x40, 0xFF);
+            } else {
+                SDL_SetRenderDrawColor(renderer, 0x80, 0x80, 0x80, 0xFF);
+            }
+            SDL_FPoint points[MAX_POLYGON_VERTICES + 1];
+            int count = 0;
+            if (body.shape.type == ShapeType::Polygon) {
+                for (int v = 0; v < body.shape.count; ++v) {
+                    Vec2 p = body.position + rotate(body.rotation, body.shape.vertices[v]);
+                    points[count++] = SDL_FPoint{p.x * pixelsPerMeter, 600.0f - p.y * pixelsPerMeter};
+                }
+            } else {
+                // Circles as an octagon, good enough for a debug view
+                for (int v = 0; v < MAX_POLYGON_VERTICES; ++v) {
+                    Vec2 p = body.position + rotate(Rot(body.angle + v * 0.785398f), Vec2(body.shape.radius, 0.0f));
+                    points[count++] = SDL_FPoint{p.x * pixelsPerMeter, 600.0f - p.y * pixelsPerMeter};
+                }
+            }
+            points[count++] = points[0];
+            SDL_RenderLines(renderer, points, count);
+        }
+
+        // Debug overlay with live counts
+        hud->beginFrame();
+        hud->drawText("bodies " + std::to_string(world.getBodyCount()) + "  particles " +
+                      std::to_string(particles.getLiveCount()), hudFont, 18, 8.0f, 8.0f, SDL_FColor{1.0f, 1.0f, 1.0f, 1.0f});
+
+        // All particles go out in a single batched draw, the text in another
+        particles.writeVertices(batch);
+        hud->writeVertices(batch);
+        batch.flush(renderer);
 
         // Update screen
         SDL_RenderPresent(renderer);
@@ -81,6 +169,7 @@ int main(int argc, char const *argv[])
     }
 
     // Clean up
+    hud.reset();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
@@ -0,0 +1,449 @@
+#include "hpa_graph.h"
+
+#include <algorithm>
+
+namespace {
+
+// Openings at least this wide get a portal at each end instead of one in
+// the middle, so paths along a wall don't detour through its centre
+const int LONG_ENTRANCE = 6;
+
+int oppositeSide(int side) {
+    return (side + 2) % 4;
+}
+
+} // namespace
+
+NavSearchContext::NavSearchContext(const HpaGraph& graph) {
+    const size_t clusterCells = static_cast<size_t>(graph.getClusterSize()) * graph.getClusterSize();
+    m_local.assign(clusterCells, NodeState{0, 0, 0});
+    m_targetStamps.assign(clusterCells, 0);
+    m_abstract.assign(graph.getSlotCount() + 2, NodeState{0, 0, 0});
+    m_open.reserve(std::max(clusterCells, size_t(4096)));
+    m_abstractPath.reserve(1024);
+    m_segment.reserve(clusterCells);
+}
+
+uint32_t NavSearchContext::beginLocalSearch() {
+    if (++m_localGeneration == 0) {
+        // Wrapped: stamps from four billion searches ago would look current
+        for (NodeState& node : m_local) {
+            node.stamp = 0;
+        }
+        std::fill(m_targetStamps.begin(), m_targetStamps.end(), 0);
+        m_localGeneration = 1;
+    }
+    m_open.clear();
+    return m_localGeneration;
+}
+
+uint32_t NavSearchContext::beginAbstractSearch() {
+    if (++m_abstractGeneration == 0) {
+        for (NodeState& node : m_abstract) {
+            node.stamp = 0;
+        }
+        m_abstractGeneration = 1;
+    }
+    m_open.clear();
+    return m_abstractGeneration;
+}
+
+HpaGraph::HpaGraph(const NavGrid& grid, int clusterSize)
+    : m_grid(grid),
+      m_clusterSize(clusterSize),
+      m_clustersX((grid.getWidth() + clusterSize - 1) / clusterSize),
+      m_clustersY((grid.getHeight() + clusterSize - 1) / clusterSize),
+      // Openings need a closed cell between them, so a side has at most
+      // half its length of them, and long ones take up more room
+      m_sideCapacity(static_cast<uint32_t>(clusterSize / 2 + 1)),
+      m_slotsPerCluster(SIDE_COUNT * m_sideCapacity) {
+    m_clusters.resize(static_cast<size_t>(m_clustersX) * m_clustersY);
+    for (int cy = 0; cy < m_clustersY; ++cy) {
+        for (int cx = 0; cx < m_clustersX; ++cx) {
+            Cluster& cluster = m_clusters[cy * m_clustersX + cx];
+            cluster.x0 = cx * clusterSize;
+            cluster.y0 = cy * clusterSize;
+            cluster.x1 = std::min(cluster.x0 + clusterSize, grid.getWidth());
+            cluster.y1 = std::min(cluster.y0 + clusterSize, grid.getHeight());
+            cluster.linkStart.assign(m_slotsPerCluster + 1, 0);
+        }
+    }
+    m_portalCells.assign(m_clusters.size() * m_slotsPerCluster, NavCell(-1, -1));
+    m_components.assign(m_portalCells.size(), 0);
+}
+
+int HpaGraph::neighbourCluster(int cluster, int side) const {
+    const int cx = cluster % m_clustersX;
+    const int cy = cluster / m_clustersX;
+    switch (side) {
+    case SIDE_NORTH:
+        return cy > 0 ? cluster - m_clustersX : -1;
+    case SIDE_EAST:
+        return cx + 1 < m_clustersX ? cluster + 1 : -1;
+    case SIDE_SOUTH:
+        return cy + 1 < m_clustersY ? cluster + m_clustersX : -1;
+    default:
+        return cx > 0 ? cluster - 1 : -1;
+    }
+}
+
+NavCell HpaGraph::borderCell(const Cluster& cluster, int side, int offset) const {
+    switch (side) {
+    case SIDE_NORTH:
+        return NavCell(cluster.x0 + offset, cluster.y0);
+    case SIDE_EAST:
+        return NavCell(cluster.x1 - 1, cluster.y0 + offset);
+    case SIDE_SOUTH:
+        return NavCell(cluster.x0 + offset, cluster.y1 - 1);
+    default:
+        return NavCell(cluster.x0, cluster.y0 + offset);
+    }
+}
+
+NavCell HpaGraph::slotCell(uint32_t slot) const {
+    return m_portalCells[slot];
+}
+
+int HpaGraph::clustersAffectedBy(int x, int y, int* out) const {
+    const int cluster = clusterOf(x, y);
+    const Cluster& bounds = m_clusters[cluster];
+    int count = 0;
+    out[count++] = cluster;
+    // A cell can border two neighbours at a corner
+    if (y == bounds.y0 && neighbourCluster(cluster, SIDE_NORTH) >= 0) {
+        out[count++] = neighbourCluster(cluster, SIDE_NORTH);
+    } else if (y == bounds.y1 - 1 && neighbourCluster(cluster, SIDE_SOUTH) >= 0) {
+        out[count++] = neighbourCluster(cluster, SIDE_SOUTH);
+    }
+    if (x == bounds.x0 && neighbourCluster(cluster, SIDE_WEST) >= 0) {
+        out[count++] = neighbourCluster(cluster, SIDE_WEST);
+    } else if (x == bounds.x1 - 1 && neighbourCluster(cluster, SIDE_EAST) >= 0) {
+        out[count++] = neighbourCluster(cluster, SIDE_EAST);
+    }
+    return count;
+}
+
+void HpaGraph::findEntrances(int cluster, int side, std::vector<int>& offsets) const {
+    offsets.clear();
+    const int neighbour = neighbourCluster(cluster, side);
+    if (neighbour < 0) {
+        return;
+    }
+    // Both clusters walk the same pairs of cells in the same order, so they
+    // agree on every entrance and its index
+    const Cluster& own = m_clusters[cluster];
+    const Cluster& other = m_clusters[neighbour];
+    const int length = (side == SIDE_NORTH || side == SIDE_SOUTH) ? own.x1 - own.x0 : own.y1 - own.y0;
+    int runStart = -1;
+    for (int i = 0; i <= length; ++i) {
+        bool open = false;
+        if (i < length) {
+            const NavCell a = borderCell(own, side, i);
+            const NavCell b = borderCell(other, oppositeSide(side), i);
+            open = m_grid.isPassable(a.x, a.y) && m_grid.isPassable(b.x, b.y);
+        }
+        if (open && runStart < 0) {
+            runStart = i;
+        } else if (!open && runStart >= 0) {
+            const int runLength = i - runStart;
+            if (runLength >= LONG_ENTRANCE) {
+                offsets.push_back(runStart);
+                offsets.push_back(i - 1);
+            } else {
+                offsets.push_back(runStart + runLength / 2);
+            }
+            runStart = -1;
+        }
+    }
+}
+
+void HpaGraph::rebuildCluster(NavSearchContext& context, int clusterIndex) {
+    Cluster& cluster = m_clusters[clusterIndex];
+    const size_t base = static_cast<size_t>(clusterIndex) * m_slotsPerCluster;
+    std::fill(m_portalCells.begin() + base, m_portalCells.begin() + base + m_slotsPerCluster, NavCell(-1, -1));
+    cluster.portals.clear();
+    for (int side = 0; side < SIDE_COUNT; ++side) {
+        findEntrances(clusterIndex, side, context.m_offsets);
+        for (size_t k = 0; k < context.m_offsets.size(); ++k) {
+            const uint32_t slot = side * m_sideCapacity + static_cast<uint32_t>(k);
+            m_portalCells[base + slot] = borderCell(cluster, side, context.m_offsets[k]);
+            cluster.portals.push_back(slot);
+        }
+    }
+
+    // Portals are in slot order, which gives the link table its layout
+    cluster.links.clear();
+    size_t next = 0;
+    for (uint32_t slot = 0; slot < m_slotsPerCluster; ++slot) {
+        cluster.linkStart[slot] = static_cast<uint32_t>(cluster.links.size());
+        if (next == cluster.portals.size() || cluster.portals[next] != slot) {
+            continue;
+        }
+        ++next;
+        collectPortalCosts(context, clusterIndex, slotCell(static_cast<uint32_t>(base) + slot), context.m_startPortals);
+        for (const NavSearchContext::PortalCost& reached : context.m_startPortals) {
+            if (reached.slot != slot) {
+                cluster.links.push_back(Link{reached.slot, reached.cost});
+            }
+        }
+    }
+    cluster.linkStart[m_slotsPerCluster] = static_cast<uint32_t>(cluster.links.size());
+}
+
+void HpaGraph::labelComponents() {
+    // Union-find with path halving over links and border crossings
+    for (uint32_t slot = 0; slot < m_components.size(); ++slot) {
+        m_components[slot] = slot;
+    }
+    auto find = [this](uint32_t slot) {
+        while (m_components[slot] != slot) {
+            m_components[slot] = m_components[m_components[slot]];
+            slot = m_components[slot];
+        }
+        return slot;
+    };
+    auto join = [&](uint32_t a, uint32_t b) {
+        a = find(a);
+        b = find(b);
+        if (a != b) {
+            m_components[std::max(a, b)] = std::min(a, b);
+        }
+    };
+    for (size_t c = 0; c < m_clusters.size(); ++c) {
+        const Cluster& cluster = m_clusters[c];
+        const uint32_t base = static_cast<uint32_t>(c) * m_slotsPerCluster;
+        for (uint32_t slot : cluster.portals) {
+            for (uint32_t i = cluster.linkStart[slot]; i < cluster.linkStart[slot + 1]; ++i) {
+                join(base + slot, base + cluster.links[i].slot);
+            }
+            // Each border is joined once, from its west or north side
+            const int side = static_cast<int>(slot / m_sideCapacity);
+            const int neighbour = neighbourCluster(static_cast<int>(c), side);
+            if ((side == SIDE_EAST || side == SIDE_SOUTH) && neighbour >= 0) {
+                join(base + slot, static_cast<uint32_t>(neighbour) * m_slotsPerCluster +
+                                      oppositeSide(side) * m_sideCapacity + slot % m_sideCapacity);
+            }
+        }
+    }
+    for (uint32_t slot = 0; slot < m_components.size(); ++slot) {
+        m_components[slot] = find(slot);
+    }
+}
+
+uint32_t HpaGraph::searchCluster(NavSearchContext& context, int clusterIndex, NavCell start, const NavCell* goal) const {
+    const Cluster& cluster = m_clusters[clusterIndex];
+    const uint32_t generation = context.beginLocalSearch();
+    auto localIndex = [&](int x, int y) {
+        return static_cast<uint32_t>((y - cluster.y0) * m_clusterSize + (x - cluster.x0));
+    };
+    auto byF = [](const NavSearchContext::OpenEntry& a, const NavSearchContext::OpenEntry& b) { return a.f > b.f; };
+
+    size_t remaining = 0;
+    if (!goal) {
+        for (uint32_t slot : cluster.portals) {
+            const NavCell cell = slotCell(static_cast<uint32_t>(clusterIndex) * m_slotsPerCluster + slot);
+            uint32_t& target = context.m_targetStamps[localIndex(cell.x, cell.y)];
+            if (target != generation) {
+                target = generation; // Corner cells can hold two portals
+                ++remaining;
+            }
+        }
+        if (remaining == 0) {
+            return 0;
+        }
+    }
+
+    const uint32_t startIndex = localIndex(start.x, start.y);
+    context.m_local[startIndex] = NavSearchContext::NodeState{0, startIndex, generation};
+    context.m_open.push_back(NavSearchContext::OpenEntry{goal ? navDistance(start.x, start.y, goal->x, goal->y) : 0, 0, startIndex});
+    while (!context.m_open.empty()) {
+        std::pop_heap(context.m_open.begin(), context.m_open.end(), byF);
+        const NavSearchContext::OpenEntry entry = context.m_open.back();
+        context.m_open.pop_back();
+        if (entry.g != context.m_local[entry.node].g) {
+            continue; // Superseded by a cheaper way in
+        }
+        const int x = cluster.x0 + static_cast<int>(entry.node % m_clusterSize);
+        const int y = cluster.y0 + static_cast<int>(entry.node / m_clusterSize);
+        if (goal) {
+            if (x == goal->x && y == goal->y) {
+                return entry.g;
+            }
+        } else if (context.m_targetStamps[entry.node] == generation) {
+            context.m_targetStamps[entry.node] = 0;
+            if (--remaining == 0) {
+                return 0;
+            }
+        }
+
+        m_grid.forEachNeighbour(x, y, cluster.x0, cluster.y0, cluster.x1, cluster.y1, [&](int nx, int ny, uint32_t cost) {
+            const uint32_t index = localIndex(nx, ny);
+            const uint32_t g = entry.g + cost;
+            NavSearchContext::NodeState& node = context.m_local[index];
+            if (node.stamp != generation || g < node.g) {
+                node = NavSearchContext::NodeState{g, entry.node, generation};
+                const uint32_t h = goal ? navDistance(nx, ny, goal->x, goal->y) : 0;
+                context.m_open.push_back(NavSearchContext::OpenEntry{g + h, g, index});
+                std::push_heap(context.m_open.begin(), context.m_open.end(), byF);
+            }
+        });
+    }
+    return goal ? NAV_NO_PATH : 0;
+}
+
+void HpaGraph::collectPortalCosts(NavSearchContext& context, int clusterIndex, NavCell start,
+                                  std::vector<NavSearchContext::PortalCost>& out) const {
+    out.clear();
+    searchCluster(context, clusterIndex, start, nullptr);
+    const Cluster& cluster = m_clusters[clusterIndex];
+    for (uint32_t slot : cluster.portals) {
+        const NavCell cell = slotCell(static_cast<uint32_t>(clusterIndex) * m_slotsPerCluster + slot);
+        const NavSearchContext::NodeState& node =
+            context.m_local[(cell.y - cluster.y0) * m_clusterSize + (cell.x - cluster.x0)];
+        if (node.stamp == context.m_localGeneration) {
+            out.push_back(NavSearchContext::PortalCost{slot, node.g});
+        }
+    }
+}
+
+void HpaGraph::appendLocalPath(NavSearchContext& context, int clusterIndex, NavCell goal, std::vector<NavCell>& path) const {
+    const Cluster& cluster = m_clusters[clusterIndex];
+    context.m_segment.clear();
+    uint32_t index = static_cast<uint32_t>((goal.y - cluster.y0) * m_clusterSize + (goal.x - cluster.x0));
+    while (context.m_local[index].parent != index) {
+        context.m_segment.push_back(NavCell(cluster.x0 + static_cast<int>(index % m_clusterSize),
+                                            cluster.y0 + static_cast<int>(index / m_clusterSize)));
+        index = context.m_local[index].parent;
+    }
+    path.insert(path.end(), context.m_segment.rbegin(), context.m_segment.rend());
+}
+
+uint32_t HpaGraph::searchAbstract(NavSearchContext& context, int startCluster, int goalCluster, NavCell goal) const {
+    const uint32_t startNode = static_cast<uint32_t>(m_portalCells.size());
+    const uint32_t goalNode = startNode + 1;
+    const uint32_t generation = context.beginAbstractSearch();
+    auto byF = [](const NavSearchContext::OpenEntry& a, const NavSearchContext::OpenEntry& b) { return a.f > b.f; };
+
+    NavSearchContext::OpenEntry entry{0, 0, 0};
+    auto relax = [&](uint32_t to, uint32_t cost) {
+        const uint32_t g = entry.g + cost;
+        NavSearchContext::NodeState& node = context.m_abstract[to];
+        if (node.stamp != generation || g < node.g) {
+            node = NavSearchContext::NodeState{g, entry.node, generation};
+            uint32_t h = 0;
+            if (to != goalNode) {
+                const NavCell cell = slotCell(to);
+                h = navDistance(cell.x, cell.y, goal.x, goal.y);
+            }
+            context.m_open.push_back(NavSearchContext::OpenEntry{g + h, g, to});
+            std::push_heap(context.m_open.begin(), context.m_open.end(), byF);
+        }
+    };
+
+    context.m_abstract[startNode] = NavSearchContext::NodeState{0, startNode, generation};
+    context.m_open.push_back(NavSearchContext::OpenEntry{0, 0, startNode});
+    while (!context.m_open.empty()) {
+        std::pop_heap(context.m_open.begin(), context.m_open.end(), byF);
+        entry = context.m_open.back();
+        context.m_open.pop_back();
+        if (entry.g != context.m_abstract[entry.node].g) {
+            continue;
+        }
+        if (entry.node == goalNode) {
+            return entry.g;
+        }
+        if (entry.node == startNode) {
+            const uint32_t base = static_cast<uint32_t>(startCluster) * m_slotsPerCluster;
+            for (const NavSearchContext::PortalCost& portal : context.m_startPortals) {
+                relax(base + portal.slot, portal.cost);
+            }
+            continue;
+        }
+
+        const int clusterIndex = static_cast<int>(entry.node / m_slotsPerCluster);
+        const uint32_t slot = entry.node % m_slotsPerCluster;
+        const uint32_t base = entry.node - slot;
+        const Cluster& cluster = m_clusters[clusterIndex];
+        for (uint32_t i = cluster.linkStart[slot]; i < cluster.linkStart[slot + 1]; ++i) {
+            relax(base + cluster.links[i].slot, cluster.links[i].cost);
+        }
+        const int side = static_cast<int>(slot / m_sideCapacity);
+        const int neighbour = neighbourCluster(clusterIndex, side);
+        if (neighbour >= 0) {
+            const uint32_t twin = static_cast<uint32_t>(neighbour) * m_slotsPerCluster +
+                                  oppositeSide(side) * m_sideCapacity + slot % m_sideCapacity;
+            if (m_portalCells[twin].x >= 0) {
+                relax(twin, NAV_STRAIGHT_COST);
+            }
+        }
+        if (clusterIndex == goalCluster) {
+            for (const NavSearchContext::PortalCost& portal : context.m_goalPortals) {
+                if (portal.slot == slot) {
+                    relax(goalNode, portal.cost);
+                }
+            }
+        }
+    }
+    return NAV_NO_PATH;
+}
+
+uint32_t HpaGraph::findPath(NavSearchContext& context, NavCell start, NavCell goal, std::vector<NavCell>& path) const {
+    if (!m_grid.isPassable(start.x, start.y) || !m_grid.isPassable(goal.x, goal.y)) {
+        return NAV_NO_PATH;
+    }
+    const int startCluster = clusterOf(start.x, start.y);
+    const int goalCluster = clusterOf(goal.x, goal.y);
+    if (startCluster == goalCluster) {
+        // Usually the way is inside the cluster; if not, go around
+        const uint32_t cost = searchCluster(context, startCluster, start, &goal);
+        if (cost != NAV_NO_PATH) {
+            path.push_back(start);
+            appendLocalPath(context, startCluster, goal, path);
+            return cost;
+        }
+    }
+
+    collectPortalCosts(context, startCluster, start, context.m_startPortals);
+    collectPortalCosts(context, goalCluster, goal, context.m_goalPortals);
+    bool connected = false;
+    for (const NavSearchContext::PortalCost& from : context.m_startPortals) {
+        for (const NavSearchContext::PortalCost& to : context.m_goalPortals) {
+            connected = connected || m_components[startCluster * m_slotsPerCluster + from.slot] ==
+                                         m_components[goalCluster * m_slotsPerCluster + to.slot];
+        }
+    }
+    if (!connected) {
+        return NAV_NO_PATH; // Walled in, no need to search the whole map
+    }
+    const uint32_t cost = searchAbstract(context, startCluster, goalCluster, goal);
+    if (cost == NAV_NO_PATH) {
+        return NAV_NO_PATH;
+    }
+
+    const uint32_t startNode = static_cast<uint32_t>(m_portalCells.size());
+    const uint32_t goalNode = startNode + 1;
+    context.m_abstractPath.clear();
+    for (uint32_t node = goalNode; node != startNode; node = context.m_abstract[node].parent) {
+        context.m_abstractPath.push_back(node);
+    }
+    std::reverse(context.m_abstractPath.begin(), context.m_abstractPath.end());
+
+    // Each hop is either across a border, one straight step, or a walk
+    // inside one cluster that is searched again to get its cells
+    path.push_back(start);
+    NavCell current = start;
+    int currentCluster = startCluster;
+    for (uint32_t node : context.m_abstractPath) {
+        const NavCell next = node == goalNode ? goal : slotCell(node);
+        const int nextCluster = node == goalNode ? goalCluster : static_cast<int>(node / m_slotsPerCluster);
+        if (nextCluster != currentCluster) {
+            path.push_back(next);
+        } else if (next != current) {
+            searchCluster(context, currentCluster, current, &next);
+            appendLocalPath(context, currentCluster, next, path);
+        }
+        current = next;
+        currentCluster = nextCluster;
+    }
+    return cost;
+}
@@ -0,0 +1,142 @@
+#ifndef HPA_GRAPH_H
+#define HPA_GRAPH_H
+
+#include "nav_grid.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class HpaGraph;
+
+// Scratch memory for one search at a time, sized for its graph up front so
+// searches never allocate. Give each thread its own.
+class NavSearchContext {
+public:
+    explicit NavSearchContext(const HpaGraph& graph);
+
+private:
+    friend class HpaGraph;
+
+    struct OpenEntry {
+        uint32_t f;
+        uint32_t g;
+        uint32_t node;
+    };
+
+    // Per-node state is valid only where stamp matches the generation of
+    // the current search, so nothing is cleared between searches
+    struct NodeState {
+        uint32_t g;
+        uint32_t parent;
+        uint32_t stamp;
+    };
+
+    struct PortalCost {
+        uint32_t slot;
+        uint32_t cost;
+    };
+
+    uint32_t beginLocalSearch();
+    uint32_t beginAbstractSearch();
+
+    std::vector<OpenEntry> m_open; // Binary heap, smallest f on top
+    std::vector<NodeState> m_local; // One per cell of a cluster
+    std::vector<NodeState> m_abstract; // One per portal slot, plus two
+    std::vector<uint32_t> m_targetStamps; // Marks cells a flood is after
+    uint32_t m_localGeneration = 0;
+    uint32_t m_abstractGeneration = 0;
+    std::vector<PortalCost> m_startPortals;
+    std::vector<PortalCost> m_goalPortals;
+    std::vector<uint32_t> m_abstractPath;
+    std::vector<NavCell> m_segment;
+    std::vector<int> m_offsets;
+};
+
+// Two-level view of a NavGrid for hierarchical pathfinding (HPA*).
+//
+// The map is cut into square clusters. Wherever open cells line up across
+// the border of two clusters there is an entrance, marked by a portal cell
+// on each side: one in the middle of a short opening, one at each end of a
+// long one. Portals of a cluster are linked by the cost of the best path
+// between them inside it, and each is linked to its twin across the
+// border, which gives a small graph to search in place of the grid.
+//
+// A query links its start and goal to the portals of their clusters,
+// searches the small graph and then refines each hop with a search bounded
+// to one cluster. Paths are within a few percent of optimal.
+//
+// Portals live in fixed slots: a cluster has sideCapacity slots per side,
+// and an entrance keeps the same index on both sides of its border, so the
+// link to the twin is implicit and a cluster can be rebuilt without
+// touching the clusters around it, as long as those sharing a changed
+// border are rebuilt as well.
+class HpaGraph {
+public:
+    HpaGraph(const NavGrid& grid, int clusterSize);
+
+    int getClusterSize() const { return m_clusterSize; }
+    int getClusterCount() const { return m_clustersX * m_clustersY; }
+    int clusterOf(int x, int y) const { return (y / m_clusterSize) * m_clustersX + x / m_clusterSize; }
+    size_t getSlotCount() const { return m_portalCells.size(); }
+    size_t getPortalCount(int cluster) const { return m_clusters[cluster].portals.size(); }
+
+    // Clusters whose portals or links depend on cell (x, y): its own and
+    // any neighbour it borders. Writes up to three ids and returns the count.
+    int clustersAffectedBy(int x, int y, int* out) const;
+
+    // Recomputes portals and links of one cluster from the grid. Distinct
+    // clusters may be rebuilt on different threads at the same time.
+    void rebuildCluster(NavSearchContext& context, int cluster);
+    // Groups portals that can reach each other, so a query with no path is
+    // turned down without searching. Call once rebuilds are done.
+    void labelComponents();
+
+    // Appends the path from start to goal, both ends included, and returns
+    // its cost, or NAV_NO_PATH leaving path untouched. Safe to call from
+    // several threads at once with separate contexts.
+    uint32_t findPath(NavSearchContext& context, NavCell start, NavCell goal, std::vector<NavCell>& path) const;
+
+private:
+    struct Link {
+        uint32_t slot; // Portal slot in the same cluster
+        uint32_t cost;
+    };
+
+    struct Cluster {
+        int x0, y0, x1, y1; // Cell bounds, half-open
+        std::vector<uint32_t> portals; // Slots in use, local to the cluster
+        std::vector<uint32_t> linkStart; // Links of slot s: [linkStart[s], linkStart[s + 1])
+        std::vector<Link> links;
+    };
+
+    enum Side { SIDE_NORTH, SIDE_EAST, SIDE_SOUTH, SIDE_WEST, SIDE_COUNT };
+
+    void findEntrances(int cluster, int side, std::vector<int>& offsets) const;
+    int neighbourCluster(int cluster, int side) const;
+    NavCell borderCell(const Cluster& cluster, int side, int offset) const;
+    NavCell slotCell(uint32_t slot) const;
+
+    // Search confined to one cluster. With a goal it is A* and returns the
+    // cost; without one it floods outward until every portal of the
+    // cluster is settled, leaving their costs in context.
+    uint32_t searchCluster(NavSearchContext& context, int cluster, NavCell start, const NavCell* goal) const;
+    void collectPortalCosts(NavSearchContext& context, int cluster, NavCell start,
+                            std::vector<NavSearchContext::PortalCost>& out) const;
+    // Appends the cluster-local path to goal after a searchCluster, without
+    // the start cell
+    void appendLocalPath(NavSearchContext& context, int cluster, NavCell goal, std::vector<NavCell>& path) const;
+    uint32_t searchAbstract(NavSearchContext& context, int startCluster, int goalCluster, NavCell goal) const;
+
+    const NavGrid& m_grid;
+    int m_clusterSize;
+    int m_clustersX;
+    int m_clustersY;
+    uint32_t m_sideCapacity;
+    uint32_t m_slotsPerCluster;
+    std::vector<Cluster> m_clusters;
+    std::vector<NavCell> m_portalCells; // Per slot, x is -1 if unused
+    std::vector<uint32_t> m_components; // Per slot
+};
+
+#endif // HPA_GRAPH_H
@@ -0,0 +1,90 @@
+#ifndef NAV_GRID_H
+#define NAV_GRID_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+struct NavCell {
+    int x = 0;
+    int y = 0;
+
+    NavCell() = default;
+    NavCell(int cellX, int cellY) : x(cellX), y(cellY) {}
+
+    bool operator==(const NavCell& other) const { return x == other.x && y == other.y; }
+    bool operator!=(const NavCell& other) const { return !(*this == other); }
+};
+
+// Step costs in fixed point, a straight step costs 100
+const uint32_t NAV_STRAIGHT_COST = 100;
+const uint32_t NAV_DIAGONAL_COST = 141;
+const uint32_t NAV_NO_PATH = 0xFFFFFFFFu;
+
+// Octile distance, exact on an open grid and never more than the real cost
+inline uint32_t navDistance(int x0, int y0, int x1, int y1) {
+    const uint32_t dx = static_cast<uint32_t>(std::abs(x1 - x0));
+    const uint32_t dy = static_cast<uint32_t>(std::abs(y1 - y0));
+    const uint32_t diagonal = dx < dy ? dx : dy;
+    return (dx + dy - 2 * diagonal) * NAV_STRAIGHT_COST + diagonal * NAV_DIAGONAL_COST;
+}
+
+// Walkable cells of a map. Agents move to any of the eight neighbours, but
+// never cut a corner: a diagonal step needs both cells beside it open.
+class NavGrid {
+public:
+    NavGrid(int width, int height)
+        : m_width(width), m_height(height), m_passable(static_cast<size_t>(width) * height, 1) {}
+
+    // Cells outside the map are never passable
+    bool isPassable(int x, int y) const {
+        return x >= 0 && y >= 0 && x < m_width && y < m_height && m_passable[static_cast<size_t>(y) * m_width + x];
+    }
+    void setPassable(int x, int y, bool passable) {
+        m_passable[static_cast<size_t>(y) * m_width + x] = passable ? 1 : 0;
+    }
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+    // Calls func(x, y, cost) for every cell reachable in one step from
+    // (x, y) that lies inside [minX, maxX) x [minY, maxY)
+    template <typename Func>
+    void forEachNeighbour(int x, int y, int minX, int minY, int maxX, int maxY, Func func) const {
+        const bool left = x > minX && isPassable(x - 1, y);
+        const bool right = x + 1 < maxX && isPassable(x + 1, y);
+        const bool up = y > minY && isPassable(x, y - 1);
+        const bool down = y + 1 < maxY && isPassable(x, y + 1);
+        if (left) {
+            func(x - 1, y, NAV_STRAIGHT_COST);
+        }
+        if (right) {
+            func(x + 1, y, NAV_STRAIGHT_COST);
+        }
+        if (up) {
+            func(x, y - 1, NAV_STRAIGHT_COST);
+        }
+        if (down) {
+            func(x, y + 1, NAV_STRAIGHT_COST);
+        }
+        if (left && up && isPassable(x - 1, y - 1)) {
+            func(x - 1, y - 1, NAV_DIAGONAL_COST);
+        }
+        if (right && up && isPassable(x + 1, y - 1)) {
+            func(x + 1, y - 1, NAV_DIAGONAL_COST);
+        }
+        if (left && down && isPassable(x - 1, y + 1)) {
+            func(x - 1, y + 1, NAV_DIAGONAL_COST);
+        }
+        if (right && down && isPassable(x + 1, y + 1)) {
+            func(x + 1, y + 1, NAV_DIAGONAL_COST);
+        }
+    }
+
+private:
+    int m_width;
+    int m_height;
+    std::vector<uint8_t> m_passable;
+};
+
+#endif // NAV_GRID_H
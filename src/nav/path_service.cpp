@@ -0,0 +1,193 @@
+#include "path_service.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// Queries per chunk; searches vary a lot in length, so keep chunks small
+const size_t QUERY_GRAIN = 4;
+const size_t CLUSTER_GRAIN = 8;
+
+} // namespace
+
+PathService::PathService(int width, int height, const PathServiceConfig& config, ThreadPool* pool)
+    : m_config(config), m_pool(pool), m_grid(width, height), m_graph(m_grid, config.clusterSize) {
+    if (!m_pool) {
+        m_ownedPool.reset(new ThreadPool(config.threadCount));
+        m_pool = m_ownedPool.get();
+    }
+    const size_t threads = m_pool->getThreadCount();
+    m_contextBusy.reset(new std::atomic<bool>[threads]);
+    for (size_t i = 0; i < threads; ++i) {
+        m_contexts.emplace_back(new NavSearchContext(m_graph));
+        m_contextBusy[i].store(false, std::memory_order_relaxed);
+    }
+
+    // The graph is built on first use, so filling in the map is cheap
+    const int clusterCount = m_graph.getClusterCount();
+    m_clusterVersions.assign(clusterCount, 0);
+    m_clusterDirty.assign(clusterCount, 1);
+    for (int cluster = 0; cluster < clusterCount; ++cluster) {
+        m_dirtyClusters.push_back(cluster);
+    }
+}
+
+void PathService::setPassable(int x, int y, bool passable) {
+    if (m_grid.isPassable(x, y) == passable) {
+        return;
+    }
+    m_grid.setPassable(x, y, passable);
+    ++m_clusterVersions[m_graph.clusterOf(x, y)];
+    int affected[3];
+    const int count = m_graph.clustersAffectedBy(x, y, affected);
+    for (int i = 0; i < count; ++i) {
+        if (!m_clusterDirty[affected[i]]) {
+            m_clusterDirty[affected[i]] = 1;
+            m_dirtyClusters.push_back(affected[i]);
+        }
+    }
+}
+
+NavSearchContext& PathService::acquireContext(size_t& index) {
+    for (;;) {
+        for (size_t i = 0; i < m_contexts.size(); ++i) {
+            if (!m_contextBusy[i].load(std::memory_order_relaxed) &&
+                !m_contextBusy[i].exchange(true, std::memory_order_acquire)) {
+                index = i;
+                return *m_contexts[i];
+            }
+        }
+    }
+}
+
+void PathService::releaseContext(size_t index) {
+    m_contextBusy[index].store(false, std::memory_order_release);
+}
+
+size_t PathService::updateGraph() {
+    const size_t count = m_dirtyClusters.size();
+    m_pool->parallelFor(count, CLUSTER_GRAIN, [this](size_t begin, size_t end) {
+        size_t contextIndex;
+        NavSearchContext& context = acquireContext(contextIndex);
+        for (size_t i = begin; i < end; ++i) {
+            m_graph.rebuildCluster(context, m_dirtyClusters[i]);
+        }
+        releaseContext(contextIndex);
+    });
+    for (int cluster : m_dirtyClusters) {
+        m_clusterDirty[cluster] = 0;
+    }
+    m_dirtyClusters.clear();
+    if (count > 0) {
+        m_graph.labelComponents();
+    }
+    return count;
+}
+
+uint64_t PathService::cacheKey(const PathQuery& query) const {
+    const uint64_t width = static_cast<uint64_t>(m_grid.getWidth());
+    return ((query.start.y * width + query.start.x) << 32) | (query.goal.y * width + query.goal.x);
+}
+
+const PathService::CachedPath* PathService::findCached(const PathQuery& query) const {
+    auto found = m_cache.find(cacheKey(query));
+    if (found == m_cache.end()) {
+        return nullptr;
+    }
+    for (const ClusterVersion& touched : found->second.clusters) {
+        if (m_clusterVersions[touched.cluster] != touched.version) {
+            return nullptr; // Left in place, the new search replaces it
+        }
+    }
+    return &found->second;
+}
+
+void PathService::addCached(const PathQuery& query, const PathResult& result) {
+    if (m_config.maxCachedPaths == 0) {
+        return;
+    }
+    const uint64_t key = cacheKey(query);
+    auto inserted = m_cache.emplace(key, CachedPath());
+    CachedPath& entry = inserted.first->second;
+    entry.cost = result.cost;
+    entry.path = result.path;
+    entry.clusters.clear();
+    int previous = -1;
+    for (const NavCell& cell : result.path) {
+        const int cluster = m_graph.clusterOf(cell.x, cell.y);
+        if (cluster != previous) {
+            entry.clusters.push_back(ClusterVersion{static_cast<uint32_t>(cluster), 0});
+            previous = cluster;
+        }
+    }
+    std::sort(entry.clusters.begin(), entry.clusters.end(),
+              [](const ClusterVersion& a, const ClusterVersion& b) { return a.cluster < b.cluster; });
+    entry.clusters.erase(std::unique(entry.clusters.begin(), entry.clusters.end(),
+                                     [](const ClusterVersion& a, const ClusterVersion& b) { return a.cluster == b.cluster; }),
+                         entry.clusters.end());
+    for (ClusterVersion& touched : entry.clusters) {
+        touched.version = m_clusterVersions[touched.cluster];
+    }
+
+    if (!inserted.second) {
+        return; // Replaced a stale entry, which keeps its place in line
+    }
+    m_cacheOrder.push_back(key);
+    while (m_cache.size() > m_config.maxCachedPaths) {
+        m_cache.erase(m_cacheOrder.front());
+        m_cacheOrder.pop_front();
+    }
+}
+
+void PathService::clearCache() {
+    m_cache.clear();
+    m_cacheOrder.clear();
+}
+
+void PathService::findPaths(const std::vector<PathQuery>& queries, std::vector<PathResult>& results) {
+    updateGraph();
+    results.resize(queries.size());
+    m_pool->parallelFor(queries.size(), QUERY_GRAIN, [&](size_t begin, size_t end) {
+        size_t contextIndex;
+        NavSearchContext& context = acquireContext(contextIndex);
+        for (size_t i = begin; i < end; ++i) {
+            const PathQuery& query = queries[i];
+            PathResult& result = results[i];
+            result.path.clear();
+            result.searchMs = 0.0;
+            result.fromCache = false;
+            // Also keeps cells off the map out of the cache keys
+            if (!m_grid.isPassable(query.start.x, query.start.y) || !m_grid.isPassable(query.goal.x, query.goal.y)) {
+                result.found = false;
+                result.cost = 0;
+                continue;
+            }
+            if (const CachedPath* cached = findCached(query)) {
+                result.found = true;
+                result.fromCache = true;
+                result.cost = cached->cost;
+                result.path = cached->path;
+                continue;
+            }
+            const auto start = std::chrono::steady_clock::now();
+            const uint32_t cost = m_graph.findPath(context, query.start, query.goal, result.path);
+            result.searchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            result.found = cost != NAV_NO_PATH;
+            result.cost = result.found ? cost : 0;
+        }
+        releaseContext(contextIndex);
+    });
+
+    // The cache is only read while the searches run, and written here
+    for (size_t i = 0; i < queries.size(); ++i) {
+        if (results[i].fromCache) {
+            ++m_cacheHits;
+        } else {
+            ++m_cacheMisses;
+            if (results[i].found) {
+                addCached(queries[i], results[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef PATH_SERVICE_H
+#define PATH_SERVICE_H
+
+#include "hpa_graph.h"
+#include "../core/thread_pool.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+struct PathQuery {
+    NavCell start;
+    NavCell goal;
+};
+
+struct PathResult {
+    bool found = false;
+    bool fromCache = false;
+    uint32_t cost = 0; // In NAV_STRAIGHT_COST units per straight step
+    std::vector<NavCell> path; // Start and goal included
+    double searchMs = 0.0; // Time spent searching, 0 for cache hits
+};
+
+struct PathServiceConfig {
+    int clusterSize = 32;
+    size_t maxCachedPaths = 4096; // Oldest are dropped first
+    size_t threadCount = 0; // For the pool created when none is given
+};
+
+// Pathfinding for many agents over a shared grid.
+//
+// Queries are answered in batches: collect the frame's requests and hand
+// them to findPaths, which spreads them over the thread pool. Each thread
+// searches with its own preallocated context, so a search takes no locks
+// and allocates nothing beyond the path it returns.
+//
+// Found paths are cached by start and goal, along with the version of
+// every cluster they pass through. An edit bumps the version of the
+// cluster it lands in, so only paths through edited clusters are searched
+// again; the rest stay valid, though a path may miss a shortcut an edit
+// opened elsewhere. Edits are applied to the hierarchical graph at the
+// start of the next batch, by rebuilding just the clusters they touch.
+//
+// Not thread-safe: edit and query from one thread.
+class PathService {
+public:
+    PathService(int width, int height, const PathServiceConfig& config = PathServiceConfig(), ThreadPool* pool = nullptr);
+
+    PathService(const PathService&) = delete;
+    PathService& operator=(const PathService&) = delete;
+
+    void setPassable(int x, int y, bool passable);
+    bool isPassable(int x, int y) const { return m_grid.isPassable(x, y); }
+    const NavGrid& getGrid() const { return m_grid; }
+    const HpaGraph& getGraph() const { return m_graph; }
+
+    // Answers every query; results[i] belongs to queries[i]
+    void findPaths(const std::vector<PathQuery>& queries, std::vector<PathResult>& results);
+
+    // Rebuilds clusters changed since the last call. findPaths does this
+    // first, so it is only worth calling to keep the cost out of a query.
+    // Returns the number of clusters rebuilt.
+    size_t updateGraph();
+
+    size_t getCachedPathCount() const { return m_cache.size(); }
+    size_t getCacheHits() const { return m_cacheHits; }
+    size_t getCacheMisses() const { return m_cacheMisses; }
+    void clearCache();
+
+private:
+    struct ClusterVersion {
+        uint32_t cluster;
+        uint32_t version;
+    };
+
+    struct CachedPath {
+        uint32_t cost;
+        std::vector<NavCell> path;
+        std::vector<ClusterVersion> clusters;
+    };
+
+    // Hands out contexts to whichever thread runs a chunk; no more chunks
+    // run at once than there are threads, so one is always free
+    NavSearchContext& acquireContext(size_t& index);
+    void releaseContext(size_t index);
+
+    uint64_t cacheKey(const PathQuery& query) const;
+    const CachedPath* findCached(const PathQuery& query) const;
+    void addCached(const PathQuery& query, const PathResult& result);
+
+    PathServiceConfig m_config;
+    std::unique_ptr<ThreadPool> m_ownedPool;
+    ThreadPool* m_pool;
+    NavGrid m_grid;
+    HpaGraph m_graph;
+    std::vector<std::unique_ptr<NavSearchContext>> m_contexts;
+    std::unique_ptr<std::atomic<bool>[]> m_contextBusy;
+
+    std::vector<uint32_t> m_clusterVersions;
+    std::vector<uint8_t> m_clusterDirty;
+    std::vector<int> m_dirtyClusters;
+
+    std::unordered_map<uint64_t, CachedPath> m_cache;
+    std::deque<uint64_t> m_cacheOrder; // Insertion order, for eviction
+    size_t m_cacheHits = 0;
+    size_t m_cacheMisses = 0;
+};
+
+#endif // PATH_SERVICE_H
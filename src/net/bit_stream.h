@@ -0,0 +1,91 @@
+#ifndef BIT_STREAM_H
+#define BIT_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Packs values of any width from 1 to 32 bits into a byte buffer, lowest
+// bit first, so the layout is the same on every host. Writing past the
+// end of the buffer is recorded instead of performed.
+class BitWriter {
+public:
+    BitWriter(uint8_t* data, size_t capacity) : m_data(data), m_capacity(capacity) {}
+
+    void writeBits(uint32_t value, int count) {
+        m_scratch |= static_cast<uint64_t>(value & lowBits(count)) << m_scratchBits;
+        m_scratchBits += count;
+        m_bitCount += count;
+        while (m_scratchBits >= 8) {
+            emitByte();
+        }
+    }
+    void writeBool(bool value) { writeBits(value ? 1u : 0u, 1); }
+
+    // Pads the last byte with zeros and returns the bytes written
+    size_t finish() {
+        if (m_scratchBits > 0) {
+            emitByte();
+        }
+        return m_byteCount;
+    }
+
+    size_t getBitCount() const { return m_bitCount; }
+    bool overflowed() const { return m_byteCount > m_capacity; }
+
+    static uint32_t lowBits(int count) { return count >= 32 ? 0xFFFFFFFFu : (1u << count) - 1u; }
+
+private:
+    void emitByte() {
+        if (m_byteCount < m_capacity) {
+            m_data[m_byteCount] = static_cast<uint8_t>(m_scratch);
+        }
+        ++m_byteCount;
+        m_scratch >>= 8;
+        m_scratchBits = m_scratchBits >= 8 ? m_scratchBits - 8 : 0;
+    }
+
+    uint8_t* m_data;
+    size_t m_capacity;
+    size_t m_byteCount = 0;
+    size_t m_bitCount = 0;
+    uint64_t m_scratch = 0;
+    int m_scratchBits = 0;
+};
+
+// Reads what BitWriter wrote. Reading past the end returns zeros and sets
+// the error flag, so a truncated packet can be parsed to the end and
+// rejected once.
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    uint32_t readBits(int count) {
+        while (m_scratchBits < count) {
+            uint64_t byte = 0;
+            if (m_byteIndex < m_size) {
+                byte = m_data[m_byteIndex++];
+            } else {
+                m_error = true;
+            }
+            m_scratch |= byte << m_scratchBits;
+            m_scratchBits += 8;
+        }
+        uint32_t value = static_cast<uint32_t>(m_scratch) & BitWriter::lowBits(count);
+        m_scratch >>= count;
+        m_scratchBits -= count;
+        return value;
+    }
+    bool readBool() { return readBits(1) != 0; }
+
+    bool hasError() const { return m_error; }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_byteIndex = 0;
+    uint64_t m_scratch = 0;
+    int m_scratchBits = 0;
+    bool m_error = false;
+};
+
+#endif // BIT_STREAM_H
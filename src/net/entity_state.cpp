@@ -0,0 +1,123 @@
+#include "entity_state.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const float TWO_PI = 6.28318531f;
+const uint32_t SMALL_DELTA_BITS = 5;
+const uint32_t MEDIUM_DELTA_BITS = 10;
+
+uint32_t quantize(float value, float extent, float scale, int bits) {
+    const float maxValue = static_cast<float>(BitWriter::lowBits(bits));
+    return static_cast<uint32_t>(std::clamp(std::round((value + extent) * scale), 0.0f, maxValue));
+}
+
+float dequantize(uint32_t value, float extent, float scale) {
+    return static_cast<float>(value) / scale - extent;
+}
+
+// Shortest signed step from baseline to current, wrapping at the field
+// width, mapped to unsigned so small steps either way stay small
+uint32_t zigzagDelta(uint32_t baseline, uint32_t current, int bits) {
+    const uint32_t mask = BitWriter::lowBits(bits);
+    uint32_t wrapped = (current - baseline) & mask;
+    int32_t delta = static_cast<int32_t>(wrapped);
+    if (wrapped > (mask >> 1)) {
+        delta -= static_cast<int32_t>(mask) + 1;
+    }
+    return (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+}
+
+uint32_t applyZigzag(uint32_t baseline, uint32_t zigzag, int bits) {
+    const int32_t delta = static_cast<int32_t>(zigzag >> 1) ^ -static_cast<int32_t>(zigzag & 1);
+    return (baseline + static_cast<uint32_t>(delta)) & BitWriter::lowBits(bits);
+}
+
+} // namespace
+
+QuantizedEntity quantizeEntity(const EntityState& state) {
+    QuantizedEntity entity;
+    entity.values[FIELD_X] = quantize(state.x, NET_POSITION_EXTENT, NET_POSITION_SCALE, ENTITY_FIELD_BITS[FIELD_X]);
+    entity.values[FIELD_Y] = quantize(state.y, NET_POSITION_EXTENT, NET_POSITION_SCALE, ENTITY_FIELD_BITS[FIELD_Y]);
+    const float turns = state.angle / TWO_PI;
+    const float steps = static_cast<float>(1u << ENTITY_FIELD_BITS[FIELD_ANGLE]);
+    entity.values[FIELD_ANGLE] = static_cast<uint32_t>(static_cast<int32_t>(std::lround((turns - std::floor(turns)) * steps))) &
+                                 BitWriter::lowBits(ENTITY_FIELD_BITS[FIELD_ANGLE]);
+    entity.values[FIELD_VX] = quantize(state.vx, NET_VELOCITY_EXTENT, NET_VELOCITY_SCALE, ENTITY_FIELD_BITS[FIELD_VX]);
+    entity.values[FIELD_VY] = quantize(state.vy, NET_VELOCITY_EXTENT, NET_VELOCITY_SCALE, ENTITY_FIELD_BITS[FIELD_VY]);
+    entity.values[FIELD_KIND] = state.kind;
+    return entity;
+}
+
+EntityState dequantizeEntity(const QuantizedEntity& entity) {
+    EntityState state;
+    state.kind = static_cast<uint8_t>(entity.values[FIELD_KIND]);
+    state.x = dequantize(entity.values[FIELD_X], NET_POSITION_EXTENT, NET_POSITION_SCALE);
+    state.y = dequantize(entity.values[FIELD_Y], NET_POSITION_EXTENT, NET_POSITION_SCALE);
+    state.angle = static_cast<float>(entity.values[FIELD_ANGLE]) * (TWO_PI / static_cast<float>(1u << ENTITY_FIELD_BITS[FIELD_ANGLE]));
+    state.vx = dequantize(entity.values[FIELD_VX], NET_VELOCITY_EXTENT, NET_VELOCITY_SCALE);
+    state.vy = dequantize(entity.values[FIELD_VY], NET_VELOCITY_EXTENT, NET_VELOCITY_SCALE);
+    return state;
+}
+
+void writeEntityDelta(BitWriter& writer, const QuantizedEntity& baseline, const QuantizedEntity& current) {
+    for (int field = 0; field < ENTITY_FIELD_COUNT; ++field) {
+        const int bits = ENTITY_FIELD_BITS[field];
+        if (current.values[field] == baseline.values[field]) {
+            writer.writeBool(false);
+            continue;
+        }
+        writer.writeBool(true);
+        const uint32_t zigzag = zigzagDelta(baseline.values[field], current.values[field], bits);
+        if (zigzag < (1u << SMALL_DELTA_BITS)) {
+            writer.writeBool(false);
+            writer.writeBits(zigzag, SMALL_DELTA_BITS);
+        } else if (zigzag < (1u << MEDIUM_DELTA_BITS) && bits > static_cast<int>(MEDIUM_DELTA_BITS)) {
+            writer.writeBits(0x1, 2); // Read back as 1 then 0
+            writer.writeBits(zigzag, MEDIUM_DELTA_BITS);
+        } else {
+            writer.writeBits(0x3, 2);
+            writer.writeBits(current.values[field], bits);
+        }
+    }
+}
+
+QuantizedEntity readEntityDelta(BitReader& reader, const QuantizedEntity& baseline) {
+    QuantizedEntity entity = baseline;
+    for (int field = 0; field < ENTITY_FIELD_COUNT; ++field) {
+        const int bits = ENTITY_FIELD_BITS[field];
+        if (!reader.readBool()) {
+            continue;
+        }
+        if (!reader.readBool()) {
+            entity.values[field] = applyZigzag(baseline.values[field], reader.readBits(SMALL_DELTA_BITS), bits);
+        } else if (!reader.readBool()) {
+            entity.values[field] = applyZigzag(baseline.values[field], reader.readBits(MEDIUM_DELTA_BITS), bits);
+        } else {
+            entity.values[field] = reader.readBits(bits);
+        }
+    }
+    return entity;
+}
+
+int measureEntityDelta(const QuantizedEntity& baseline, const QuantizedEntity& current) {
+    int total = 0;
+    for (int field = 0; field < ENTITY_FIELD_COUNT; ++field) {
+        const int bits = ENTITY_FIELD_BITS[field];
+        if (current.values[field] == baseline.values[field]) {
+            total += 1;
+            continue;
+        }
+        const uint32_t zigzag = zigzagDelta(baseline.values[field], current.values[field], bits);
+        if (zigzag < (1u << SMALL_DELTA_BITS)) {
+            total += 2 + SMALL_DELTA_BITS;
+        } else if (zigzag < (1u << MEDIUM_DELTA_BITS) && bits > static_cast<int>(MEDIUM_DELTA_BITS)) {
+            total += 3 + MEDIUM_DELTA_BITS;
+        } else {
+            total += 3 + bits;
+        }
+    }
+    return total;
+}
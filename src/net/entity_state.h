@@ -0,0 +1,59 @@
+#ifndef ENTITY_STATE_H
+#define ENTITY_STATE_H
+
+#include "bit_stream.h"
+
+#include <cstdint>
+#include <cstring>
+
+// Replicated state of one entity, in world units (meters, radians)
+struct EntityState {
+    uint8_t kind = 0; // 0 means the entity does not exist
+    float x = 0.0f;
+    float y = 0.0f;
+    float angle = 0.0f;
+    float vx = 0.0f;
+    float vy = 0.0f;
+};
+
+enum EntityField {
+    FIELD_X,
+    FIELD_Y,
+    FIELD_ANGLE,
+    FIELD_VX,
+    FIELD_VY,
+    FIELD_KIND,
+    ENTITY_FIELD_COUNT
+};
+
+// Quantization ranges. Positions cover +-4096 m in 1/64 m steps, angles a
+// full turn in 1024 steps, velocities +-64 m/s in 1/32 m/s steps.
+constexpr float NET_POSITION_EXTENT = 4096.0f;
+constexpr float NET_POSITION_SCALE = 64.0f;
+constexpr float NET_VELOCITY_EXTENT = 64.0f;
+constexpr float NET_VELOCITY_SCALE = 32.0f;
+constexpr int ENTITY_FIELD_BITS[ENTITY_FIELD_COUNT] = {19, 19, 10, 12, 12, 8};
+
+// Entity state as the integers that go on the wire. Deltas are taken
+// between two of these, never between floats, so sender and receiver
+// reconstruct exactly the same values.
+struct QuantizedEntity {
+    uint32_t values[ENTITY_FIELD_COUNT] = {};
+
+    bool operator==(const QuantizedEntity& other) const {
+        return std::memcmp(values, other.values, sizeof(values)) == 0;
+    }
+    bool operator!=(const QuantizedEntity& other) const { return !(*this == other); }
+};
+
+QuantizedEntity quantizeEntity(const EntityState& state);
+EntityState dequantizeEntity(const QuantizedEntity& entity);
+
+// Each field is a changed bit, and if changed, the difference to the
+// baseline in 5 or 10 bits, or the raw value when the difference is large
+void writeEntityDelta(BitWriter& writer, const QuantizedEntity& baseline, const QuantizedEntity& current);
+QuantizedEntity readEntityDelta(BitReader& reader, const QuantizedEntity& baseline);
+// Bits writeEntityDelta would use
+int measureEntityDelta(const QuantizedEntity& baseline, const QuantizedEntity& current);
+
+#endif // ENTITY_STATE_H
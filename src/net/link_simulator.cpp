@@ -0,0 +1,38 @@
+#include "link_simulator.h"
+
+LinkSimulator::LinkSimulator(const LinkConditions& conditions)
+    : m_conditions(conditions), m_rngState(conditions.seed ? conditions.seed : 1) {}
+
+float LinkSimulator::nextRandom() {
+    // xorshift32, plenty for deciding drops
+    m_rngState ^= m_rngState << 13;
+    m_rngState ^= m_rngState >> 17;
+    m_rngState ^= m_rngState << 5;
+    return static_cast<float>(m_rngState >> 8) * (1.0f / 16777216.0f);
+}
+
+void LinkSimulator::send(const Datagram& datagram, double now) {
+    if (nextRandom() < m_conditions.lossRate) {
+        ++m_dropped;
+        return;
+    }
+    const double delay = m_conditions.latency + m_conditions.jitter * nextRandom();
+    m_queued.push_back(Delayed{now + delay, datagram});
+}
+
+size_t LinkSimulator::flush(UdpSocket& socket, double now) {
+    m_due.clear();
+    size_t kept = 0;
+    for (size_t i = 0; i < m_queued.size(); ++i) {
+        if (m_queued[i].dueTime <= now) {
+            m_due.push_back(m_queued[i].datagram);
+        } else {
+            if (kept != i) {
+                m_queued[kept] = m_queued[i];
+            }
+            ++kept;
+        }
+    }
+    m_queued.resize(kept);
+    return socket.sendBatch(m_due.data(), m_due.size());
+}
@@ -0,0 +1,47 @@
+#ifndef LINK_SIMULATOR_H
+#define LINK_SIMULATOR_H
+
+#include "udp_socket.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct LinkConditions {
+    float lossRate = 0.0f; // Fraction of datagrams dropped
+    double latency = 0.0; // One-way delay in seconds
+    double jitter = 0.0; // Extra random delay up to this, which reorders
+    uint32_t seed = 1;
+};
+
+// Bad network in front of a socket, for testing over localhost. Outgoing
+// datagrams are held back by the latency plus jitter, or dropped, and the
+// ones that are due go out as one batch per flush. Time is passed in by
+// the caller, so runs are repeatable with a fixed seed.
+class LinkSimulator {
+public:
+    explicit LinkSimulator(const LinkConditions& conditions = LinkConditions());
+
+    void send(const Datagram& datagram, double now);
+    // Sends everything due by now through socket, returns how many went out
+    size_t flush(UdpSocket& socket, double now);
+
+    size_t getDroppedCount() const { return m_dropped; }
+    size_t getQueuedCount() const { return m_queued.size(); }
+
+private:
+    struct Delayed {
+        double dueTime;
+        Datagram datagram;
+    };
+
+    float nextRandom();
+
+    LinkConditions m_conditions;
+    uint32_t m_rngState;
+    std::vector<Delayed> m_queued;
+    std::vector<Datagram> m_due;
+    size_t m_dropped = 0;
+};
+
+#endif // LINK_SIMULATOR_H
@@ -0,0 +1,421 @@
+#include "replication.h"
+
+#include <algorithm>
+
+namespace {
+
+const uint32_t PROTOCOL_ID = 0x4745; // "GE"
+// Baseline ages are coded as "0" plus a short age, 0 meaning no baseline,
+// or "1" plus a long one
+const int SHORT_AGE_BITS = 4;
+const int LONG_AGE_BITS = 10;
+const size_t SNAPSHOT_HEADER_BITS = 16 + 8 + 16 + 32 + 16;
+// Entities go out in index order, each index coded as "1" for the one
+// after the previous, "01" plus a short gap, or "00" plus the full index.
+// The first entity's gap counts from zero.
+const int GAP_BITS = 6;
+
+static_assert((1u << LONG_AGE_BITS) - 1 == NET_MAX_BASELINE_AGE, "Baseline age must fit its field");
+static_assert(NET_ENTITY_HISTORY <= 256, "History position must fit in a byte");
+// Packet records are indexed by sequence number, which wraps at 16 bits
+const uint32_t SENT_PACKETS = NET_MAX_BASELINE_AGE + 1;
+static_assert(0x10000 % SENT_PACKETS == 0, "Packet records must divide the sequence space");
+
+int bitsFor(size_t count) {
+    int bits = 1;
+    while (bits < 32 && (size_t(1) << bits) < count) {
+        ++bits;
+    }
+    return bits;
+}
+
+// True if sequence a comes after b, allowing for wraparound
+bool sequenceNewer(uint16_t a, uint16_t b) {
+    return a != b && static_cast<uint16_t>(a - b) < 0x8000;
+}
+
+void writeHeader(BitWriter& writer, PacketType type) {
+    writer.writeBits(PROTOCOL_ID, 16);
+    writer.writeBits(static_cast<uint32_t>(type), 8);
+}
+
+// Calls write(value, bits) for each piece of the code, bits -1 meaning the
+// full index width
+template <typename Write>
+void forEachIndexCode(uint32_t previous, uint32_t index, bool first, Write write) {
+    const uint32_t gap = first ? index : index - previous - 1;
+    if (!first && gap == 0) {
+        write(1u, 1);
+    } else if (gap < (1u << GAP_BITS)) {
+        write(0x2u, 2); // Read back as 0 then 1
+        write(gap, GAP_BITS);
+    } else {
+        write(0u, 2);
+        write(index, -1);
+    }
+}
+
+void writeAge(BitWriter& writer, uint32_t age) {
+    if (age < (1u << SHORT_AGE_BITS)) {
+        writer.writeBits(age << 1, 1 + SHORT_AGE_BITS);
+    } else {
+        writer.writeBits((age << 1) | 1u, 1 + LONG_AGE_BITS);
+    }
+}
+
+int ageBits(uint32_t age) {
+    return 1 + (age < (1u << SHORT_AGE_BITS) ? SHORT_AGE_BITS : LONG_AGE_BITS);
+}
+
+const QuantizedEntity ABSENT_ENTITY;
+
+} // namespace
+
+PacketType readPacketType(const uint8_t* data, size_t size) {
+    BitReader reader(data, size);
+    if (reader.readBits(16) != PROTOCOL_ID) {
+        return PacketType::Invalid;
+    }
+    uint32_t type = reader.readBits(8);
+    if (reader.hasError() || type < static_cast<uint32_t>(PacketType::Connect) || type > static_cast<uint32_t>(PacketType::Ack)) {
+        return PacketType::Invalid;
+    }
+    return static_cast<PacketType>(type);
+}
+
+size_t writeConnectPacket(uint8_t* out, size_t capacity) {
+    BitWriter writer(out, capacity);
+    writeHeader(writer, PacketType::Connect);
+    size_t bytes = writer.finish();
+    return writer.overflowed() ? 0 : bytes;
+}
+
+ReplicationServer::ReplicationServer(const ReplicationConfig& config)
+    : m_config(config),
+      m_indexBits(bitsFor(config.maxEntities)),
+      m_states(config.maxEntities),
+      m_quantized(config.maxEntities),
+      m_versions(config.maxEntities, 0) {}
+
+void ReplicationServer::setEntity(size_t index, const EntityState& state) {
+    m_states[index] = state;
+    const QuantizedEntity quantized = state.kind != 0 ? quantizeEntity(state) : ABSENT_ENTITY;
+    if (quantized != m_quantized[index]) {
+        m_quantized[index] = quantized;
+        ++m_versions[index];
+    }
+}
+
+void ReplicationServer::removeEntity(size_t index) {
+    setEntity(index, EntityState());
+}
+
+int ReplicationServer::addClient() {
+    size_t slot = 0;
+    while (slot < m_clients.size() && m_clients[slot].active) {
+        ++slot;
+    }
+    if (slot == m_clients.size()) {
+        m_clients.emplace_back();
+    }
+    Client& client = m_clients[slot];
+    client = Client();
+    client.active = true;
+    const size_t count = m_states.size();
+    client.entities.assign(count, ClientEntity());
+    client.sent.resize(SENT_PACKETS);
+    return static_cast<int>(slot);
+}
+
+void ReplicationServer::removeClient(int client) {
+    // Drop the per-entity arrays now, the slot is reset when reused
+    m_clients[client] = Client();
+}
+
+void ReplicationServer::setClientFocus(int client, float x, float y) {
+    m_clients[client].focusX = x;
+    m_clients[client].focusY = y;
+}
+
+bool ReplicationServer::usableBaseline(const Client& client, const ClientEntity& entity) const {
+    // The client must still have the baseline among its last versions
+    return entity.hasBaseline && client.nextPacket - entity.baselinePacket <= NET_MAX_BASELINE_AGE &&
+           entity.sendCount - entity.baselineSendCount < NET_ENTITY_HISTORY;
+}
+
+uint32_t ReplicationServer::entityBits(const Client& client, uint32_t e) const {
+    const ClientEntity& entity = client.entities[e];
+    if (!usableBaseline(client, entity)) {
+        return static_cast<uint32_t>(ageBits(0) + measureEntityDelta(ABSENT_ENTITY, m_quantized[e]));
+    }
+    return static_cast<uint32_t>(ageBits(client.nextPacket - entity.baselinePacket) +
+                                 measureEntityDelta(entity.baseline, m_quantized[e]));
+}
+
+size_t ReplicationServer::indexCodeBits(const std::vector<Candidate>& sorted) const {
+    size_t bits = 0;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        forEachIndexCode(i ? sorted[i - 1].entity : 0, sorted[i].entity, i == 0,
+                         [&](uint32_t, int count) { bits += count < 0 ? m_indexBits : count; });
+    }
+    return bits;
+}
+
+void ReplicationServer::chooseEntities(Client& client, size_t budgetBits) {
+    const float invRadiusSq = 1.0f / (m_config.relevanceRadius * m_config.relevanceRadius);
+    client.candidates.clear();
+    client.chosen.clear();
+
+    for (size_t e = 0; e < m_quantized.size(); ++e) {
+        ClientEntity& entity = client.entities[e];
+        // Sends are in version order, so once the current version is acked
+        // no later send can have left the client with anything else
+        const bool settled = entity.sendCount == 0 || (entity.hasBaseline && entity.baselineVersion == m_versions[e]);
+        if (settled && m_quantized[e] == entity.baseline) {
+            entity.priority = 0.0f;
+            continue;
+        }
+        const EntityState& state = m_states[e];
+        const float dx = state.x - client.focusX;
+        const float dy = state.y - client.focusY;
+        entity.priority += std::max(1.0f / (1.0f + (dx * dx + dy * dy) * invRadiusSq), m_config.minRelevance);
+        client.candidates.push_back(Candidate{entity.priority, static_cast<uint32_t>(e), 0});
+    }
+    client.stats.entitiesChanged = client.candidates.size();
+
+    // Only the front of the priority order can fit, so only that is sorted
+    // and measured
+    const size_t worstIndex = static_cast<size_t>(2 + m_indexBits);
+    const size_t minEntityBits = 1 + SHORT_AGE_BITS + ENTITY_FIELD_COUNT + 2;
+    const size_t considered = std::min(client.candidates.size(), budgetBits / minEntityBits + 1);
+    auto byPriority = [](const Candidate& a, const Candidate& b) {
+        return a.priority > b.priority || (a.priority == b.priority && a.entity < b.entity);
+    };
+    if (considered < client.candidates.size()) {
+        std::nth_element(client.candidates.begin(), client.candidates.begin() + considered, client.candidates.end(), byPriority);
+    }
+    std::sort(client.candidates.begin(), client.candidates.begin() + considered, byPriority);
+
+    // Take candidates while they fit assuming the worst index code, then
+    // work out what the index codes really cost in index order and fill
+    // the room that freed up, until nothing more fits
+    size_t used = 0;
+    size_t next = 0;
+    for (;;) {
+        const size_t before = client.chosen.size();
+        for (; next < considered; ++next) {
+            Candidate& candidate = client.candidates[next];
+            if (budgetBits - used < minEntityBits + worstIndex) {
+                break;
+            }
+            candidate.bits = entityBits(client, candidate.entity);
+            if (used + candidate.bits + worstIndex > budgetBits) {
+                continue;
+            }
+            used += candidate.bits + worstIndex;
+            client.chosen.push_back(candidate);
+        }
+        if (client.chosen.size() == before) {
+            break;
+        }
+        std::sort(client.chosen.begin(), client.chosen.end(),
+                  [](const Candidate& a, const Candidate& b) { return a.entity < b.entity; });
+        used = indexCodeBits(client.chosen);
+        for (const Candidate& candidate : client.chosen) {
+            used += candidate.bits;
+        }
+        if (next >= considered) {
+            break;
+        }
+    }
+}
+
+size_t ReplicationServer::writeSnapshot(int clientId, uint8_t* out, size_t capacity) {
+    Client& client = m_clients[clientId];
+    const size_t budgetBytes = std::min(capacity, m_config.bytesPerTick);
+    if (budgetBytes * 8 < SNAPSHOT_HEADER_BITS) {
+        return 0;
+    }
+    chooseEntities(client, budgetBytes * 8 - SNAPSHOT_HEADER_BITS);
+
+    const uint32_t packet = client.nextPacket;
+    SentPacket& record = client.sent[packet % SENT_PACKETS];
+    record.packet = packet;
+    record.valid = true;
+    record.acked = false;
+    record.entities.clear();
+
+    BitWriter writer(out, budgetBytes);
+    writeHeader(writer, PacketType::Snapshot);
+    writer.writeBits(packet & 0xFFFF, 16);
+    writer.writeBits(m_tick, 32);
+    writer.writeBits(static_cast<uint32_t>(client.chosen.size()), 16);
+
+    client.stats.fullStates = 0;
+    for (size_t i = 0; i < client.chosen.size(); ++i) {
+        const uint32_t e = client.chosen[i].entity;
+        forEachIndexCode(i ? client.chosen[i - 1].entity : 0, e, i == 0,
+                         [&](uint32_t value, int count) { writer.writeBits(value, count < 0 ? m_indexBits : count); });
+        ClientEntity& entity = client.entities[e];
+        if (usableBaseline(client, entity)) {
+            writeAge(writer, packet - entity.baselinePacket);
+            writeEntityDelta(writer, entity.baseline, m_quantized[e]);
+        } else {
+            writeAge(writer, 0);
+            writeEntityDelta(writer, ABSENT_ENTITY, m_quantized[e]);
+            ++client.stats.fullStates;
+        }
+        entity.priority = 0.0f;
+        ++entity.sendCount;
+        record.entities.push_back(SentEntity{e, entity.sendCount, m_versions[e], m_quantized[e]});
+    }
+
+    ++client.nextPacket;
+    client.stats.bytes = writer.finish();
+    client.stats.entitiesSent = client.chosen.size();
+    return client.stats.bytes;
+}
+
+bool ReplicationServer::readAck(int clientId, const uint8_t* data, size_t size) {
+    Client& client = m_clients[clientId];
+    if (readPacketType(data, size) != PacketType::Ack) {
+        return false;
+    }
+    BitReader reader(data, size);
+    reader.readBits(24);
+    const uint16_t latest = static_cast<uint16_t>(reader.readBits(16));
+    const uint32_t ackBits = reader.readBits(32);
+    if (reader.hasError()) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < NET_ACK_WINDOW; ++i) {
+        if (i > 0 && !(ackBits & (1u << (i - 1)))) {
+            continue;
+        }
+        const uint16_t sequence = static_cast<uint16_t>(latest - i);
+        SentPacket& record = client.sent[sequence % SENT_PACKETS];
+        if (!record.valid || record.acked || static_cast<uint16_t>(record.packet) != sequence) {
+            continue;
+        }
+        record.acked = true;
+        // Only move baselines forward; an ack can arrive after a newer one
+        for (const SentEntity& sent : record.entities) {
+            ClientEntity& entity = client.entities[sent.entity];
+            if (!entity.hasBaseline || static_cast<int32_t>(record.packet - entity.baselinePacket) > 0) {
+                entity.baseline = sent.state;
+                entity.baselinePacket = record.packet;
+                entity.baselineSendCount = sent.sendCount;
+                entity.baselineVersion = sent.version;
+                entity.hasBaseline = true;
+            }
+        }
+    }
+    return true;
+}
+
+ReplicationClient::ReplicationClient(size_t maxEntities)
+    : m_current(maxEntities),
+      m_history(maxEntities * NET_ENTITY_HISTORY),
+      m_historySequences(maxEntities * NET_ENTITY_HISTORY, 0),
+      m_historyNext(maxEntities, 0),
+      m_indexBits(bitsFor(maxEntities)) {}
+
+bool ReplicationClient::readSnapshot(const uint8_t* data, size_t size) {
+    if (readPacketType(data, size) != PacketType::Snapshot) {
+        return false;
+    }
+    BitReader reader(data, size);
+    reader.readBits(24);
+    const uint16_t sequence = static_cast<uint16_t>(reader.readBits(16));
+    const uint32_t tick = reader.readBits(32);
+    const uint32_t count = reader.readBits(16);
+    if (reader.hasError() || (m_hasLatest && !sequenceNewer(sequence, m_latestSequence))) {
+        return false;
+    }
+
+    // Decode everything before touching any state, so a bad packet
+    // leaves no trace
+    m_decodedEntities.clear();
+    m_decodedStates.clear();
+    uint32_t previous = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t index;
+        if (reader.readBool()) {
+            if (i == 0) {
+                return false;
+            }
+            index = previous + 1;
+        } else if (reader.readBool()) {
+            const uint32_t gap = reader.readBits(GAP_BITS);
+            index = i == 0 ? gap : previous + 1 + gap;
+        } else {
+            index = reader.readBits(m_indexBits);
+        }
+        if (index >= m_current.size() || (i > 0 && index <= previous)) {
+            return false;
+        }
+
+        const QuantizedEntity* baseline = &ABSENT_ENTITY;
+        const uint32_t age = reader.readBool() ? reader.readBits(LONG_AGE_BITS) : reader.readBits(SHORT_AGE_BITS);
+        if (age > 0) {
+            // Newest first, though a sequence number only shows up once
+            // among the versions kept
+            const uint16_t baselineSequence = static_cast<uint16_t>(sequence - age);
+            const size_t base = index * NET_ENTITY_HISTORY;
+            uint32_t slot = m_historyNext[index];
+            for (uint32_t k = 0; k < NET_ENTITY_HISTORY; ++k) {
+                slot = (slot == 0 ? NET_ENTITY_HISTORY : slot) - 1;
+                if (m_historySequences[base + slot] == baselineSequence) {
+                    baseline = &m_history[base + slot];
+                    break;
+                }
+            }
+            if (baseline == &ABSENT_ENTITY) {
+                return false;
+            }
+        }
+        m_decodedStates.push_back(readEntityDelta(reader, *baseline));
+        m_decodedEntities.push_back(index);
+        previous = index;
+    }
+    if (reader.hasError()) {
+        return false;
+    }
+
+    for (size_t k = 0; k < m_decodedEntities.size(); ++k) {
+        const uint32_t e = m_decodedEntities[k];
+        const size_t slot = e * NET_ENTITY_HISTORY + m_historyNext[e];
+        m_current[e] = m_decodedStates[k];
+        m_history[slot] = m_decodedStates[k];
+        m_historySequences[slot] = sequence;
+        m_historyNext[e] = static_cast<uint8_t>((m_historyNext[e] + 1) % NET_ENTITY_HISTORY);
+    }
+
+    if (m_hasLatest) {
+        const uint32_t shift = static_cast<uint16_t>(sequence - m_latestSequence);
+        if (shift > 32) {
+            m_ackBits = 0;
+        } else {
+            // The previous latest becomes bit shift - 1
+            m_ackBits = (shift == 32 ? 0 : m_ackBits << shift) | (1u << (shift - 1));
+        }
+    }
+    m_hasLatest = true;
+    m_latestSequence = sequence;
+    m_tick = tick;
+    ++m_snapshotCount;
+    return true;
+}
+
+size_t ReplicationClient::writeAck(uint8_t* out, size_t capacity) const {
+    if (!m_hasLatest) {
+        return 0;
+    }
+    BitWriter writer(out, capacity);
+    writeHeader(writer, PacketType::Ack);
+    writer.writeBits(m_latestSequence, 16);
+    writer.writeBits(m_ackBits, 32);
+    size_t bytes = writer.finish();
+    return writer.overflowed() ? 0 : bytes;
+}
@@ -0,0 +1,187 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include "entity_state.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class PacketType : uint8_t {
+    Invalid = 0,
+    Connect = 1, // Client to server, asks for snapshots
+    Snapshot = 2, // Server to client
+    Ack = 3 // Client to server, which snapshots arrived
+};
+
+// An ack covers the latest snapshot and the this many before it
+constexpr uint32_t NET_ACK_WINDOW = 32;
+// Versions of each entity a client keeps to decode deltas against
+constexpr uint32_t NET_ENTITY_HISTORY = 16;
+// Baselines older than this many snapshots are not used
+constexpr uint32_t NET_MAX_BASELINE_AGE = 1023;
+
+// Type of a packet in this protocol, Invalid for anything else
+PacketType readPacketType(const uint8_t* data, size_t size);
+size_t writeConnectPacket(uint8_t* out, size_t capacity);
+
+struct ReplicationConfig {
+    size_t maxEntities = 8192; // Clients must use the same value
+    size_t bytesPerTick = 1200; // Snapshot size limit per client and tick
+    // Entities within this distance of a client's focus are the most
+    // relevant to it; relevance falls off with distance squared beyond
+    float relevanceRadius = 30.0f;
+    float minRelevance = 0.05f; // Far away entities still get through
+};
+
+struct SnapshotStats {
+    size_t bytes = 0;
+    size_t entitiesSent = 0;
+    size_t entitiesChanged = 0; // Not known to be up to date on the client
+    size_t fullStates = 0; // Sent without a baseline
+};
+
+// Authoritative side of entity replication.
+//
+// Every snapshot is a delta: each entity is compared with the last state
+// the client has acknowledged for it (its baseline) and only changed
+// fields go out, quantized and bit-packed. Baselines are tracked per
+// client and per entity, and move forward when an ack arrives for a
+// packet that carried the entity, so lost packets cost nothing but a
+// later, slightly larger delta. Until the client acks a packet carrying
+// an entity's current state, the entity counts as changed, since the
+// client may hold any state sent since its baseline. Packets are
+// remembered for as long as they could serve as a baseline, so slow acks
+// still move baselines forward. The client keeps the last
+// NET_ENTITY_HISTORY versions of every entity; a baseline the client may
+// already have dropped is never used, the full state is sent instead.
+//
+// Each snapshot fits in bytesPerTick. Changed entities build up priority
+// every tick by their relevance to the client's focus point, the highest
+// are sent first, and sending one resets its priority, so nothing starves
+// and nearby entities update most often.
+//
+// Snapshots for different clients may be written on different threads at
+// the same time, as long as entities are not changed meanwhile.
+class ReplicationServer {
+public:
+    explicit ReplicationServer(const ReplicationConfig& config = ReplicationConfig());
+
+    void setEntity(size_t index, const EntityState& state);
+    void removeEntity(size_t index);
+    const EntityState& getEntity(size_t index) const { return m_states[index]; }
+    size_t getMaxEntities() const { return m_states.size(); }
+
+    // Advances the tick number carried by snapshots
+    void beginTick() { ++m_tick; }
+    uint32_t getTick() const { return m_tick; }
+
+    // Returns the client id; slots of removed clients are reused
+    int addClient();
+    void removeClient(int client);
+    void setClientFocus(int client, float x, float y);
+
+    // Writes client's next snapshot to out and returns its size
+    size_t writeSnapshot(int client, uint8_t* out, size_t capacity);
+    // Applies an ack from client. Returns false if the packet is malformed.
+    bool readAck(int client, const uint8_t* data, size_t size);
+
+    const SnapshotStats& getSnapshotStats(int client) const { return m_clients[client].stats; }
+
+private:
+    struct SentEntity {
+        uint32_t entity;
+        uint32_t sendCount; // The entity's send count including this one
+        uint32_t version;
+        QuantizedEntity state;
+    };
+
+    struct SentPacket {
+        uint32_t packet = 0;
+        bool valid = false;
+        bool acked = false;
+        std::vector<SentEntity> entities;
+    };
+
+    struct Candidate {
+        float priority;
+        uint32_t entity;
+        uint32_t bits; // Measured only once the candidate is considered
+    };
+
+    // Per-entity state of one client, kept together since it is all read
+    // for every entity every tick
+    struct ClientEntity {
+        QuantizedEntity baseline; // What the client acked, absent until then
+        uint32_t baselinePacket = 0;
+        uint32_t baselineSendCount = 0;
+        uint32_t baselineVersion = 0;
+        uint32_t sendCount = 0; // Times sent to this client
+        float priority = 0.0f;
+        bool hasBaseline = false;
+    };
+
+    struct Client {
+        bool active = false;
+        uint32_t nextPacket = 0; // Sequence numbers are its low 16 bits
+        float focusX = 0.0f;
+        float focusY = 0.0f;
+        std::vector<ClientEntity> entities;
+        // Indexed by packet number, NET_MAX_BASELINE_AGE + 1 of them, so an
+        // ack is matched for as long as its packet can be a baseline
+        std::vector<SentPacket> sent;
+        std::vector<Candidate> candidates;
+        std::vector<Candidate> chosen;
+        SnapshotStats stats;
+    };
+
+    bool usableBaseline(const Client& client, const ClientEntity& entity) const;
+    uint32_t entityBits(const Client& client, uint32_t entity) const;
+    void chooseEntities(Client& client, size_t budgetBits);
+    size_t indexCodeBits(const std::vector<Candidate>& sorted) const;
+
+    ReplicationConfig m_config;
+    int m_indexBits;
+    std::vector<EntityState> m_states;
+    std::vector<QuantizedEntity> m_quantized;
+    std::vector<uint32_t> m_versions; // Bumped whenever m_quantized changes
+    std::vector<Client> m_clients;
+    uint32_t m_tick = 0;
+};
+
+// Receiving side: rebuilds entity state from snapshots and acks them.
+// Snapshots older than the newest one applied are ignored, as are any that
+// cannot be decoded; neither is acked, so the server never uses them as a
+// baseline.
+class ReplicationClient {
+public:
+    explicit ReplicationClient(size_t maxEntities = 8192);
+
+    bool readSnapshot(const uint8_t* data, size_t size);
+    size_t writeAck(uint8_t* out, size_t capacity) const;
+
+    // kind is 0 for entities that do not exist
+    EntityState getEntity(size_t index) const { return dequantizeEntity(m_current[index]); }
+    const QuantizedEntity& getQuantizedEntity(size_t index) const { return m_current[index]; }
+    size_t getMaxEntities() const { return m_current.size(); }
+    uint32_t getTick() const { return m_tick; }
+    size_t getSnapshotCount() const { return m_snapshotCount; }
+
+private:
+    std::vector<QuantizedEntity> m_current;
+    // Last NET_ENTITY_HISTORY versions of each entity, oldest overwritten
+    // first, tagged with the sequence number of the snapshot they came in
+    std::vector<QuantizedEntity> m_history;
+    std::vector<uint16_t> m_historySequences;
+    std::vector<uint8_t> m_historyNext;
+    std::vector<uint32_t> m_decodedEntities;
+    std::vector<QuantizedEntity> m_decodedStates;
+    int m_indexBits;
+    bool m_hasLatest = false;
+    uint16_t m_latestSequence = 0;
+    uint32_t m_ackBits = 0; // Bit i set: m_latestSequence - 1 - i applied
+    uint32_t m_tick = 0;
+    size_t m_snapshotCount = 0;
+};
+
+#endif // REPLICATION_H
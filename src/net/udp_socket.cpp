@@ -0,0 +1,211 @@
+#include "udp_socket.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <mutex>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+const uintptr_t NO_SOCKET = static_cast<uintptr_t>(INVALID_SOCKET);
+using AddressLength = int;
+
+void startWinsock() {
+    static std::once_flag started;
+    std::call_once(started, [] {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+    });
+}
+#else
+const int NO_SOCKET = -1;
+using AddressLength = socklen_t;
+#endif
+
+#ifdef __linux__
+// Datagrams moved per sendmmsg or recvmmsg call
+const size_t SYSCALL_BATCH = 64;
+#endif
+
+sockaddr_in toSockaddr(const NetAddress& address) {
+    sockaddr_in result;
+    std::memset(&result, 0, sizeof(result));
+    result.sin_family = AF_INET;
+    result.sin_addr.s_addr = htonl(address.ip);
+    result.sin_port = htons(address.port);
+    return result;
+}
+
+NetAddress fromSockaddr(const sockaddr_in& address) {
+    NetAddress result;
+    result.ip = ntohl(address.sin_addr.s_addr);
+    result.port = ntohs(address.sin_port);
+    return result;
+}
+
+} // namespace
+
+UdpSocket::UdpSocket() : m_socket(NO_SOCKET) {}
+
+UdpSocket::~UdpSocket() {
+    close();
+}
+
+bool UdpSocket::open(uint32_t ip, uint16_t port) {
+    close();
+#ifdef _WIN32
+    startWinsock();
+#endif
+    m_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (m_socket == NO_SOCKET) {
+        return false;
+    }
+
+    NetAddress requested;
+    requested.ip = ip;
+    requested.port = port;
+    sockaddr_in address = toSockaddr(requested);
+    bool ok = bind(m_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+
+    // Reading back the address fills in the port picked for port 0
+    AddressLength length = sizeof(address);
+    ok = ok && getsockname(m_socket, reinterpret_cast<sockaddr*>(&address), &length) == 0;
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ok = ok && ioctlsocket(m_socket, FIONBIO, &nonBlocking) == 0;
+#else
+    ok = ok && fcntl(m_socket, F_SETFL, fcntl(m_socket, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+    if (!ok) {
+        close();
+        return false;
+    }
+    m_localAddress = fromSockaddr(address);
+    return true;
+}
+
+void UdpSocket::close() {
+    if (m_socket == NO_SOCKET) {
+        return;
+    }
+#ifdef _WIN32
+    closesocket(m_socket);
+#else
+    ::close(m_socket);
+#endif
+    m_socket = NO_SOCKET;
+    m_localAddress = NetAddress();
+}
+
+bool UdpSocket::isOpen() const {
+    return m_socket != NO_SOCKET;
+}
+
+size_t UdpSocket::sendBatch(const Datagram* datagrams, size_t count) {
+    if (m_socket == NO_SOCKET) {
+        return 0;
+    }
+    size_t sent = 0;
+#ifdef __linux__
+    mmsghdr headers[SYSCALL_BATCH];
+    iovec buffers[SYSCALL_BATCH];
+    sockaddr_in addresses[SYSCALL_BATCH];
+    while (sent < count) {
+        const size_t batch = std::min(count - sent, SYSCALL_BATCH);
+        for (size_t i = 0; i < batch; ++i) {
+            const Datagram& datagram = datagrams[sent + i];
+            addresses[i] = toSockaddr(datagram.address);
+            buffers[i].iov_base = const_cast<uint8_t*>(datagram.data);
+            buffers[i].iov_len = datagram.size;
+            std::memset(&headers[i], 0, sizeof(mmsghdr));
+            headers[i].msg_hdr.msg_name = &addresses[i];
+            headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            headers[i].msg_hdr.msg_iov = &buffers[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+        int result = sendmmsg(m_socket, headers, static_cast<unsigned int>(batch), 0);
+        if (result <= 0) {
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        sent += static_cast<size_t>(result);
+    }
+#else
+    for (; sent < count; ++sent) {
+        const Datagram& datagram = datagrams[sent];
+        sockaddr_in address = toSockaddr(datagram.address);
+        if (sendto(m_socket, reinterpret_cast<const char*>(datagram.data), datagram.size, 0,
+                   reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+            break;
+        }
+    }
+#endif
+    return sent;
+}
+
+size_t UdpSocket::receiveBatch(Datagram* datagrams, size_t maxCount) {
+    if (m_socket == NO_SOCKET) {
+        return 0;
+    }
+    size_t received = 0;
+#ifdef __linux__
+    mmsghdr headers[SYSCALL_BATCH];
+    iovec buffers[SYSCALL_BATCH];
+    sockaddr_in addresses[SYSCALL_BATCH];
+    while (received < maxCount) {
+        const size_t batch = std::min(maxCount - received, SYSCALL_BATCH);
+        for (size_t i = 0; i < batch; ++i) {
+            buffers[i].iov_base = datagrams[received + i].data;
+            buffers[i].iov_len = NET_MAX_DATAGRAM;
+            std::memset(&headers[i], 0, sizeof(mmsghdr));
+            headers[i].msg_hdr.msg_name = &addresses[i];
+            headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            headers[i].msg_hdr.msg_iov = &buffers[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+        int result = recvmmsg(m_socket, headers, static_cast<unsigned int>(batch), MSG_DONTWAIT, nullptr);
+        if (result <= 0) {
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < result; ++i) {
+            Datagram& datagram = datagrams[received + i];
+            datagram.address = fromSockaddr(addresses[i]);
+            datagram.size = static_cast<uint16_t>(headers[i].msg_len);
+        }
+        received += static_cast<size_t>(result);
+        if (static_cast<size_t>(result) < batch) {
+            break; // Queue drained
+        }
+    }
+#else
+    for (; received < maxCount; ++received) {
+        Datagram& datagram = datagrams[received];
+        sockaddr_in address;
+        AddressLength length = sizeof(address);
+        int result = recvfrom(m_socket, reinterpret_cast<char*>(datagram.data), static_cast<int>(NET_MAX_DATAGRAM), 0,
+                              reinterpret_cast<sockaddr*>(&address), &length);
+        if (result < 0) {
+            break;
+        }
+        datagram.address = fromSockaddr(address);
+        datagram.size = static_cast<uint16_t>(result);
+    }
+#endif
+    return received;
+}
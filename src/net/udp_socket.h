@@ -0,0 +1,59 @@
+#ifndef UDP_SOCKET_H
+#define UDP_SOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Largest datagram sent or received, safely under a typical path MTU
+constexpr size_t NET_MAX_DATAGRAM = 1200;
+
+// IPv4 address and port, both in host byte order
+struct NetAddress {
+    uint32_t ip = 0;
+    uint16_t port = 0;
+
+    bool operator==(const NetAddress& other) const { return ip == other.ip && port == other.port; }
+    bool operator!=(const NetAddress& other) const { return !(*this == other); }
+};
+
+constexpr uint32_t NET_LOOPBACK_IP = 0x7F000001u; // 127.0.0.1
+
+struct Datagram {
+    NetAddress address; // Destination when sending, source when received
+    uint16_t size = 0;
+    uint8_t data[NET_MAX_DATAGRAM];
+};
+
+// Non-blocking IPv4 UDP socket that moves datagrams in batches. On Linux
+// a batch is a single sendmmsg or recvmmsg call; elsewhere it falls back
+// to one sendto or recvfrom per datagram.
+class UdpSocket {
+public:
+    UdpSocket();
+    ~UdpSocket();
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+
+    // Binds to ip:port, port 0 picks a free one. Returns false on failure.
+    bool open(uint32_t ip, uint16_t port);
+    void close();
+    bool isOpen() const;
+    NetAddress getLocalAddress() const { return m_localAddress; }
+
+    // Hands the datagrams to the kernel and returns how many it took; the
+    // rest were dropped because the send buffer is full
+    size_t sendBatch(const Datagram* datagrams, size_t count);
+    // Fills up to maxCount datagrams with what has already arrived and
+    // returns how many; never waits
+    size_t receiveBatch(Datagram* datagrams, size_t maxCount);
+
+private:
+#ifdef _WIN32
+    uintptr_t m_socket;
+#else
+    int m_socket;
+#endif
+    NetAddress m_localAddress;
+};
+
+#endif // UDP_SOCKET_H
@@ -0,0 +1,49 @@
+#include "particle_kernels.h"
+#include "../core/cpu_features.h"
+
+#include <algorithm>
+
+void updateParticlesScalar(const ParticleArrays& p, size_t begin, size_t end, const ParticleKernelParams& params) {
+    const float dt = params.dt;
+    const float curveScale = static_cast<float>(PARTICLE_CURVE_SAMPLES - 1);
+    for (size_t i = begin; i < end; ++i) {
+        float vx = p.vx[i] * params.damping + params.accelX * dt;
+        float vy = p.vy[i] * params.damping + params.accelY * dt;
+        float x = p.x[i] + vx * dt;
+        float y = p.y[i] + vy * dt;
+
+        for (int k = 0; k < params.planeCount; ++k) {
+            const ParticlePlane& plane = params.planes[k];
+            float dist = plane.nx * x + plane.ny * y - plane.d;
+            if (dist < 0.0f) {
+                x -= plane.nx * dist;
+                y -= plane.ny * dist;
+                float vn = vx * plane.nx + vy * plane.ny;
+                if (vn < 0.0f) {
+                    float bounce = (1.0f + params.restitution) * vn;
+                    vx -= plane.nx * bounce;
+                    vy -= plane.ny * bounce;
+                }
+            }
+        }
+
+        float age = p.age[i] + dt;
+        float t = std::min(age * p.invLifetime[i], 1.0f);
+        int sample = static_cast<int>(t * curveScale);
+
+        p.x[i] = x;
+        p.y[i] = y;
+        p.vx[i] = vx;
+        p.vy[i] = vy;
+        p.age[i] = age;
+        p.size[i] = params.sizeCurve[sample];
+        p.color[i] = params.colorCurve[sample];
+    }
+}
+
+void updateParticles(const ParticleArrays& particles, size_t begin, size_t end, const ParticleKernelParams& params) {
+    if (cpuSupportsAvx2Fma() && updateParticlesAvx2(particles, begin, end, params)) {
+        return;
+    }
+    updateParticlesScalar(particles, begin, end, params);
+}
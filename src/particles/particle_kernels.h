@@ -0,0 +1,52 @@
+#ifndef PARTICLE_KERNELS_H
+#define PARTICLE_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Samples per baked life curve, indexed by normalised age
+constexpr int PARTICLE_CURVE_SAMPLES = 64;
+constexpr int MAX_PARTICLE_PLANES = 4;
+
+// Particles are pushed out of the negative side of nx * x + ny * y = d
+struct ParticlePlane {
+    float nx = 0.0f;
+    float ny = 1.0f;
+    float d = 0.0f;
+};
+
+// Structure-of-arrays view of a particle pool
+struct ParticleArrays {
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    float* age;
+    float* invLifetime;
+    float* size;
+    uint32_t* color; // RGBA8, red in the low byte
+};
+
+struct ParticleKernelParams {
+    float dt = 0.0f;
+    float accelX = 0.0f;
+    float accelY = 0.0f;
+    float damping = 1.0f;      // Velocity scale per step, 1 - drag * dt
+    float restitution = 0.5f;
+    int planeCount = 0;
+    ParticlePlane planes[MAX_PARTICLE_PLANES];
+    const float* sizeCurve = nullptr;    // PARTICLE_CURVE_SAMPLES entries
+    const uint32_t* colorCurve = nullptr; // PARTICLE_CURVE_SAMPLES entries
+};
+
+// Integrates, collides and applies life curves to particles [begin, end).
+// Particles whose age reaches their lifetime are left for the caller to
+// compact. Picks the AVX2 kernel when the CPU has AVX2 and FMA.
+void updateParticles(const ParticleArrays& particles, size_t begin, size_t end, const ParticleKernelParams& params);
+
+// Individual kernels, exposed for the benchmark and tests
+void updateParticlesScalar(const ParticleArrays& particles, size_t begin, size_t end, const ParticleKernelParams& params);
+// Returns false without touching anything if the AVX2 kernel was not built
+bool updateParticlesAvx2(const ParticleArrays& particles, size_t begin, size_t end, const ParticleKernelParams& params);
+
+#endif // PARTICLE_KERNELS_H
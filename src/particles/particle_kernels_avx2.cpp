@@ -0,0 +1,71 @@
+// Built with AVX2/FMA enabled (see CMakeLists.txt) and only called after a
+// runtime CPU check, so nothing here may run on older processors.
+#include "particle_kernels.h"
+
+// MSVC's /arch:AVX2 enables FMA as well but never defines __FMA__
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+
+bool updateParticlesAvx2(const ParticleArrays& p, size_t begin, size_t end, const ParticleKernelParams& params) {
+    const __m256 dt = _mm256_set1_ps(params.dt);
+    const __m256 damping = _mm256_set1_ps(params.damping);
+    const __m256 accelX = _mm256_set1_ps(params.accelX * params.dt);
+    const __m256 accelY = _mm256_set1_ps(params.accelY * params.dt);
+    const __m256 bounceScale = _mm256_set1_ps(1.0f + params.restitution);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 curveScale = _mm256_set1_ps(static_cast<float>(PARTICLE_CURVE_SAMPLES - 1));
+    const int* colorCurve = reinterpret_cast<const int*>(params.colorCurve);
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 vx = _mm256_fmadd_ps(_mm256_loadu_ps(p.vx + i), damping, accelX);
+        __m256 vy = _mm256_fmadd_ps(_mm256_loadu_ps(p.vy + i), damping, accelY);
+        __m256 x = _mm256_fmadd_ps(vx, dt, _mm256_loadu_ps(p.x + i));
+        __m256 y = _mm256_fmadd_ps(vy, dt, _mm256_loadu_ps(p.y + i));
+
+        for (int k = 0; k < params.planeCount; ++k) {
+            const __m256 nx = _mm256_set1_ps(params.planes[k].nx);
+            const __m256 ny = _mm256_set1_ps(params.planes[k].ny);
+            __m256 dist = _mm256_sub_ps(_mm256_fmadd_ps(nx, x, _mm256_mul_ps(ny, y)), _mm256_set1_ps(params.planes[k].d));
+            __m256 inside = _mm256_cmp_ps(dist, zero, _CMP_LT_OQ);
+            if (_mm256_movemask_ps(inside) == 0) {
+                continue;
+            }
+            dist = _mm256_and_ps(dist, inside);
+            x = _mm256_fnmadd_ps(nx, dist, x);
+            y = _mm256_fnmadd_ps(ny, dist, y);
+            __m256 vn = _mm256_fmadd_ps(vx, nx, _mm256_mul_ps(vy, ny));
+            __m256 approaching = _mm256_and_ps(inside, _mm256_cmp_ps(vn, zero, _CMP_LT_OQ));
+            __m256 bounce = _mm256_and_ps(_mm256_mul_ps(bounceScale, vn), approaching);
+            vx = _mm256_fnmadd_ps(nx, bounce, vx);
+            vy = _mm256_fnmadd_ps(ny, bounce, vy);
+        }
+
+        __m256 age = _mm256_add_ps(_mm256_loadu_ps(p.age + i), dt);
+        __m256 t = _mm256_min_ps(_mm256_mul_ps(age, _mm256_loadu_ps(p.invLifetime + i)), one);
+        __m256i sample = _mm256_cvttps_epi32(_mm256_mul_ps(t, curveScale));
+
+        _mm256_storeu_ps(p.x + i, x);
+        _mm256_storeu_ps(p.y + i, y);
+        _mm256_storeu_ps(p.vx + i, vx);
+        _mm256_storeu_ps(p.vy + i, vy);
+        _mm256_storeu_ps(p.age + i, age);
+        _mm256_storeu_ps(p.size + i, _mm256_i32gather_ps(params.sizeCurve, sample, 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p.color + i), _mm256_i32gather_epi32(colorCurve, sample, 4));
+    }
+
+    // Fewer than 8 left, finish them with the scalar kernel
+    if (i < end) {
+        updateParticlesScalar(p, i, end, params);
+    }
+    return true;
+}
+
+#else
+
+bool updateParticlesAvx2(const ParticleArrays&, size_t, size_t, const ParticleKernelParams&) {
+    return false;
+}
+
+#endif
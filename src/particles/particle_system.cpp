@@ -0,0 +1,255 @@
+#include "particle_system.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Particles per parallel job, large enough to amortise scheduling
+constexpr size_t PARTICLE_JOB_SIZE = 16384;
+
+float randomFloat(uint32_t& state) {
+    // xorshift32, cheap and good enough for visual jitter
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+}
+
+// Linear interpolation between the keys around t, clamped at both ends
+template <typename Key, typename Lerp>
+void sampleCurve(const std::vector<Key>& keys, float t, Lerp lerp) {
+    if (keys.empty()) {
+        return;
+    }
+    if (t <= keys.front().t) {
+        lerp(keys.front(), keys.front(), 0.0f);
+        return;
+    }
+    for (size_t k = 1; k < keys.size(); ++k) {
+        if (t <= keys[k].t) {
+            float span = keys[k].t - keys[k - 1].t;
+            lerp(keys[k - 1], keys[k], (span > 0.0f) ? (t - keys[k - 1].t) / span : 1.0f);
+            return;
+        }
+    }
+    lerp(keys.back(), keys.back(), 0.0f);
+}
+
+uint32_t packColor(float r, float g, float b, float a) {
+    auto channel = [](float v) { return static_cast<uint32_t>(std::min(std::max(v, 0.0f), 255.0f) + 0.5f); };
+    return channel(r) | (channel(g) << 8) | (channel(b) << 16) | (channel(a) << 24);
+}
+
+} // namespace
+
+// ===== ParticlePool =====
+
+ParticlePool::ParticlePool(size_t capacity)
+    : m_capacity(capacity),
+      m_x(capacity), m_y(capacity), m_vx(capacity), m_vy(capacity),
+      m_age(capacity), m_invLifetime(capacity), m_size(capacity), m_color(capacity) {
+}
+
+size_t ParticlePool::spawn(size_t count) {
+    size_t added = std::min(count, m_capacity - m_count);
+    m_count += added;
+    return added;
+}
+
+void ParticlePool::compact() {
+    size_t i = 0;
+    while (i < m_count) {
+        if (m_age[i] * m_invLifetime[i] < 1.0f) {
+            ++i;
+            continue;
+        }
+        // Swap-remove: the last live particle takes this slot and is
+        // checked on the next iteration
+        size_t last = --m_count;
+        m_x[i] = m_x[last];
+        m_y[i] = m_y[last];
+        m_vx[i] = m_vx[last];
+        m_vy[i] = m_vy[last];
+        m_age[i] = m_age[last];
+        m_invLifetime[i] = m_invLifetime[last];
+        m_size[i] = m_size[last];
+        m_color[i] = m_color[last];
+    }
+}
+
+ParticleArrays ParticlePool::getArrays() {
+    return ParticleArrays{ m_x.data(), m_y.data(), m_vx.data(), m_vy.data(),
+                           m_age.data(), m_invLifetime.data(), m_size.data(), m_color.data() };
+}
+
+// ===== ParticleSystem =====
+
+ParticleSystem::ParticleSystem(ThreadPool* pool, size_t threadCount) : m_pool(pool) {
+    if (!m_pool) {
+        m_ownedPool.reset(new ThreadPool(threadCount));
+        m_pool = m_ownedPool.get();
+    }
+}
+
+EmitterId ParticleSystem::addEmitter(const EmitterDesc& desc) {
+    EmitterId id = static_cast<EmitterId>(m_emitters.size());
+    m_emitters.emplace_back(new Emitter(desc));
+    Emitter& emitter = *m_emitters.back();
+    emitter.rngState = 0x9E3779B9u ^ (id * 0x85EBCA6Bu);
+    if (emitter.rngState == 0) {
+        emitter.rngState = 1;
+    }
+
+    // Bake the curves once so the kernels only do a table lookup
+    for (int s = 0; s < PARTICLE_CURVE_SAMPLES; ++s) {
+        float t = static_cast<float>(s) / static_cast<float>(PARTICLE_CURVE_SAMPLES - 1);
+        float& size = emitter.sizeCurve[s];
+        size = 0.0f;
+        sampleCurve(desc.sizeCurve, t, [&size](const ParticleSizeKey& a, const ParticleSizeKey& b, float f) {
+            size = a.size + (b.size - a.size) * f;
+        });
+        uint32_t& color = emitter.colorCurve[s];
+        color = 0xFFFFFFFFu;
+        sampleCurve(desc.colorCurve, t, [&color](const ParticleColorKey& a, const ParticleColorKey& b, float f) {
+            color = packColor(a.r + (b.r - a.r) * f, a.g + (b.g - a.g) * f,
+                              a.b + (b.b - a.b) * f, a.a + (b.a - a.a) * f);
+        });
+    }
+
+    ParticleKernelParams& params = emitter.params;
+    params.accelX = desc.accelX;
+    params.accelY = desc.accelY;
+    params.restitution = desc.restitution;
+    params.planeCount = static_cast<int>(std::min<size_t>(desc.planes.size(), MAX_PARTICLE_PLANES));
+    for (int k = 0; k < params.planeCount; ++k) {
+        params.planes[k] = desc.planes[k];
+    }
+    params.sizeCurve = emitter.sizeCurve;
+    params.colorCurve = emitter.colorCurve;
+    return id;
+}
+
+void ParticleSystem::setEmitterPosition(EmitterId id, float x, float y) {
+    m_emitters[id]->desc.x = x;
+    m_emitters[id]->desc.y = y;
+}
+
+void ParticleSystem::setEmitterRate(EmitterId id, float rate) {
+    m_emitters[id]->desc.rate = rate;
+}
+
+void ParticleSystem::burst(EmitterId id, size_t count) {
+    m_emitters[id]->pendingBurst += count;
+}
+
+size_t ParticleSystem::getLiveCount() const {
+    size_t count = 0;
+    for (const std::unique_ptr<Emitter>& emitter : m_emitters) {
+        count += emitter->pool.getCount();
+    }
+    return count;
+}
+
+void ParticleSystem::spawnParticles(Emitter& emitter, float dt) {
+    const EmitterDesc& desc = emitter.desc;
+    emitter.spawnAccumulator += desc.rate * dt;
+    size_t wanted = static_cast<size_t>(emitter.spawnAccumulator);
+    emitter.spawnAccumulator -= static_cast<float>(wanted);
+    wanted += emitter.pendingBurst;
+    emitter.pendingBurst = 0;
+
+    size_t first = emitter.pool.getCount();
+    size_t added = emitter.pool.spawn(wanted);
+    ParticleArrays p = emitter.pool.getArrays();
+    for (size_t i = first; i < first + added; ++i) {
+        float angle = desc.direction + desc.spread * (2.0f * randomFloat(emitter.rngState) - 1.0f);
+        float speed = desc.speedMin + (desc.speedMax - desc.speedMin) * randomFloat(emitter.rngState);
+        float lifetime = desc.lifetimeMin + (desc.lifetimeMax - desc.lifetimeMin) * randomFloat(emitter.rngState);
+        p.x[i] = desc.x;
+        p.y[i] = desc.y;
+        p.vx[i] = std::cos(angle) * speed;
+        p.vy[i] = std::sin(angle) * speed;
+        p.age[i] = 0.0f;
+        p.invLifetime[i] = 1.0f / std::max(lifetime, 1e-4f);
+        p.size[i] = emitter.sizeCurve[0];
+        p.color[i] = emitter.colorCurve[0];
+    }
+}
+
+void ParticleSystem::buildJobs() {
+    m_jobs.clear();
+    for (uint32_t e = 0; e < m_emitters.size(); ++e) {
+        size_t count = m_emitters[e]->pool.getCount();
+        for (size_t begin = 0; begin < count; begin += PARTICLE_JOB_SIZE) {
+            m_jobs.push_back(Job{e, begin, std::min(begin + PARTICLE_JOB_SIZE, count)});
+        }
+    }
+}
+
+void ParticleSystem::update(float dt) {
+    if (dt <= 0.0f || m_emitters.empty()) {
+        return;
+    }
+
+    m_pool->parallelFor(m_emitters.size(), 1, [this, dt](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            Emitter& emitter = *m_emitters[e];
+            emitter.params.dt = dt;
+            emitter.params.damping = std::max(0.0f, 1.0f - emitter.desc.drag * dt);
+            spawnParticles(emitter, dt);
+        }
+    });
+
+    // Big emitters are split so one huge effect still uses every core
+    buildJobs();
+    m_pool->parallelFor(m_jobs.size(), 1, [this](size_t begin, size_t end) {
+        for (size_t j = begin; j < end; ++j) {
+            const Job& job = m_jobs[j];
+            Emitter& emitter = *m_emitters[job.emitter];
+            updateParticles(emitter.pool.getArrays(), job.begin, job.end, emitter.params);
+        }
+    });
+
+    m_pool->parallelFor(m_emitters.size(), 1, [this](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            m_emitters[e]->pool.compact();
+        }
+    });
+}
+
+void ParticleSystem::writeVertices(VertexBatch& batch) {
+    // Reserve first, the batch storage must not move while workers write
+    m_firstQuad.resize(m_emitters.size());
+    for (size_t e = 0; e < m_emitters.size(); ++e) {
+        const Emitter& emitter = *m_emitters[e];
+        m_firstQuad[e] = batch.reserveQuads(emitter.desc.texture, emitter.pool.getCount());
+    }
+
+    buildJobs();
+    m_pool->parallelFor(m_jobs.size(), 1, [this, &batch](size_t begin, size_t end) {
+        const float toFloat = 1.0f / 255.0f;
+        for (size_t j = begin; j < end; ++j) {
+            const Job& job = m_jobs[j];
+            Emitter& emitter = *m_emitters[job.emitter];
+            ParticleArrays p = emitter.pool.getArrays();
+            SDL_Vertex* v = batch.getQuadVertices(m_firstQuad[job.emitter] + job.begin);
+            for (size_t i = job.begin; i < job.end; ++i, v += 4) {
+                float half = 0.5f * p.size[i];
+                float left = p.x[i] - half;
+                float right = p.x[i] + half;
+                float top = p.y[i] - half;
+                float bottom = p.y[i] + half;
+                uint32_t c = p.color[i];
+                SDL_FColor color = { static_cast<float>(c & 0xFF) * toFloat,
+                                     static_cast<float>((c >> 8) & 0xFF) * toFloat,
+                                     static_cast<float>((c >> 16) & 0xFF) * toFloat,
+                                     static_cast<float>(c >> 24) * toFloat };
+                v[0] = SDL_Vertex{ {left, top}, color, {0.0f, 0.0f} };
+                v[1] = SDL_Vertex{ {right, top}, color, {1.0f, 0.0f} };
+                v[2] = SDL_Vertex{ {right, bottom}, color, {1.0f, 1.0f} };
+                v[3] = SDL_Vertex{ {left, bottom}, color, {0.0f, 1.0f} };
+            }
+        }
+    });
+}
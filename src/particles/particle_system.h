@@ -0,0 +1,132 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include "particle_kernels.h"
+#include "../core/thread_pool.h"
+#include "../renderer/vertex_batch.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Point on a colour-over-life curve, t runs from 0 (birth) to 1 (death)
+struct ParticleColorKey {
+    float t;
+    uint8_t r, g, b, a;
+};
+
+struct ParticleSizeKey {
+    float t;
+    float size;
+};
+
+// Everything about an emitter that does not change per frame. Positions
+// and speeds are in screen pixels, angles in radians.
+struct EmitterDesc {
+    float x = 0.0f;
+    float y = 0.0f;
+    float rate = 100.0f; // Particles per second
+    size_t capacity = 10000;
+    float lifetimeMin = 1.0f;
+    float lifetimeMax = 2.0f;
+    float speedMin = 50.0f;
+    float speedMax = 100.0f;
+    float direction = -1.5707963f; // Straight up on screen
+    float spread = 0.5f;           // Half-angle of the emission cone
+    float accelX = 0.0f;
+    float accelY = 0.0f;
+    float drag = 0.0f;
+    float restitution = 0.5f;
+    std::vector<ParticlePlane> planes; // At most MAX_PARTICLE_PLANES are used
+    std::vector<ParticleSizeKey> sizeCurve = { {0.0f, 4.0f}, {1.0f, 4.0f} };
+    std::vector<ParticleColorKey> colorCurve = { {0.0f, 255, 255, 255, 255}, {1.0f, 255, 255, 255, 0} };
+    SDL_Texture* texture = nullptr;
+};
+
+// Fixed-capacity structure-of-arrays particle storage. Dead particles are
+// removed by moving the last live particle into their slot.
+class ParticlePool {
+public:
+    explicit ParticlePool(size_t capacity);
+
+    // Grows the live range by up to count particles (less if full) and
+    // returns how many were added; they start at index getCount() - added
+    size_t spawn(size_t count);
+    // Removes every particle that has reached the end of its life
+    void compact();
+
+    ParticleArrays getArrays();
+    size_t getCount() const { return m_count; }
+    size_t getCapacity() const { return m_capacity; }
+
+private:
+    size_t m_capacity;
+    size_t m_count = 0;
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_vx;
+    std::vector<float> m_vy;
+    std::vector<float> m_age;
+    std::vector<float> m_invLifetime;
+    std::vector<float> m_size;
+    std::vector<uint32_t> m_color;
+};
+
+using EmitterId = uint32_t;
+
+// Owns all emitters. update() spawns, simulates and compacts every emitter
+// in parallel; writeVertices() turns live particles into quads in a
+// VertexBatch so a whole effect layer costs one draw call per texture.
+class ParticleSystem {
+public:
+    // pool may be shared with other systems; without one the system creates
+    // its own with threadCount threads (0 for one per hardware thread)
+    explicit ParticleSystem(ThreadPool* pool = nullptr, size_t threadCount = 0);
+
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    EmitterId addEmitter(const EmitterDesc& desc);
+    void setEmitterPosition(EmitterId id, float x, float y);
+    void setEmitterRate(EmitterId id, float rate);
+    // Spawns count particles at once on the next update
+    void burst(EmitterId id, size_t count);
+
+    void update(float dt);
+    void writeVertices(VertexBatch& batch);
+
+    size_t getEmitterCount() const { return m_emitters.size(); }
+    size_t getLiveCount() const;
+
+private:
+    struct Emitter {
+        EmitterDesc desc;
+        ParticlePool pool;
+        ParticleKernelParams params;
+        float sizeCurve[PARTICLE_CURVE_SAMPLES];
+        uint32_t colorCurve[PARTICLE_CURVE_SAMPLES];
+        float spawnAccumulator = 0.0f;
+        size_t pendingBurst = 0;
+        uint32_t rngState = 1;
+
+        explicit Emitter(const EmitterDesc& d) : desc(d), pool(d.capacity) {}
+    };
+
+    // A slice of one emitter's pool, the unit of parallel work
+    struct Job {
+        uint32_t emitter;
+        size_t begin;
+        size_t end;
+    };
+
+    void spawnParticles(Emitter& emitter, float dt);
+    void buildJobs();
+
+    std::unique_ptr<ThreadPool> m_ownedPool;
+    ThreadPool* m_pool;
+    std::vector<std::unique_ptr<Emitter>> m_emitters;
+    std::vector<Job> m_jobs;
+    std::vector<size_t> m_firstQuad;
+};
+
+#endif // PARTICLE_SYSTEM_H
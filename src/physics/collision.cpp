@@ -0,0 +1,308 @@
+#include "collision.h"
+
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PHYSICS_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+void buildWorldShape(const Shape& shape, const Vec2& position, const Rot& rotation, WorldShape& out) {
+    out.type = shape.type;
+    out.count = shape.count;
+    out.radius = shape.radius;
+    out.center = position;
+    if (shape.type != ShapeType::Polygon) {
+        return;
+    }
+    for (int i = 0; i < shape.count; ++i) {
+        Vec2 v = position + rotate(rotation, shape.vertices[i]);
+        Vec2 n = rotate(rotation, shape.normals[i]);
+        out.vx[i] = v.x;
+        out.vy[i] = v.y;
+        out.nx[i] = n.x;
+        out.ny[i] = n.y;
+    }
+    // Pad with the last vertex so a min over all lanes ignores the padding
+    for (int i = shape.count; i < MAX_POLYGON_VERTICES; ++i) {
+        out.vx[i] = out.vx[shape.count - 1];
+        out.vy[i] = out.vy[shape.count - 1];
+        out.nx[i] = out.nx[shape.count - 1];
+        out.ny[i] = out.ny[shape.count - 1];
+    }
+}
+
+// ===== Circles =====
+
+static void writeCircleManifold(float nx, float ny, float separation, float px, float py, Manifold& out) {
+    out.normal = Vec2(nx, ny);
+    out.points[0].point = Vec2(px, py);
+    out.points[0].separation = separation;
+    out.points[0].id = 0;
+    out.pointCount = 1;
+}
+
+static void collideCirclePair(float ax, float ay, float ar, float bx, float by, float br, Manifold& out) {
+    float dx = bx - ax;
+    float dy = by - ay;
+    float distSq = dx * dx + dy * dy;
+    float reach = ar + br + CONTACT_MARGIN;
+    out.pointCount = 0;
+    if (distSq > reach * reach) {
+        return;
+    }
+    float dist = std::sqrt(distSq);
+    float nx = 0.0f;
+    float ny = 1.0f;
+    if (dist > FLT_EPSILON) {
+        nx = dx / dist;
+        ny = dy / dist;
+    }
+    float separation = dist - ar - br;
+    float offset = ar + 0.5f * separation;
+    writeCircleManifold(nx, ny, separation, ax + nx * offset, ay + ny * offset, out);
+}
+
+void collideCircleBatch(const CirclePairBatch& batch, Manifold* out) {
+    size_t i = 0;
+#ifdef PHYSICS_USE_SSE2
+    const __m128 margin = _mm_set1_ps(CONTACT_MARGIN);
+    const __m128 epsilon = _mm_set1_ps(FLT_EPSILON);
+    const __m128 half = _mm_set1_ps(0.5f);
+    alignas(16) float nx[4], ny[4], sep[4], px[4], py[4];
+    for (; i + 4 <= batch.count; i += 4) {
+        __m128 ax = _mm_loadu_ps(batch.ax + i);
+        __m128 ay = _mm_loadu_ps(batch.ay + i);
+        __m128 ar = _mm_loadu_ps(batch.ar + i);
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(batch.bx + i), ax);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(batch.by + i), ay);
+        __m128 radii = _mm_add_ps(ar, _mm_loadu_ps(batch.br + i));
+        __m128 distSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        __m128 reach = _mm_add_ps(radii, margin);
+        int hitMask = _mm_movemask_ps(_mm_cmple_ps(distSq, _mm_mul_ps(reach, reach)));
+        if (hitMask == 0) {
+            out[i].pointCount = 0;
+            out[i + 1].pointCount = 0;
+            out[i + 2].pointCount = 0;
+            out[i + 3].pointCount = 0;
+            continue;
+        }
+
+        __m128 dist = _mm_sqrt_ps(distSq);
+        __m128 valid = _mm_cmpgt_ps(dist, epsilon);
+        // Coincident centres get a zero normal here and are patched below
+        __m128 invDist = _mm_and_ps(valid, _mm_div_ps(_mm_set1_ps(1.0f), _mm_max_ps(dist, epsilon)));
+        __m128 normalX = _mm_mul_ps(dx, invDist);
+        __m128 normalY = _mm_mul_ps(dy, invDist);
+        __m128 separation = _mm_sub_ps(dist, radii);
+        __m128 offset = _mm_add_ps(ar, _mm_mul_ps(half, separation));
+        _mm_store_ps(nx, normalX);
+        _mm_store_ps(ny, normalY);
+        _mm_store_ps(sep, separation);
+        _mm_store_ps(px, _mm_add_ps(ax, _mm_mul_ps(normalX, offset)));
+        _mm_store_ps(py, _mm_add_ps(ay, _mm_mul_ps(normalY, offset)));
+
+        int validMask = _mm_movemask_ps(valid);
+        for (int lane = 0; lane < 4; ++lane) {
+            Manifold& m = out[i + lane];
+            if ((hitMask & (1 << lane)) == 0) {
+                m.pointCount = 0;
+            } else if ((validMask & (1 << lane)) == 0) {
+                collideCirclePair(batch.ax[i + lane], batch.ay[i + lane], batch.ar[i + lane],
+                                  batch.bx[i + lane], batch.by[i + lane], batch.br[i + lane], m);
+            } else {
+                writeCircleManifold(nx[lane], ny[lane], sep[lane], px[lane], py[lane], m);
+            }
+        }
+    }
+#endif
+    // Scalar tail, or the whole batch without SSE2
+    for (; i < batch.count; ++i) {
+        collideCirclePair(batch.ax[i], batch.ay[i], batch.ar[i], batch.bx[i], batch.by[i], batch.br[i], out[i]);
+    }
+}
+
+// ===== Polygons =====
+
+void collidePolygonCircle(const WorldShape& polygon, const WorldShape& circle, Manifold& out) {
+    out.pointCount = 0;
+    const Vec2 c = circle.center;
+    const float reach = circle.radius + CONTACT_MARGIN;
+
+    // Face of greatest separation
+    int normalIndex = 0;
+    float separation = -FLT_MAX;
+    for (int i = 0; i < polygon.count; ++i) {
+        float s = polygon.nx[i] * (c.x - polygon.vx[i]) + polygon.ny[i] * (c.y - polygon.vy[i]);
+        if (s > reach) {
+            return;
+        }
+        if (s > separation) {
+            separation = s;
+            normalIndex = i;
+        }
+    }
+
+    int next = (normalIndex + 1 < polygon.count) ? normalIndex + 1 : 0;
+    Vec2 v1(polygon.vx[normalIndex], polygon.vy[normalIndex]);
+    Vec2 v2(polygon.vx[next], polygon.vy[next]);
+    Vec2 faceNormal(polygon.nx[normalIndex], polygon.ny[normalIndex]);
+
+    Vec2 normal = faceNormal;
+    Vec2 surfacePoint;
+    float distance = 0.0f;
+    if (separation > FLT_EPSILON && dot(c - v1, v2 - v1) <= 0.0f) {
+        // Vertex region of v1
+        Vec2 d = c - v1;
+        if (d.lengthSquared() > reach * reach) {
+            return;
+        }
+        distance = d.length();
+        normal = normalize(d);
+        surfacePoint = v1;
+    } else if (separation > FLT_EPSILON && dot(c - v2, v1 - v2) <= 0.0f) {
+        // Vertex region of v2
+        Vec2 d = c - v2;
+        if (d.lengthSquared() > reach * reach) {
+            return;
+        }
+        distance = d.length();
+        normal = normalize(d);
+        surfacePoint = v2;
+    } else {
+        // Face region, also used when the centre is inside the polygon
+        distance = separation;
+        surfacePoint = c - faceNormal * separation;
+    }
+
+    float contactSeparation = distance - circle.radius;
+    out.normal = normal;
+    out.points[0].point = surfacePoint + normal * (0.5f * contactSeparation);
+    out.points[0].separation = contactSeparation;
+    out.points[0].id = 0;
+    out.pointCount = 1;
+}
+
+// Largest separation of b along the face normals of a
+static float findMaxSeparation(const WorldShape& a, const WorldShape& b, int& edgeIndex) {
+    float best = -FLT_MAX;
+    edgeIndex = 0;
+    for (int i = 0; i < a.count; ++i) {
+        const float nx = a.nx[i];
+        const float ny = a.ny[i];
+        const float offset = nx * a.vx[i] + ny * a.vy[i];
+#ifdef PHYSICS_USE_SSE2
+        const __m128 nxv = _mm_set1_ps(nx);
+        const __m128 nyv = _mm_set1_ps(ny);
+        __m128 lo = _mm_add_ps(_mm_mul_ps(nxv, _mm_load_ps(b.vx)), _mm_mul_ps(nyv, _mm_load_ps(b.vy)));
+        if (b.count > 4) {
+            __m128 hi = _mm_add_ps(_mm_mul_ps(nxv, _mm_load_ps(b.vx + 4)), _mm_mul_ps(nyv, _mm_load_ps(b.vy + 4)));
+            lo = _mm_min_ps(lo, hi);
+        }
+        lo = _mm_min_ps(lo, _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(1, 0, 3, 2)));
+        lo = _mm_min_ps(lo, _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(2, 3, 0, 1)));
+        float s = _mm_cvtss_f32(lo) - offset;
+#else
+        float minProjection = FLT_MAX;
+        for (int j = 0; j < b.count; ++j) {
+            float p = nx * b.vx[j] + ny * b.vy[j];
+            minProjection = (p < minProjection) ? p : minProjection;
+        }
+        float s = minProjection - offset;
+#endif
+        if (s > best) {
+            best = s;
+            edgeIndex = i;
+        }
+    }
+    return best;
+}
+
+// Clips a segment to the negative side of the plane dot(n, p) = offset.
+// End points keep their slots so feature ids stay stable while clipping.
+static bool clipSegmentToLine(Vec2 segment[2], const Vec2& n, float offset) {
+    float d0 = dot(n, segment[0]) - offset;
+    float d1 = dot(n, segment[1]) - offset;
+    if (d0 > 0.0f && d1 > 0.0f) {
+        return false;
+    }
+    if (d0 > 0.0f || d1 > 0.0f) {
+        Vec2 intersection = segment[0] + (segment[1] - segment[0]) * (d0 / (d0 - d1));
+        segment[(d0 > 0.0f) ? 0 : 1] = intersection;
+    }
+    return true;
+}
+
+void collidePolygons(const WorldShape& a, const WorldShape& b, Manifold& out) {
+    out.pointCount = 0;
+
+    int edgeA = 0;
+    float separationA = findMaxSeparation(a, b, edgeA);
+    if (separationA > CONTACT_MARGIN) {
+        return;
+    }
+    int edgeB = 0;
+    float separationB = findMaxSeparation(b, a, edgeB);
+    if (separationB > CONTACT_MARGIN) {
+        return;
+    }
+
+    // Prefer A as the reference face unless B is clearly better, which keeps
+    // the choice stable while stacking
+    const WorldShape* reference = &a;
+    const WorldShape* incident = &b;
+    int referenceEdge = edgeA;
+    bool flip = false;
+    const float tolerance = 0.1f * 0.005f;
+    if (separationB > separationA + tolerance) {
+        reference = &b;
+        incident = &a;
+        referenceEdge = edgeB;
+        flip = true;
+    }
+
+    Vec2 referenceNormal(reference->nx[referenceEdge], reference->ny[referenceEdge]);
+
+    // Incident edge is the one most anti-parallel to the reference normal
+    int incidentEdge = 0;
+    float minDot = FLT_MAX;
+    for (int i = 0; i < incident->count; ++i) {
+        float d = referenceNormal.x * incident->nx[i] + referenceNormal.y * incident->ny[i];
+        if (d < minDot) {
+            minDot = d;
+            incidentEdge = i;
+        }
+    }
+    int incidentNext = (incidentEdge + 1 < incident->count) ? incidentEdge + 1 : 0;
+    Vec2 segment[2] = {
+        Vec2(incident->vx[incidentEdge], incident->vy[incidentEdge]),
+        Vec2(incident->vx[incidentNext], incident->vy[incidentNext])
+    };
+
+    int referenceNext = (referenceEdge + 1 < reference->count) ? referenceEdge + 1 : 0;
+    Vec2 v11(reference->vx[referenceEdge], reference->vy[referenceEdge]);
+    Vec2 v12(reference->vx[referenceNext], reference->vy[referenceNext]);
+    Vec2 tangent = normalize(v12 - v11);
+
+    // Clip the incident edge against the side planes of the reference edge
+    if (!clipSegmentToLine(segment, -tangent, -dot(tangent, v11)) ||
+        !clipSegmentToLine(segment, tangent, dot(tangent, v12))) {
+        return;
+    }
+
+    float frontOffset = dot(referenceNormal, v11);
+    out.normal = flip ? -referenceNormal : referenceNormal;
+    for (int i = 0; i < 2; ++i) {
+        float separation = dot(referenceNormal, segment[i]) - frontOffset;
+        if (separation > CONTACT_MARGIN) {
+            continue;
+        }
+        ManifoldPoint& mp = out.points[out.pointCount++];
+        mp.point = segment[i] - referenceNormal * (0.5f * separation);
+        mp.separation = separation;
+        // Reference face, incident edge and end point identify the feature
+        mp.id = (flip ? 0x10000u : 0u) | (static_cast<uint32_t>(referenceEdge) << 8) |
+                (static_cast<uint32_t>(incidentEdge) << 1) | static_cast<uint32_t>(i);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "shape.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Shapes closer than this are reported as speculative contacts so the solver
+// can stop them before they overlap
+constexpr float CONTACT_MARGIN = 0.02f;
+
+struct ManifoldPoint {
+    Vec2 point;        // World space, halfway between the two surfaces
+    float separation;  // Negative when overlapping
+    uint32_t id;       // Feature key used to match points across steps
+};
+
+// Contact between two shapes. The normal points from shape A to shape B.
+struct Manifold {
+    Vec2 normal;
+    ManifoldPoint points[2];
+    int pointCount = 0;
+};
+
+// Shape transformed into world space. Polygon data is kept as padded
+// structure-of-arrays so separating-axis tests can run four vertices per lane.
+struct WorldShape {
+    ShapeType type = ShapeType::Circle;
+    int count = 0;
+    float radius = 0.0f;
+    Vec2 center;
+    alignas(16) float vx[MAX_POLYGON_VERTICES];
+    alignas(16) float vy[MAX_POLYGON_VERTICES];
+    alignas(16) float nx[MAX_POLYGON_VERTICES];
+    alignas(16) float ny[MAX_POLYGON_VERTICES];
+};
+
+void buildWorldShape(const Shape& shape, const Vec2& position, const Rot& rotation, WorldShape& out);
+
+// Circle pairs in structure-of-arrays form, processed four at a time
+struct CirclePairBatch {
+    size_t count = 0;
+    const float* ax = nullptr;
+    const float* ay = nullptr;
+    const float* ar = nullptr;
+    const float* bx = nullptr;
+    const float* by = nullptr;
+    const float* br = nullptr;
+};
+
+// Writes one manifold per pair into out (pointCount 0 when apart)
+void collideCircleBatch(const CirclePairBatch& batch, Manifold* out);
+void collidePolygonCircle(const WorldShape& polygon, const WorldShape& circle, Manifold& out);
+void collidePolygons(const WorldShape& a, const WorldShape& b, Manifold& out);
+
+#endif // COLLISION_H
@@ -0,0 +1,60 @@
+#ifndef MATH2D_H
+#define MATH2D_H
+
+#include <cmath>
+
+// Small 2D vector used by the physics module
+struct Vec2 {
+    float x = 0.0f;
+    float y = 0.0f;
+
+    Vec2() = default;
+    Vec2(float px, float py) : x(px), y(py) {}
+
+    Vec2 operator+(const Vec2& o) const { return Vec2(x + o.x, y + o.y); }
+    Vec2 operator-(const Vec2& o) const { return Vec2(x - o.x, y - o.y); }
+    Vec2 operator-() const { return Vec2(-x, -y); }
+    Vec2 operator*(float s) const { return Vec2(x * s, y * s); }
+    Vec2& operator+=(const Vec2& o) { x += o.x; y += o.y; return *this; }
+    Vec2& operator-=(const Vec2& o) { x -= o.x; y -= o.y; return *this; }
+    Vec2& operator*=(float s) { x *= s; y *= s; return *this; }
+
+    float lengthSquared() const { return x * x + y * y; }
+    float length() const { return std::sqrt(lengthSquared()); }
+};
+
+inline Vec2 operator*(float s, const Vec2& v) { return Vec2(v.x * s, v.y * s); }
+inline float dot(const Vec2& a, const Vec2& b) { return a.x * b.x + a.y * b.y; }
+inline float cross(const Vec2& a, const Vec2& b) { return a.x * b.y - a.y * b.x; }
+// Cross of a scalar (angular velocity) with a vector
+inline Vec2 cross(float s, const Vec2& v) { return Vec2(-s * v.y, s * v.x); }
+// Cross of a vector with a scalar
+inline Vec2 cross(const Vec2& v, float s) { return Vec2(s * v.y, -s * v.x); }
+
+inline Vec2 normalize(const Vec2& v) {
+    float len = v.length();
+    return (len > 1e-12f) ? v * (1.0f / len) : Vec2(0.0f, 0.0f);
+}
+
+// Rotation stored as sine/cosine so it is only evaluated once per step
+struct Rot {
+    float s = 0.0f;
+    float c = 1.0f;
+
+    Rot() = default;
+    explicit Rot(float angle) : s(std::sin(angle)), c(std::cos(angle)) {}
+};
+
+inline Vec2 rotate(const Rot& q, const Vec2& v) { return Vec2(q.c * v.x - q.s * v.y, q.s * v.x + q.c * v.y); }
+inline Vec2 rotateInv(const Rot& q, const Vec2& v) { return Vec2(q.c * v.x + q.s * v.y, -q.s * v.x + q.c * v.y); }
+
+struct AABB {
+    Vec2 min;
+    Vec2 max;
+
+    bool overlaps(const AABB& o) const {
+        return min.x <= o.max.x && o.min.x <= max.x && min.y <= o.max.y && o.min.y <= max.y;
+    }
+};
+
+#endif // MATH2D_H
@@ -0,0 +1,636 @@
+#include "physics_world.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Items handed to a worker at once in the parallel phases
+constexpr size_t BROADPHASE_GRAIN = 1024;
+constexpr size_t NARROWPHASE_GRAIN = 256;
+constexpr size_t ISLAND_GRAIN = 16;
+
+// Allowed penetration and Baumgarte factor for position correction
+constexpr float LINEAR_SLOP = 0.005f;
+constexpr float BAUMGARTE = 0.2f;
+constexpr float MAX_CORRECTION_SPEED = 4.0f;
+// Approach speed below which restitution is ignored, stops jitter at rest
+constexpr float RESTITUTION_THRESHOLD = 1.0f;
+
+const uint32_t NO_ISLAND = 0xFFFFFFFFu;
+
+uint64_t makePairKey(BodyId a, BodyId b) {
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+size_t hashCell(int32_t x, int32_t y, size_t bucketCount) {
+    uint32_t h = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u;
+    return h & (bucketCount - 1);
+}
+
+const Contact* findContact(const std::vector<Contact>& contacts, uint64_t key) {
+    auto it = std::lower_bound(contacts.begin(), contacts.end(), key,
+                               [](const Contact& c, uint64_t k) { return c.key < k; });
+    return (it != contacts.end() && it->key == key) ? &*it : nullptr;
+}
+
+struct ContactConstraint {
+    uint32_t indexA;
+    uint32_t indexB;
+    float invMassA;
+    float invMassB;
+    float invIA;
+    float invIB;
+    Vec2 normal;
+    Vec2 rA[2];
+    Vec2 rB[2];
+    float normalMass[2];
+    float tangentMass[2];
+    float bias[2];
+};
+
+} // namespace
+
+// Per-thread buffers reused across the islands a worker picks up
+struct PhysicsWorld::SolverScratch {
+    std::vector<Vec2> velocities;
+    std::vector<float> angularVelocities;
+    std::vector<ContactConstraint> constraints;
+};
+
+PhysicsWorld::PhysicsWorld(const WorldSettings& settings, ThreadPool* pool)
+    : m_settings(settings), m_pool(pool) {
+    if (!m_pool) {
+        m_ownedPool.reset(new ThreadPool(std::max<size_t>(1, settings.threadCount)));
+        m_pool = m_ownedPool.get();
+    }
+}
+
+BodyId PhysicsWorld::createBody(const BodyDef& def) {
+    Body body;
+    body.position = def.position;
+    body.angle = def.angle;
+    body.rotation = Rot(def.angle);
+    body.friction = def.friction;
+    body.restitution = def.restitution;
+    body.type = def.type;
+    body.shape = def.shape;
+    if (def.type == BodyType::Dynamic) {
+        MassData mass = computeMass(def.shape, def.density);
+        body.invMass = (mass.mass > 0.0f) ? 1.0f / mass.mass : 1.0f;
+        body.invInertia = (mass.inertia > 0.0f) ? 1.0f / mass.inertia : 0.0f;
+        body.linearVelocity = def.linearVelocity;
+        body.angularVelocity = def.angularVelocity;
+        body.awake = true;
+    } else {
+        body.awake = false;
+    }
+
+    BodyId id = static_cast<BodyId>(m_bodies.size());
+    m_bodies.push_back(body);
+    m_aabbs.push_back(computeAABB(body.shape, body.position, body.rotation));
+    m_worldShapes.emplace_back();
+    buildWorldShape(body.shape, body.position, body.rotation, m_worldShapes.back());
+    return id;
+}
+
+void PhysicsWorld::setLinearVelocity(BodyId id, const Vec2& velocity) {
+    Body& body = m_bodies[id];
+    if (body.type != BodyType::Dynamic) {
+        return;
+    }
+    body.linearVelocity = velocity;
+    wakeBody(id);
+}
+
+void PhysicsWorld::applyLinearImpulse(BodyId id, const Vec2& impulse) {
+    Body& body = m_bodies[id];
+    if (body.type != BodyType::Dynamic) {
+        return;
+    }
+    body.linearVelocity += impulse * body.invMass;
+    wakeBody(id);
+}
+
+void PhysicsWorld::wakeBody(BodyId id) {
+    Body& body = m_bodies[id];
+    if (body.type == BodyType::Dynamic) {
+        body.awake = true;
+        body.sleepTime = 0.0f;
+    }
+}
+
+size_t PhysicsWorld::getAwakeBodyCount() const {
+    size_t count = 0;
+    for (const Body& body : m_bodies) {
+        count += isActive(body) ? 1 : 0;
+    }
+    return count;
+}
+
+void PhysicsWorld::step(float dt) {
+    if (dt <= 0.0f || m_bodies.empty()) {
+        return;
+    }
+    updateBroadphase();
+    findPairs();
+    collidePairs();
+    buildIslands();
+    solveIslands(dt);
+}
+
+// ===== Broadphase =====
+
+void PhysicsWorld::updateBroadphase() {
+    // Sleeping and static bodies have not moved since their bounds were built
+    m_pool->parallelFor(m_bodies.size(), BROADPHASE_GRAIN, [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Body& body = m_bodies[i];
+            if (isActive(body)) {
+                m_aabbs[i] = computeAABB(body.shape, body.position, body.rotation);
+                buildWorldShape(body.shape, body.position, body.rotation, m_worldShapes[i]);
+            }
+        }
+    });
+
+    // Hash every cell a body touches into a bucket, then counting-sort the
+    // entries by bucket. Entries keep body order inside a bucket so the pair
+    // list comes out the same on every run.
+    const float invCellSize = 1.0f / m_settings.cellSize;
+    m_gridEntries.clear();
+    for (size_t i = 0; i < m_bodies.size(); ++i) {
+        const AABB& box = m_aabbs[i];
+        const bool isStatic = m_bodies[i].type == BodyType::Static;
+        int32_t x0 = static_cast<int32_t>(std::floor(box.min.x * invCellSize));
+        int32_t y0 = static_cast<int32_t>(std::floor(box.min.y * invCellSize));
+        int32_t x1 = static_cast<int32_t>(std::floor(box.max.x * invCellSize));
+        int32_t y1 = static_cast<int32_t>(std::floor(box.max.y * invCellSize));
+        for (int32_t y = y0; y <= y1; ++y) {
+            for (int32_t x = x0; x <= x1; ++x) {
+                m_gridEntries.push_back(GridEntry{x, y, static_cast<BodyId>(i), isStatic});
+            }
+        }
+    }
+
+    size_t bucketCount = 1024;
+    while (bucketCount < 2 * m_gridEntries.size()) {
+        bucketCount *= 2;
+    }
+    m_bucketStart.assign(bucketCount + 1, 0);
+    for (const GridEntry& entry : m_gridEntries) {
+        ++m_bucketStart[hashCell(entry.cellX, entry.cellY, bucketCount) + 1];
+    }
+    for (size_t i = 0; i < bucketCount; ++i) {
+        m_bucketStart[i + 1] += m_bucketStart[i];
+    }
+    m_bucketEntries.resize(m_gridEntries.size());
+    m_bucketCursor.assign(m_bucketStart.begin(), m_bucketStart.end() - 1);
+    for (const GridEntry& entry : m_gridEntries) {
+        m_bucketEntries[m_bucketCursor[hashCell(entry.cellX, entry.cellY, bucketCount)]++] = entry;
+    }
+}
+
+void PhysicsWorld::findPairs() {
+    const size_t bucketCount = m_bucketStart.size() - 1;
+    const size_t chunkCount = (bucketCount + BROADPHASE_GRAIN - 1) / BROADPHASE_GRAIN;
+    m_chunkPairs.resize(chunkCount);
+    for (std::vector<Pair>& pairs : m_chunkPairs) {
+        pairs.clear();
+    }
+
+    // Chunks are concatenated in bucket order afterwards, so the result does
+    // not depend on which thread handled which chunk
+    const float invCellSize = 1.0f / m_settings.cellSize;
+    m_pool->parallelFor(bucketCount, BROADPHASE_GRAIN, [this, invCellSize](size_t begin, size_t end) {
+        std::vector<Pair>& pairs = m_chunkPairs[begin / BROADPHASE_GRAIN];
+        for (size_t bucket = begin; bucket < end; ++bucket) {
+            const uint32_t first = m_bucketStart[bucket];
+            const uint32_t last = m_bucketStart[bucket + 1];
+            for (uint32_t i = first; i < last; ++i) {
+                const GridEntry& entryA = m_bucketEntries[i];
+                const AABB& boxA = m_aabbs[entryA.body];
+                for (uint32_t j = i + 1; j < last; ++j) {
+                    const GridEntry& entryB = m_bucketEntries[j];
+                    // Different cells can hash to the same bucket
+                    if (entryA.cellX != entryB.cellX || entryA.cellY != entryB.cellY) {
+                        continue;
+                    }
+                    if (entryA.isStatic && entryB.isStatic) {
+                        continue;
+                    }
+                    const AABB& boxB = m_aabbs[entryB.body];
+                    if (!boxA.overlaps(boxB)) {
+                        continue;
+                    }
+                    // Bodies sharing several cells are reported only from the
+                    // cell holding the lower corner of their overlap
+                    float overlapX = std::max(boxA.min.x, boxB.min.x);
+                    float overlapY = std::max(boxA.min.y, boxB.min.y);
+                    if (static_cast<int32_t>(std::floor(overlapX * invCellSize)) != entryA.cellX ||
+                        static_cast<int32_t>(std::floor(overlapY * invCellSize)) != entryA.cellY) {
+                        continue;
+                    }
+                    BodyId a = entryA.body;
+                    BodyId b = entryB.body;
+                    pairs.push_back((a < b) ? Pair{a, b} : Pair{b, a});
+                }
+            }
+        }
+    });
+
+    m_pairs.clear();
+    for (const std::vector<Pair>& pairs : m_chunkPairs) {
+        m_pairs.insert(m_pairs.end(), pairs.begin(), pairs.end());
+    }
+}
+
+// ===== Narrowphase =====
+
+void PhysicsWorld::collideBlock(size_t begin, size_t end) {
+    // Circle pairs are gathered into lanes and run as one batch
+    float ax[NARROWPHASE_GRAIN], ay[NARROWPHASE_GRAIN], ar[NARROWPHASE_GRAIN];
+    float bx[NARROWPHASE_GRAIN], by[NARROWPHASE_GRAIN], br[NARROWPHASE_GRAIN];
+    uint32_t circlePairs[NARROWPHASE_GRAIN];
+    Manifold circleManifolds[NARROWPHASE_GRAIN];
+    size_t circleCount = 0;
+
+    for (size_t i = begin; i < end; ++i) {
+        const Pair& pair = m_pairs[i];
+        Manifold& manifold = m_manifolds[i];
+        manifold.pointCount = 0;
+
+        // Nothing moved, keep whatever the pair had when it fell asleep
+        if (!isActive(m_bodies[pair.a]) && !isActive(m_bodies[pair.b])) {
+            if (const Contact* previous = findContact(m_previousContacts, makePairKey(pair.a, pair.b))) {
+                manifold = previous->manifold;
+            }
+            continue;
+        }
+
+        const WorldShape& shapeA = m_worldShapes[pair.a];
+        const WorldShape& shapeB = m_worldShapes[pair.b];
+        if (shapeA.type == ShapeType::Circle && shapeB.type == ShapeType::Circle) {
+            ax[circleCount] = shapeA.center.x;
+            ay[circleCount] = shapeA.center.y;
+            ar[circleCount] = shapeA.radius;
+            bx[circleCount] = shapeB.center.x;
+            by[circleCount] = shapeB.center.y;
+            br[circleCount] = shapeB.radius;
+            circlePairs[circleCount++] = static_cast<uint32_t>(i);
+        } else if (shapeA.type == ShapeType::Polygon && shapeB.type == ShapeType::Polygon) {
+            collidePolygons(shapeA, shapeB, manifold);
+        } else if (shapeA.type == ShapeType::Polygon) {
+            collidePolygonCircle(shapeA, shapeB, manifold);
+        } else {
+            // Polygon is B here, flip the normal so it still points A to B
+            collidePolygonCircle(shapeB, shapeA, manifold);
+            manifold.normal = -manifold.normal;
+        }
+    }
+
+    CirclePairBatch batch;
+    batch.count = circleCount;
+    batch.ax = ax;
+    batch.ay = ay;
+    batch.ar = ar;
+    batch.bx = bx;
+    batch.by = by;
+    batch.br = br;
+    collideCircleBatch(batch, circleManifolds);
+    for (size_t k = 0; k < circleCount; ++k) {
+        m_manifolds[circlePairs[k]] = circleManifolds[k];
+    }
+}
+
+void PhysicsWorld::collidePairs() {
+    m_manifolds.resize(m_pairs.size());
+    m_previousContacts.swap(m_contacts);
+    m_contacts.clear();
+
+    m_pool->parallelFor(m_pairs.size(), NARROWPHASE_GRAIN, [this](size_t begin, size_t end) {
+        // Ranges run inline can be longer than one block of lanes
+        for (size_t blockBegin = begin; blockBegin < end; blockBegin += NARROWPHASE_GRAIN) {
+            collideBlock(blockBegin, std::min(blockBegin + NARROWPHASE_GRAIN, end));
+        }
+    });
+
+    // Keep touching pairs and carry over impulses for warm starting
+    for (size_t i = 0; i < m_pairs.size(); ++i) {
+        const Manifold& manifold = m_manifolds[i];
+        if (manifold.pointCount == 0) {
+            continue;
+        }
+        const Pair& pair = m_pairs[i];
+        const Body& bodyA = m_bodies[pair.a];
+        const Body& bodyB = m_bodies[pair.b];
+
+        Contact contact;
+        contact.key = makePairKey(pair.a, pair.b);
+        contact.bodyA = pair.a;
+        contact.bodyB = pair.b;
+        contact.friction = std::sqrt(bodyA.friction * bodyB.friction);
+        contact.restitution = std::max(bodyA.restitution, bodyB.restitution);
+        contact.manifold = manifold;
+
+        if (const Contact* previous = findContact(m_previousContacts, contact.key)) {
+            for (int p = 0; p < manifold.pointCount; ++p) {
+                for (int q = 0; q < previous->manifold.pointCount; ++q) {
+                    if (previous->manifold.points[q].id == manifold.points[p].id) {
+                        contact.normalImpulse[p] = previous->normalImpulse[q];
+                        contact.tangentImpulse[p] = previous->tangentImpulse[q];
+                        break;
+                    }
+                }
+            }
+        }
+        m_contacts.push_back(contact);
+    }
+
+    std::sort(m_contacts.begin(), m_contacts.end(),
+              [](const Contact& a, const Contact& b) { return a.key < b.key; });
+}
+
+// ===== Islands =====
+
+static uint32_t findRoot(std::vector<uint32_t>& parent, uint32_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+void PhysicsWorld::buildIslands() {
+    const size_t bodyCount = m_bodies.size();
+    m_parent.resize(bodyCount);
+    for (size_t i = 0; i < bodyCount; ++i) {
+        m_parent[i] = static_cast<uint32_t>(i);
+    }
+
+    // Static bodies never join islands, otherwise the ground would merge
+    // every pile on it into one island
+    for (const Contact& contact : m_contacts) {
+        if (m_bodies[contact.bodyA].type != BodyType::Dynamic || m_bodies[contact.bodyB].type != BodyType::Dynamic) {
+            continue;
+        }
+        uint32_t rootA = findRoot(m_parent, contact.bodyA);
+        uint32_t rootB = findRoot(m_parent, contact.bodyB);
+        // Lowest index becomes the root so numbering follows body order
+        if (rootA < rootB) {
+            m_parent[rootB] = rootA;
+        } else if (rootB < rootA) {
+            m_parent[rootA] = rootB;
+        }
+    }
+
+    m_islandOfBody.assign(bodyCount, NO_ISLAND);
+    m_islandBodyStart.clear();
+    for (size_t i = 0; i < bodyCount; ++i) {
+        if (m_bodies[i].type != BodyType::Dynamic) {
+            continue;
+        }
+        uint32_t root = findRoot(m_parent, static_cast<uint32_t>(i));
+        if (root == i) {
+            m_islandOfBody[i] = static_cast<uint32_t>(m_islandBodyStart.size());
+            m_islandBodyStart.push_back(0);
+        } else {
+            m_islandOfBody[i] = m_islandOfBody[root];
+        }
+        ++m_islandBodyStart[m_islandOfBody[i]];
+    }
+    const size_t islandCount = m_islandBodyStart.size();
+
+    // Counts to offsets, then fill in body order
+    uint32_t offset = 0;
+    for (uint32_t& start : m_islandBodyStart) {
+        uint32_t count = start;
+        start = offset;
+        offset += count;
+    }
+    m_islandBodyStart.push_back(offset);
+    m_islandBodies.resize(offset);
+    std::vector<uint32_t>& cursor = m_parent; // Union-find is done, reuse its storage
+    cursor.assign(m_islandBodyStart.begin(), m_islandBodyStart.end() - 1);
+    for (size_t i = 0; i < bodyCount; ++i) {
+        if (m_islandOfBody[i] != NO_ISLAND) {
+            m_islandBodies[cursor[m_islandOfBody[i]]++] = static_cast<BodyId>(i);
+        }
+    }
+
+    // Same for contacts, each belongs to the island of its dynamic body
+    m_islandContactStart.assign(islandCount + 1, 0);
+    for (const Contact& contact : m_contacts) {
+        uint32_t island = m_islandOfBody[contact.bodyA];
+        island = (island != NO_ISLAND) ? island : m_islandOfBody[contact.bodyB];
+        ++m_islandContactStart[island + 1];
+    }
+    for (size_t i = 0; i < islandCount; ++i) {
+        m_islandContactStart[i + 1] += m_islandContactStart[i];
+    }
+    m_islandContacts.resize(m_contacts.size());
+    cursor.assign(m_islandContactStart.begin(), m_islandContactStart.end() - 1);
+    for (size_t c = 0; c < m_contacts.size(); ++c) {
+        uint32_t island = m_islandOfBody[m_contacts[c].bodyA];
+        island = (island != NO_ISLAND) ? island : m_islandOfBody[m_contacts[c].bodyB];
+        m_islandContacts[cursor[island]++] = static_cast<uint32_t>(c);
+    }
+
+    // An island is simulated if any body in it is awake, which also wakes a
+    // sleeping pile as soon as something active touches it
+    m_islandOrder.clear();
+    for (uint32_t island = 0; island < islandCount; ++island) {
+        uint32_t begin = m_islandBodyStart[island];
+        uint32_t end = m_islandBodyStart[island + 1];
+        bool awake = false;
+        for (uint32_t k = begin; k < end && !awake; ++k) {
+            awake = m_bodies[m_islandBodies[k]].awake;
+        }
+        if (!awake) {
+            continue;
+        }
+        for (uint32_t k = begin; k < end; ++k) {
+            Body& body = m_bodies[m_islandBodies[k]];
+            if (!body.awake) {
+                body.awake = true;
+                body.sleepTime = 0.0f;
+            }
+        }
+        m_islandOrder.push_back(island);
+    }
+
+    // Largest islands first so one big pile does not end up as the last job
+    std::stable_sort(m_islandOrder.begin(), m_islandOrder.end(), [this](uint32_t a, uint32_t b) {
+        return m_islandBodyStart[a + 1] - m_islandBodyStart[a] > m_islandBodyStart[b + 1] - m_islandBodyStart[b];
+    });
+}
+
+// ===== Solver =====
+
+void PhysicsWorld::solveIslands(float dt) {
+    m_localIndex.resize(m_bodies.size());
+    m_pool->parallelFor(m_islandOrder.size(), ISLAND_GRAIN, [this, dt](size_t begin, size_t end) {
+        SolverScratch scratch;
+        for (size_t i = begin; i < end; ++i) {
+            solveIsland(m_islandOrder[i], dt, scratch);
+        }
+    });
+}
+
+void PhysicsWorld::solveIsland(uint32_t island, float dt, SolverScratch& scratch) {
+    const uint32_t bodyBegin = m_islandBodyStart[island];
+    const uint32_t bodyCount = m_islandBodyStart[island + 1] - bodyBegin;
+    const uint32_t contactBegin = m_islandContactStart[island];
+    const uint32_t contactCount = m_islandContactStart[island + 1] - contactBegin;
+    const float invDt = 1.0f / dt;
+
+    // Local velocity copies, the extra slot stands in for any static body
+    const uint32_t staticSlot = bodyCount;
+    scratch.velocities.resize(bodyCount + 1);
+    scratch.angularVelocities.resize(bodyCount + 1);
+    for (uint32_t k = 0; k < bodyCount; ++k) {
+        BodyId id = m_islandBodies[bodyBegin + k];
+        const Body& body = m_bodies[id];
+        m_localIndex[id] = k;
+        scratch.velocities[k] = body.linearVelocity + m_settings.gravity * dt;
+        scratch.angularVelocities[k] = body.angularVelocity;
+    }
+    scratch.velocities[staticSlot] = Vec2(0.0f, 0.0f);
+    scratch.angularVelocities[staticSlot] = 0.0f;
+    Vec2* v = scratch.velocities.data();
+    float* w = scratch.angularVelocities.data();
+
+    // Prepare constraints and apply last step's impulses
+    scratch.constraints.resize(contactCount);
+    for (uint32_t c = 0; c < contactCount; ++c) {
+        const Contact& contact = m_contacts[m_islandContacts[contactBegin + c]];
+        const Body& bodyA = m_bodies[contact.bodyA];
+        const Body& bodyB = m_bodies[contact.bodyB];
+        ContactConstraint& cc = scratch.constraints[c];
+        cc.indexA = (bodyA.type == BodyType::Dynamic) ? m_localIndex[contact.bodyA] : staticSlot;
+        cc.indexB = (bodyB.type == BodyType::Dynamic) ? m_localIndex[contact.bodyB] : staticSlot;
+        cc.invMassA = bodyA.invMass;
+        cc.invMassB = bodyB.invMass;
+        cc.invIA = bodyA.invInertia;
+        cc.invIB = bodyB.invInertia;
+        cc.normal = contact.manifold.normal;
+        const Vec2 tangent = cross(cc.normal, 1.0f);
+
+        for (int p = 0; p < contact.manifold.pointCount; ++p) {
+            const ManifoldPoint& mp = contact.manifold.points[p];
+            cc.rA[p] = mp.point - bodyA.position;
+            cc.rB[p] = mp.point - bodyB.position;
+
+            float rnA = cross(cc.rA[p], cc.normal);
+            float rnB = cross(cc.rB[p], cc.normal);
+            float kNormal = cc.invMassA + cc.invMassB + cc.invIA * rnA * rnA + cc.invIB * rnB * rnB;
+            cc.normalMass[p] = (kNormal > 0.0f) ? 1.0f / kNormal : 0.0f;
+
+            float rtA = cross(cc.rA[p], tangent);
+            float rtB = cross(cc.rB[p], tangent);
+            float kTangent = cc.invMassA + cc.invMassB + cc.invIA * rtA * rtA + cc.invIB * rtB * rtB;
+            cc.tangentMass[p] = (kTangent > 0.0f) ? 1.0f / kTangent : 0.0f;
+
+            // Speculative contacts may close the gap but not more, overlapping
+            // ones get pushed apart, fast impacts bounce
+            float bias;
+            if (mp.separation > 0.0f) {
+                bias = -mp.separation * invDt;
+            } else {
+                bias = std::min(-BAUMGARTE * invDt * std::min(0.0f, mp.separation + LINEAR_SLOP), MAX_CORRECTION_SPEED);
+            }
+            Vec2 dv = v[cc.indexB] + cross(w[cc.indexB], cc.rB[p]) - v[cc.indexA] - cross(w[cc.indexA], cc.rA[p]);
+            float approach = dot(dv, cc.normal);
+            if (approach < -RESTITUTION_THRESHOLD) {
+                bias = std::max(bias, -contact.restitution * approach);
+            }
+            cc.bias[p] = bias;
+
+            Vec2 impulse = cc.normal * contact.normalImpulse[p] + tangent * contact.tangentImpulse[p];
+            v[cc.indexA] -= impulse * cc.invMassA;
+            w[cc.indexA] -= cc.invIA * cross(cc.rA[p], impulse);
+            v[cc.indexB] += impulse * cc.invMassB;
+            w[cc.indexB] += cc.invIB * cross(cc.rB[p], impulse);
+        }
+    }
+    // Static bodies have zero inverse mass, but keep the shared slot clean
+    v[staticSlot] = Vec2(0.0f, 0.0f);
+    w[staticSlot] = 0.0f;
+
+    for (int iteration = 0; iteration < m_settings.velocityIterations; ++iteration) {
+        for (uint32_t c = 0; c < contactCount; ++c) {
+            Contact& contact = m_contacts[m_islandContacts[contactBegin + c]];
+            const ContactConstraint& cc = scratch.constraints[c];
+            const Vec2 tangent = cross(cc.normal, 1.0f);
+            Vec2 vA = v[cc.indexA];
+            float wA = w[cc.indexA];
+            Vec2 vB = v[cc.indexB];
+            float wB = w[cc.indexB];
+
+            // Friction first so the normal impulse has the final word
+            for (int p = 0; p < contact.manifold.pointCount; ++p) {
+                Vec2 dv = vB + cross(wB, cc.rB[p]) - vA - cross(wA, cc.rA[p]);
+                float lambda = -cc.tangentMass[p] * dot(dv, tangent);
+                float maxFriction = contact.friction * contact.normalImpulse[p];
+                float newImpulse = std::max(-maxFriction, std::min(contact.tangentImpulse[p] + lambda, maxFriction));
+                lambda = newImpulse - contact.tangentImpulse[p];
+                contact.tangentImpulse[p] = newImpulse;
+
+                Vec2 impulse = tangent * lambda;
+                vA -= impulse * cc.invMassA;
+                wA -= cc.invIA * cross(cc.rA[p], impulse);
+                vB += impulse * cc.invMassB;
+                wB += cc.invIB * cross(cc.rB[p], impulse);
+            }
+
+            for (int p = 0; p < contact.manifold.pointCount; ++p) {
+                Vec2 dv = vB + cross(wB, cc.rB[p]) - vA - cross(wA, cc.rA[p]);
+                float lambda = cc.normalMass[p] * (cc.bias[p] - dot(dv, cc.normal));
+                float newImpulse = std::max(contact.normalImpulse[p] + lambda, 0.0f);
+                lambda = newImpulse - contact.normalImpulse[p];
+                contact.normalImpulse[p] = newImpulse;
+
+                Vec2 impulse = cc.normal * lambda;
+                vA -= impulse * cc.invMassA;
+                wA -= cc.invIA * cross(cc.rA[p], impulse);
+                vB += impulse * cc.invMassB;
+                wB += cc.invIB * cross(cc.rB[p], impulse);
+            }
+
+            v[cc.indexA] = vA;
+            w[cc.indexA] = wA;
+            v[cc.indexB] = vB;
+            w[cc.indexB] = wB;
+            v[staticSlot] = Vec2(0.0f, 0.0f);
+            w[staticSlot] = 0.0f;
+        }
+    }
+
+    // Integrate and track how long the island has been at rest
+    const float linearTolSq = m_settings.linearSleepTolerance * m_settings.linearSleepTolerance;
+    const float angularTolSq = m_settings.angularSleepTolerance * m_settings.angularSleepTolerance;
+    float minSleepTime = 1e30f;
+    for (uint32_t k = 0; k < bodyCount; ++k) {
+        Body& body = m_bodies[m_islandBodies[bodyBegin + k]];
+        body.linearVelocity = v[k];
+        body.angularVelocity = w[k];
+        body.position += v[k] * dt;
+        body.angle += w[k] * dt;
+        body.rotation = Rot(body.angle);
+
+        if (!m_settings.allowSleep || v[k].lengthSquared() > linearTolSq || w[k] * w[k] > angularTolSq) {
+            body.sleepTime = 0.0f;
+        } else {
+            body.sleepTime += dt;
+        }
+        minSleepTime = std::min(minSleepTime, body.sleepTime);
+    }
+
+    if (m_settings.allowSleep && minSleepTime >= m_settings.timeToSleep) {
+        for (uint32_t k = 0; k < bodyCount; ++k) {
+            Body& body = m_bodies[m_islandBodies[bodyBegin + k]];
+            body.awake = false;
+            body.linearVelocity = Vec2(0.0f, 0.0f);
+            body.angularVelocity = 0.0f;
+        }
+    }
+}
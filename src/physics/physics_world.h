@@ -0,0 +1,157 @@
+#ifndef PHYSICS_WORLD_H
+#define PHYSICS_WORLD_H
+
+#include "collision.h"
+#include "../core/thread_pool.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 2D rigid body world.
+//
+// A step runs a hashed grid broadphase, batched narrowphase, island
+// building and then a sequential impulse solver per island. Islands share no
+// bodies or contacts so they are solved in parallel, and because each island
+// is always solved the same way the result does not depend on thread count.
+// Call step() with a constant dt (see FixedTimestep) for reproducible runs.
+
+using BodyId = uint32_t;
+
+enum class BodyType : uint8_t {
+    Static,
+    Dynamic
+};
+
+struct BodyDef {
+    BodyType type = BodyType::Dynamic;
+    Vec2 position;
+    float angle = 0.0f;
+    Vec2 linearVelocity;
+    float angularVelocity = 0.0f;
+    Shape shape = makeCircle(0.5f);
+    float density = 1.0f;
+    float friction = 0.4f;
+    float restitution = 0.0f;
+};
+
+struct Body {
+    Vec2 position;
+    float angle = 0.0f;
+    Rot rotation;
+    Vec2 linearVelocity;
+    float angularVelocity = 0.0f;
+    float invMass = 0.0f;
+    float invInertia = 0.0f;
+    float friction = 0.4f;
+    float restitution = 0.0f;
+    float sleepTime = 0.0f;
+    BodyType type = BodyType::Dynamic;
+    bool awake = true;
+    Shape shape;
+};
+
+struct WorldSettings {
+    Vec2 gravity = Vec2(0.0f, -10.0f);
+    int velocityIterations = 8;
+    bool allowSleep = true;
+    float timeToSleep = 0.5f;          // Seconds an island must stay still
+    float linearSleepTolerance = 0.01f;  // m/s
+    float angularSleepTolerance = 0.035f; // rad/s
+    float cellSize = 2.0f;              // Broadphase grid cell, about twice a typical body
+    size_t threadCount = 1;             // Used when no pool is supplied
+};
+
+// Persistent contact between two bodies, kept sorted by key between steps
+// so accumulated impulses can be matched for warm starting
+struct Contact {
+    uint64_t key = 0;
+    BodyId bodyA = 0;
+    BodyId bodyB = 0;
+    float friction = 0.0f;
+    float restitution = 0.0f;
+    Manifold manifold;
+    float normalImpulse[2] = {0.0f, 0.0f};
+    float tangentImpulse[2] = {0.0f, 0.0f};
+};
+
+class PhysicsWorld {
+public:
+    // pool may be shared with other systems; without one the world creates
+    // its own with settings.threadCount threads
+    explicit PhysicsWorld(const WorldSettings& settings = WorldSettings(), ThreadPool* pool = nullptr);
+
+    PhysicsWorld(const PhysicsWorld&) = delete;
+    PhysicsWorld& operator=(const PhysicsWorld&) = delete;
+
+    BodyId createBody(const BodyDef& def);
+    const Body& getBody(BodyId id) const { return m_bodies[id]; }
+    size_t getBodyCount() const { return m_bodies.size(); }
+
+    void setLinearVelocity(BodyId id, const Vec2& velocity);
+    void applyLinearImpulse(BodyId id, const Vec2& impulse);
+    void wakeBody(BodyId id);
+
+    void step(float dt);
+
+    // Stats from the last step
+    size_t getContactCount() const { return m_contacts.size(); }
+    size_t getIslandCount() const { return m_islandBodyStart.empty() ? 0 : m_islandBodyStart.size() - 1; }
+    size_t getAwakeBodyCount() const;
+
+private:
+    struct Pair {
+        BodyId a;
+        BodyId b;
+    };
+    struct GridEntry {
+        int32_t cellX;
+        int32_t cellY;
+        BodyId body;
+        bool isStatic;
+    };
+    struct SolverScratch;
+
+    bool isActive(const Body& body) const { return body.type == BodyType::Dynamic && body.awake; }
+
+    void updateBroadphase();
+    void findPairs();
+    void collidePairs();
+    void collideBlock(size_t begin, size_t end);
+    void buildIslands();
+    void solveIslands(float dt);
+    void solveIsland(uint32_t island, float dt, SolverScratch& scratch);
+
+    WorldSettings m_settings;
+    std::unique_ptr<ThreadPool> m_ownedPool;
+    ThreadPool* m_pool;
+
+    std::vector<Body> m_bodies;
+    std::vector<AABB> m_aabbs;
+    std::vector<WorldShape> m_worldShapes;
+
+    // Hashed uniform grid, entries grouped by bucket in compressed-row form
+    std::vector<GridEntry> m_gridEntries;
+    std::vector<GridEntry> m_bucketEntries;
+    std::vector<uint32_t> m_bucketStart;
+    std::vector<uint32_t> m_bucketCursor;
+    std::vector<std::vector<Pair>> m_chunkPairs;
+    std::vector<Pair> m_pairs;
+    std::vector<Manifold> m_manifolds;
+
+    std::vector<Contact> m_contacts;
+    std::vector<Contact> m_previousContacts;
+
+    // Islands in compressed-row form: island i owns
+    // m_islandBodies[m_islandBodyStart[i] .. m_islandBodyStart[i + 1])
+    std::vector<uint32_t> m_parent;
+    std::vector<uint32_t> m_islandOfBody;
+    std::vector<uint32_t> m_islandBodyStart;
+    std::vector<BodyId> m_islandBodies;
+    std::vector<uint32_t> m_islandContactStart;
+    std::vector<uint32_t> m_islandContacts;
+    std::vector<uint32_t> m_islandOrder;
+    std::vector<uint32_t> m_localIndex;
+};
+
+#endif // PHYSICS_WORLD_H
@@ -0,0 +1,84 @@
+#include "shape.h"
+
+#include <algorithm>
+
+Shape makeCircle(float radius) {
+    Shape shape;
+    shape.type = ShapeType::Circle;
+    shape.radius = radius;
+    return shape;
+}
+
+Shape makeBox(float halfWidth, float halfHeight) {
+    const Vec2 points[4] = {
+        Vec2(-halfWidth, -halfHeight),
+        Vec2(halfWidth, -halfHeight),
+        Vec2(halfWidth, halfHeight),
+        Vec2(-halfWidth, halfHeight)
+    };
+    return makePolygon(points, 4);
+}
+
+Shape makePolygon(const Vec2* points, int count) {
+    float boundingRadius = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        boundingRadius = std::max(boundingRadius, points[i].length());
+    }
+    if (count < 3 || count > MAX_POLYGON_VERTICES) {
+        return makeCircle(boundingRadius);
+    }
+
+    Shape shape;
+    shape.type = ShapeType::Polygon;
+    shape.count = count;
+    shape.radius = boundingRadius;
+    for (int i = 0; i < count; ++i) {
+        shape.vertices[i] = points[i];
+        Vec2 edge = points[(i + 1) % count] - points[i];
+        shape.normals[i] = normalize(cross(edge, 1.0f));
+    }
+    return shape;
+}
+
+MassData computeMass(const Shape& shape, float density) {
+    MassData data;
+    if (shape.type == ShapeType::Circle) {
+        data.mass = density * 3.14159265f * shape.radius * shape.radius;
+        data.inertia = 0.5f * data.mass * shape.radius * shape.radius;
+        return data;
+    }
+
+    // Triangle fan about the origin
+    float area = 0.0f;
+    float inertia = 0.0f;
+    for (int i = 0; i < shape.count; ++i) {
+        const Vec2& e1 = shape.vertices[i];
+        const Vec2& e2 = shape.vertices[(i + 1) % shape.count];
+        float d = cross(e1, e2);
+        area += 0.5f * d;
+        float intx2 = e1.x * e1.x + e2.x * e1.x + e2.x * e2.x;
+        float inty2 = e1.y * e1.y + e2.y * e1.y + e2.y * e2.y;
+        inertia += (0.25f / 3.0f) * d * (intx2 + inty2);
+    }
+    data.mass = density * area;
+    data.inertia = density * inertia;
+    return data;
+}
+
+AABB computeAABB(const Shape& shape, const Vec2& position, const Rot& rotation) {
+    AABB box;
+    if (shape.type == ShapeType::Circle) {
+        box.min = Vec2(position.x - shape.radius, position.y - shape.radius);
+        box.max = Vec2(position.x + shape.radius, position.y + shape.radius);
+        return box;
+    }
+    Vec2 v = position + rotate(rotation, shape.vertices[0]);
+    box.min = v;
+    box.max = v;
+    for (int i = 1; i < shape.count; ++i) {
+        v = position + rotate(rotation, shape.vertices[i]);
+        box.min = Vec2(std::min(box.min.x, v.x), std::min(box.min.y, v.y));
+        box.max = Vec2(std::max(box.max.x, v.x), std::max(box.max.y, v.y));
+    }
+    return box;
+}
@@ -0,0 +1,42 @@
+#ifndef SHAPE_H
+#define SHAPE_H
+
+#include "math2d.h"
+
+#include <cstdint>
+
+// Upper bound on polygon vertex count. Kept a multiple of 4 so the SIMD
+// separating-axis test can walk vertices in whole lanes.
+constexpr int MAX_POLYGON_VERTICES = 8;
+
+enum class ShapeType : uint8_t {
+    Circle,
+    Polygon
+};
+
+// Collision shape in body-local space. Boxes are polygons.
+struct Shape {
+    ShapeType type = ShapeType::Circle;
+    int count = 0;     // Polygon vertex count
+    float radius = 0.0f; // Circle radius, or bounding radius for polygons
+    Vec2 vertices[MAX_POLYGON_VERTICES];
+    Vec2 normals[MAX_POLYGON_VERTICES];
+};
+
+Shape makeCircle(float radius);
+Shape makeBox(float halfWidth, float halfHeight);
+// Builds a convex polygon from counter-clockwise points centred on the body
+// origin. Returns a circle with the bounding radius if fewer than 3 or more
+// than MAX_POLYGON_VERTICES points are given.
+Shape makePolygon(const Vec2* points, int count);
+
+// Mass properties for a shape of the given density, about its local origin
+struct MassData {
+    float mass = 0.0f;
+    float inertia = 0.0f;
+};
+
+MassData computeMass(const Shape& shape, float density);
+AABB computeAABB(const Shape& shape, const Vec2& position, const Rot& rotation);
+
+#endif // SHAPE_H
@@ -0,0 +1,13 @@
+#ifndef BUILTIN_FONT_H
+#define BUILTIN_FONT_H
+
+#include "text_renderer.h"
+
+// Printable ASCII from a built-in 5x7 bitmap font, box filtered up to the
+// requested pixel size. Lets the engine put text on screen without a font
+// library; other codepoints are left to the renderer's '?' fallback.
+bool rasterizeBuiltinGlyph(uint32_t codepoint, int pixelSize, GlyphBitmap& out);
+
+FontDesc makeBuiltinFont();
+
+#endif // BUILTIN_FONT_H
@@ -0,0 +1,20 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+// 2D view into world space, in pixels. World point p lands on screen at
+// (p - position) * zoom.
+struct Camera2D {
+    float x = 0.0f;
+    float y = 0.0f;
+    float zoom = 1.0f;
+    float viewportWidth = 800.0f;
+    float viewportHeight = 600.0f;
+
+    // Visible world rectangle
+    float getLeft() const { return x; }
+    float getTop() const { return y; }
+    float getRight() const { return x + viewportWidth / zoom; }
+    float getBottom() const { return y + viewportHeight / zoom; }
+};
+
+#endif // CAMERA_H
@@ -0,0 +1,268 @@
+#include "glyph_atlas.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const int CELL_SIZES[] = {16, 32, 64, 128};
+
+// RGBA32 is byte order R, G, B, A whatever the host endianness
+uint32_t whiteWithAlpha(uint8_t alpha) {
+    uint8_t bytes[4] = {255, 255, 255, alpha};
+    uint32_t pixel;
+    std::memcpy(&pixel, bytes, sizeof(pixel));
+    return pixel;
+}
+
+} // namespace
+
+GlyphAtlas::GlyphAtlas(SDL_Renderer* renderer, int size)
+    : m_size(std::max(size, CELL_SIZES[SIZE_CLASS_COUNT - 1])),
+      m_pixels(static_cast<size_t>(m_size) * m_size, whiteWithAlpha(0)),
+      m_dirtyTop(m_size) {
+    m_shelves.push_back(Shelf{0, m_size, NO_CLASS, {}});
+    if (renderer) {
+        m_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, m_size, m_size);
+        if (m_texture) {
+            SDL_SetTextureBlendMode(m_texture, SDL_BLENDMODE_BLEND);
+            // Start from a fully transparent texture
+            m_dirtyTop = 0;
+            m_dirtyBottom = m_size;
+        }
+    }
+}
+
+GlyphAtlas::~GlyphAtlas() {
+    if (m_texture) {
+        SDL_DestroyTexture(m_texture);
+    }
+}
+
+uint32_t GlyphAtlas::find(uint64_t key) {
+    auto it = m_lookup.find(key);
+    if (it == m_lookup.end()) {
+        return NO_GLYPH;
+    }
+    m_slots[it->second].lastUsed = m_frame;
+    return it->second;
+}
+
+uint32_t GlyphAtlas::insert(uint64_t key, const GlyphBitmap& bitmap) {
+    uint32_t slotIndex;
+    if (bitmap.width <= 0 || bitmap.height <= 0) {
+        // Spaces and the like only carry metrics
+        slotIndex = static_cast<uint32_t>(m_slots.size());
+        m_slots.push_back(Slot());
+    } else {
+        // One pixel of padding keeps filtering from bleeding between cells
+        int extent = std::max(bitmap.width, bitmap.height) + 1;
+        int sizeClass = 0;
+        while (sizeClass < SIZE_CLASS_COUNT && CELL_SIZES[sizeClass] < extent) {
+            ++sizeClass;
+        }
+        if (sizeClass == SIZE_CLASS_COUNT) {
+            return NO_GLYPH;
+        }
+        slotIndex = takeCell(sizeClass);
+        if (slotIndex == NO_GLYPH) {
+            return NO_GLYPH;
+        }
+    }
+
+    Slot& slot = m_slots[slotIndex];
+    slot.key = key;
+    slot.lastUsed = m_frame;
+    const float invSize = 1.0f / static_cast<float>(m_size);
+    slot.glyph.u0 = static_cast<float>(slot.x) * invSize;
+    slot.glyph.v0 = static_cast<float>(slot.y) * invSize;
+    slot.glyph.u1 = static_cast<float>(slot.x + bitmap.width) * invSize;
+    slot.glyph.v1 = static_cast<float>(slot.y + bitmap.height) * invSize;
+    slot.glyph.width = static_cast<float>(std::max(bitmap.width, 0));
+    slot.glyph.height = static_cast<float>(std::max(bitmap.height, 0));
+    slot.glyph.bearingX = bitmap.bearingX;
+    slot.glyph.bearingY = bitmap.bearingY;
+    slot.glyph.advance = bitmap.advance;
+    if (slot.sizeClass != NO_CLASS) {
+        writePixels(slot, bitmap);
+    }
+    m_lookup[key] = slotIndex;
+    return slotIndex;
+}
+
+bool GlyphAtlas::addShelf(int sizeClass) {
+    const int cell = CELL_SIZES[sizeClass];
+    size_t i = 0;
+    while (i < m_shelves.size() && (m_shelves[i].sizeClass != NO_CLASS || m_shelves[i].height < cell)) {
+        ++i;
+    }
+    if (i == m_shelves.size()) {
+        return false;
+    }
+    // The rows the cells do not need stay free below them
+    if (m_shelves[i].height > cell) {
+        const Shelf rest = {m_shelves[i].y + cell, m_shelves[i].height - cell, NO_CLASS, {}};
+        m_shelves.insert(m_shelves.begin() + i + 1, rest);
+    }
+    Shelf& shelf = m_shelves[i];
+    shelf.height = cell;
+    shelf.sizeClass = static_cast<uint8_t>(sizeClass);
+    SizeClass& cls = m_classes[sizeClass];
+    for (int x = 0; x + cell <= m_size; x += cell) {
+        uint32_t index;
+        if (m_spareSlots.empty()) {
+            index = static_cast<uint32_t>(m_slots.size());
+            m_slots.push_back(Slot());
+        } else {
+            index = m_spareSlots.back();
+            m_spareSlots.pop_back();
+        }
+        Slot& slot = m_slots[index];
+        slot.lastUsed = 0;
+        slot.sizeClass = static_cast<uint8_t>(sizeClass);
+        slot.x = x;
+        slot.y = shelf.y;
+        shelf.cells.push_back(index);
+        cls.cells.push_back(index);
+        cls.freeCells.push_back(index);
+    }
+    return true;
+}
+
+uint32_t GlyphAtlas::shelfLastUsed(const Shelf& shelf) const {
+    uint32_t lastUsed = 0;
+    for (uint32_t index : shelf.cells) {
+        lastUsed = std::max(lastUsed, m_slots[index].lastUsed);
+    }
+    return lastUsed;
+}
+
+// Evicts the shelf's glyphs and puts its cells aside for reuse
+void GlyphAtlas::freeShelf(Shelf& shelf) {
+    SizeClass& cls = m_classes[shelf.sizeClass];
+    for (uint32_t index : shelf.cells) {
+        Slot& slot = m_slots[index];
+        auto it = m_lookup.find(slot.key);
+        if (it != m_lookup.end() && it->second == index) {
+            m_lookup.erase(it);
+            ++m_evictions;
+        }
+        slot.key = 0;
+        slot.sizeClass = NO_CLASS;
+        ++slot.generation;
+        cls.cells.erase(std::find(cls.cells.begin(), cls.cells.end(), index));
+        auto free = std::find(cls.freeCells.begin(), cls.freeCells.end(), index);
+        if (free != cls.freeCells.end()) {
+            cls.freeCells.erase(free);
+        }
+        m_spareSlots.push_back(index);
+    }
+    shelf.cells.clear();
+    shelf.sizeClass = NO_CLASS;
+}
+
+// Frees the run of shelves of other classes, tall enough for one shelf of
+// sizeClass, whose newest glyph is oldest, as long as none of it is in use
+// this frame; then cuts the new shelf from it
+bool GlyphAtlas::reclaimShelves(int sizeClass) {
+    const int cell = CELL_SIZES[sizeClass];
+    size_t bestFirst = 0;
+    size_t bestEnd = 0;
+    uint32_t bestLastUsed = m_frame;
+    for (size_t first = 0; first < m_shelves.size(); ++first) {
+        int height = 0;
+        uint32_t lastUsed = 0;
+        size_t end = first;
+        for (; end < m_shelves.size() && height < cell && m_shelves[end].sizeClass != sizeClass; ++end) {
+            height += m_shelves[end].height;
+            lastUsed = std::max(lastUsed, shelfLastUsed(m_shelves[end]));
+        }
+        if (height >= cell && lastUsed < bestLastUsed) {
+            bestFirst = first;
+            bestEnd = end;
+            bestLastUsed = lastUsed;
+        }
+    }
+    if (bestEnd == bestFirst) {
+        return false;
+    }
+    for (size_t i = bestFirst; i < bestEnd; ++i) {
+        if (m_shelves[i].sizeClass != NO_CLASS) {
+            freeShelf(m_shelves[i]);
+        }
+    }
+    // Neighbouring free bands become one
+    for (size_t i = 1; i < m_shelves.size();) {
+        if (m_shelves[i - 1].sizeClass == NO_CLASS && m_shelves[i].sizeClass == NO_CLASS) {
+            m_shelves[i - 1].height += m_shelves[i].height;
+            m_shelves.erase(m_shelves.begin() + i);
+        } else {
+            ++i;
+        }
+    }
+    return addShelf(sizeClass);
+}
+
+uint32_t GlyphAtlas::takeCell(int sizeClass) {
+    SizeClass& cls = m_classes[sizeClass];
+    if (cls.freeCells.empty() && !addShelf(sizeClass)) {
+        // Full: reuse the least recently used cell, unless it is needed
+        // by quads queued this frame
+        uint32_t victim = NO_GLYPH;
+        uint32_t oldest = m_frame;
+        for (uint32_t index : cls.cells) {
+            if (m_slots[index].lastUsed < oldest) {
+                oldest = m_slots[index].lastUsed;
+                victim = index;
+            }
+        }
+        if (victim == NO_GLYPH) {
+            // Nothing of this class to give up, take shelves from others
+            if (!reclaimShelves(sizeClass)) {
+                return NO_GLYPH;
+            }
+        } else {
+            Slot& slot = m_slots[victim];
+            m_lookup.erase(slot.key);
+            ++slot.generation;
+            ++m_evictions;
+            return victim;
+        }
+    }
+    uint32_t index = cls.freeCells.back();
+    cls.freeCells.pop_back();
+    return index;
+}
+
+void GlyphAtlas::writePixels(const Slot& slot, const GlyphBitmap& bitmap) {
+    const int cell = CELL_SIZES[slot.sizeClass];
+    const uint32_t clear = whiteWithAlpha(0);
+    // Clear the whole cell so nothing of an evicted glyph is left in the
+    // padding that filtering can reach
+    for (int y = 0; y < cell; ++y) {
+        uint32_t* row = m_pixels.data() + static_cast<size_t>(slot.y + y) * m_size + slot.x;
+        std::fill(row, row + cell, clear);
+    }
+    for (int y = 0; y < bitmap.height; ++y) {
+        uint32_t* row = m_pixels.data() + static_cast<size_t>(slot.y + y) * m_size + slot.x;
+        const uint8_t* coverage = bitmap.coverage.data() + static_cast<size_t>(y) * bitmap.width;
+        for (int x = 0; x < bitmap.width; ++x) {
+            row[x] = whiteWithAlpha(coverage[x]);
+        }
+    }
+    m_dirtyTop = std::min(m_dirtyTop, slot.y);
+    m_dirtyBottom = std::max(m_dirtyBottom, slot.y + cell);
+}
+
+void GlyphAtlas::upload() {
+    if (m_dirtyTop >= m_dirtyBottom) {
+        return;
+    }
+    if (m_texture) {
+        SDL_Rect rect = {0, m_dirtyTop, m_size, m_dirtyBottom - m_dirtyTop};
+        const int pitch = m_size * static_cast<int>(sizeof(uint32_t));
+        SDL_UpdateTexture(m_texture, &rect, m_pixels.data() + static_cast<size_t>(m_dirtyTop) * m_size, pitch);
+    }
+    m_dirtyTop = m_size;
+    m_dirtyBottom = 0;
+}
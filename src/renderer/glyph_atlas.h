@@ -0,0 +1,124 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <SDL3/SDL.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Rasterized glyph as produced by a font, coverage is one byte per pixel
+struct GlyphBitmap {
+    int width = 0;
+    int height = 0;
+    float bearingX = 0.0f; // Pen position to the left edge
+    float bearingY = 0.0f; // Baseline up to the top edge
+    float advance = 0.0f;
+    std::vector<uint8_t> coverage; // width * height, row-major
+};
+
+// Where a resident glyph lives in the atlas, plus its metrics
+struct AtlasGlyph {
+    float u0, v0, u1, v1;
+    float width, height;
+    float bearingX, bearingY;
+    float advance;
+};
+
+// Square RGBA atlas of rasterized glyphs with least-recently-used eviction.
+//
+// The page is cut into shelves on demand, each shelf holding square cells
+// of one size class (16 to 128 pixels), so a glyph only ever competes with
+// glyphs of a similar size. When a class has no free cell and no shelf
+// space is left, the cell with the oldest frame stamp is reused. A class
+// with nothing to reuse takes over the least recently used run of other
+// classes' shelves instead, so text at a new size still gets room once
+// another size has filled the page. Glyphs stamped in the current frame
+// are never evicted, since quads already queued this frame still point at
+// them. Each reuse bumps the cell's generation so layouts holding the old
+// glyph can tell it is gone.
+//
+// Pixels are kept on the CPU and uploaded as one dirty row band per frame.
+class GlyphAtlas {
+public:
+    static constexpr uint32_t NO_GLYPH = 0xFFFFFFFFu;
+
+    // renderer may be nullptr for headless use, the texture is then null
+    explicit GlyphAtlas(SDL_Renderer* renderer, int size = 1024);
+    ~GlyphAtlas();
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+    void beginFrame() { ++m_frame; }
+
+    // Slot of the glyph stored under key, or NO_GLYPH. Marks it used.
+    uint32_t find(uint64_t key);
+    // Copies bitmap into the atlas. Returns NO_GLYPH when the glyph is too
+    // large for any cell or every candidate cell is in use this frame.
+    uint32_t insert(uint64_t key, const GlyphBitmap& bitmap);
+
+    void touch(uint32_t slot) { m_slots[slot].lastUsed = m_frame; }
+    const AtlasGlyph& getGlyph(uint32_t slot) const { return m_slots[slot].glyph; }
+    // Key of the glyph in slot; changes as soon as the slot is reused
+    uint64_t getKey(uint32_t slot) const { return m_slots[slot].key; }
+    uint32_t getGeneration(uint32_t slot) const { return m_slots[slot].generation; }
+
+    // Sends rows changed since the last upload to the texture
+    void upload();
+
+    SDL_Texture* getTexture() const { return m_texture; }
+    int getSize() const { return m_size; }
+    // Also serves as an epoch: layouts built at the same count are valid
+    uint64_t getEvictionCount() const { return m_evictions; }
+    size_t getResidentCount() const { return m_lookup.size(); }
+
+private:
+    static constexpr int SIZE_CLASS_COUNT = 4;
+    static constexpr uint8_t NO_CLASS = 0xFF;
+
+    struct Slot {
+        uint64_t key = 0;
+        uint32_t lastUsed = 0;
+        uint32_t generation = 0;
+        uint8_t sizeClass = NO_CLASS; // Empty glyphs take no cell
+        int x = 0;
+        int y = 0;
+        AtlasGlyph glyph = {};
+    };
+
+    struct SizeClass {
+        std::vector<uint32_t> cells;
+        std::vector<uint32_t> freeCells;
+    };
+
+    // A band of rows across the page, free or cut into cells of one class
+    struct Shelf {
+        int y;
+        int height;
+        uint8_t sizeClass; // NO_CLASS when free
+        std::vector<uint32_t> cells;
+    };
+
+    bool addShelf(int sizeClass);
+    bool reclaimShelves(int sizeClass);
+    void freeShelf(Shelf& shelf);
+    uint32_t shelfLastUsed(const Shelf& shelf) const;
+    uint32_t takeCell(int sizeClass);
+    void writePixels(const Slot& slot, const GlyphBitmap& bitmap);
+
+    SDL_Texture* m_texture = nullptr;
+    int m_size;
+    std::vector<uint32_t> m_pixels; // RGBA32, white with coverage as alpha
+    std::vector<Shelf> m_shelves; // Top to bottom, covering the page
+    int m_dirtyTop;
+    int m_dirtyBottom = 0;
+
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_spareSlots; // Cells of shelves given back
+    SizeClass m_classes[SIZE_CLASS_COUNT];
+    std::unordered_map<uint64_t, uint32_t> m_lookup;
+    uint32_t m_frame = 1;
+    uint64_t m_evictions = 0;
+};
+
+#endif // GLYPH_ATLAS_H
@@ -0,0 +1,385 @@
+#include "text_renderer.h"
+#include "../core/fnv1a.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXT_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const uint32_t NO_LAYOUT = 0xFFFFFFFFu;
+const int GLYPH_CACHE_BITS = 12;
+
+uint64_t hashText(const char* text, size_t length, FontId font, int pixelSize) {
+    uint32_t prefix[2] = {font, static_cast<uint32_t>(pixelSize)};
+    uint64_t hash = fnv1a(reinterpret_cast<const char*>(prefix), sizeof(prefix));
+    return fnv1a(text, length, hash);
+}
+
+uint64_t glyphKey(FontId font, int pixelSize, uint32_t codepoint) {
+    return (static_cast<uint64_t>(font) << 48) | (static_cast<uint64_t>(pixelSize & 0xFFFF) << 32) | codepoint;
+}
+
+size_t bucketOf(uint64_t hash, size_t mask) {
+    return static_cast<size_t>(hash ^ (hash >> 29)) & mask;
+}
+
+// Decodes one UTF-8 sequence, malformed input yields U+FFFD
+uint32_t decodeUtf8(const unsigned char*& p, const unsigned char* end) {
+    uint32_t c = *p++;
+    if (c < 0x80) {
+        return c;
+    }
+    int extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : (c >= 0xC0) ? 1 : -1;
+    if (extra < 0 || end - p < extra) {
+        return 0xFFFD;
+    }
+    c &= 0x3Fu >> extra;
+    for (int i = 0; i < extra; ++i) {
+        if ((*p & 0xC0) != 0x80) {
+            return 0xFFFD;
+        }
+        c = (c << 6) | (*p++ & 0x3F);
+    }
+    return c;
+}
+
+} // namespace
+
+TextRenderer::TextRenderer(SDL_Renderer* renderer, int atlasSize, size_t layoutCapacity)
+    : m_atlas(renderer, atlasSize), m_layoutCapacity(std::max<size_t>(layoutCapacity, 1)) {
+    m_glyphCache.assign(size_t(1) << GLYPH_CACHE_BITS, GlyphAtlas::NO_GLYPH);
+    // At most half full while the cache is within capacity
+    size_t buckets = 16;
+    while (buckets < m_layoutCapacity * 2) {
+        buckets *= 2;
+    }
+    m_layoutTable.assign(buckets, LayoutBucket{0, NO_LAYOUT});
+}
+
+FontId TextRenderer::addFont(const FontDesc& desc) {
+    m_fonts.push_back(desc);
+    return static_cast<FontId>(m_fonts.size() - 1);
+}
+
+void TextRenderer::beginFrame() {
+    ++m_frame;
+    m_atlas.beginFrame();
+    m_draws.clear();
+}
+
+void TextRenderer::drawText(const char* text, size_t length, FontId font, int pixelSize, float x, float y, SDL_FColor color) {
+    if (length == 0 || font >= m_fonts.size() || pixelSize <= 0) {
+        return;
+    }
+    uint32_t index = findLayout(text, length, font, pixelSize);
+    // Whole pixels keep the filtered glyphs sharp
+    m_draws.push_back(Draw{index, std::floor(x + 0.5f), std::floor(y + 0.5f), color});
+}
+
+SDL_FPoint TextRenderer::measureText(const std::string& text, FontId font, int pixelSize) {
+    if (text.empty() || font >= m_fonts.size() || pixelSize <= 0) {
+        return SDL_FPoint{0.0f, 0.0f};
+    }
+    const Layout& layout = m_layouts[findLayout(text.data(), text.size(), font, pixelSize)];
+    return SDL_FPoint{layout.width, layout.height};
+}
+
+uint32_t TextRenderer::findLayout(const char* text, size_t length, FontId font, int pixelSize) {
+    const uint64_t hash = hashText(text, length, font, pixelSize);
+    uint32_t found = lookupLayout(hash);
+    if (found != NO_LAYOUT) {
+        uint32_t index = found;
+        Layout& layout = m_layouts[index];
+        if (layout.font == font && layout.pixelSize == pixelSize && layout.text.size() == length &&
+            std::memcmp(layout.text.data(), text, length) == 0) {
+            ++m_stats.layoutHits;
+            if (!layout.complete || (layout.atlasEpoch != m_atlas.getEvictionCount() && !glyphsResident(layout))) {
+                buildLayout(layout);
+            } else {
+                // Keep its glyphs from being evicted while queued
+                layout.atlasEpoch = m_atlas.getEvictionCount();
+                for (uint32_t slot : layout.glyphSlots) {
+                    m_atlas.touch(slot);
+                }
+            }
+            layout.lastUsed = m_frame;
+            return index;
+        }
+        // Hash collision: the new string takes over the lookup entry and
+        // the old layout ages out
+    }
+
+    ++m_stats.layoutMisses;
+    uint32_t index = allocateLayout();
+    insertLayout(hash, index);
+    Layout& layout = m_layouts[index];
+    layout.hash = hash;
+    layout.text.assign(text, length);
+    layout.font = font;
+    layout.pixelSize = pixelSize;
+    layout.lastUsed = m_frame;
+    layout.cached = true;
+    buildLayout(layout);
+    return index;
+}
+
+uint32_t TextRenderer::allocateLayout() {
+    if (m_freeLayouts.empty() && m_layouts.size() >= m_layoutCapacity) {
+        evictLayouts();
+    }
+    if (!m_freeLayouts.empty()) {
+        uint32_t index = m_freeLayouts.back();
+        m_freeLayouts.pop_back();
+        return index;
+    }
+    // Past capacity only when one frame draws more distinct strings
+    m_layouts.emplace_back();
+    return static_cast<uint32_t>(m_layouts.size() - 1);
+}
+
+void TextRenderer::evictLayouts() {
+    // Frees the older half of the layouts not drawn this frame. Batching
+    // the eviction keeps the cost per allocation constant without
+    // maintaining an LRU list on every hit.
+    m_stampScratch.clear();
+    for (const Layout& layout : m_layouts) {
+        if (layout.cached && layout.lastUsed != m_frame) {
+            m_stampScratch.push_back(layout.lastUsed);
+        }
+    }
+    if (m_stampScratch.empty()) {
+        return;
+    }
+    auto middle = m_stampScratch.begin() + m_stampScratch.size() / 2;
+    std::nth_element(m_stampScratch.begin(), middle, m_stampScratch.end());
+    const uint32_t threshold = *middle;
+
+    for (uint32_t index = 0; index < m_layouts.size(); ++index) {
+        Layout& layout = m_layouts[index];
+        if (!layout.cached || layout.lastUsed == m_frame || layout.lastUsed > threshold) {
+            continue;
+        }
+        eraseLayout(layout.hash, index);
+        layout.cached = false;
+        m_freeLayouts.push_back(index);
+    }
+}
+
+uint32_t TextRenderer::lookupLayout(uint64_t hash) const {
+    const size_t mask = m_layoutTable.size() - 1;
+    for (size_t i = bucketOf(hash, mask);; i = (i + 1) & mask) {
+        const LayoutBucket& bucket = m_layoutTable[i];
+        if (bucket.layout == NO_LAYOUT || bucket.hash == hash) {
+            return bucket.layout;
+        }
+    }
+}
+
+void TextRenderer::insertLayout(uint64_t hash, uint32_t layout) {
+    if ((m_layoutTableCount + 1) * 2 > m_layoutTable.size()) {
+        growLayoutTable();
+    }
+    const size_t mask = m_layoutTable.size() - 1;
+    for (size_t i = bucketOf(hash, mask);; i = (i + 1) & mask) {
+        LayoutBucket& bucket = m_layoutTable[i];
+        if (bucket.layout == NO_LAYOUT) {
+            bucket = LayoutBucket{hash, layout};
+            ++m_layoutTableCount;
+            return;
+        }
+        if (bucket.hash == hash) {
+            bucket.layout = layout; // Collision takeover
+            return;
+        }
+    }
+}
+
+void TextRenderer::eraseLayout(uint64_t hash, uint32_t layout) {
+    const size_t mask = m_layoutTable.size() - 1;
+    size_t i = bucketOf(hash, mask);
+    while (m_layoutTable[i].layout != NO_LAYOUT && m_layoutTable[i].hash != hash) {
+        i = (i + 1) & mask;
+    }
+    if (m_layoutTable[i].layout != layout) {
+        return; // Not mapped, or the entry was taken over
+    }
+    // Backward shift: pull later entries of the probe run into the hole
+    // unless their home bucket lies after it
+    for (size_t j = (i + 1) & mask; m_layoutTable[j].layout != NO_LAYOUT; j = (j + 1) & mask) {
+        size_t home = bucketOf(m_layoutTable[j].hash, mask);
+        bool staysPut = (i <= j) ? (home > i && home <= j) : (home > i || home <= j);
+        if (!staysPut) {
+            m_layoutTable[i] = m_layoutTable[j];
+            i = j;
+        }
+    }
+    m_layoutTable[i].layout = NO_LAYOUT;
+    --m_layoutTableCount;
+}
+
+void TextRenderer::growLayoutTable() {
+    std::vector<LayoutBucket> old(m_layoutTable.size() * 2, LayoutBucket{0, NO_LAYOUT});
+    old.swap(m_layoutTable);
+    m_layoutTableCount = 0;
+    for (const LayoutBucket& bucket : old) {
+        if (bucket.layout != NO_LAYOUT) {
+            insertLayout(bucket.hash, bucket.layout);
+        }
+    }
+}
+
+bool TextRenderer::glyphsResident(const Layout& layout) const {
+    for (size_t i = 0; i < layout.glyphSlots.size(); ++i) {
+        if (m_atlas.getGeneration(layout.glyphSlots[i]) != layout.glyphGenerations[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t TextRenderer::resolveGlyph(FontId font, int pixelSize, uint32_t codepoint) {
+    const uint64_t key = glyphKey(font, pixelSize, codepoint);
+    uint32_t& cached = m_glyphCache[static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> (64 - GLYPH_CACHE_BITS))];
+    if (cached != GlyphAtlas::NO_GLYPH && m_atlas.getKey(cached) == key) {
+        ++m_stats.glyphHits;
+        m_atlas.touch(cached);
+        return cached;
+    }
+    uint32_t slot = m_atlas.find(key);
+    if (slot != GlyphAtlas::NO_GLYPH) {
+        ++m_stats.glyphHits;
+        cached = slot;
+        return slot;
+    }
+    ++m_stats.glyphMisses;
+
+    const FontDesc& desc = m_fonts[font];
+    m_scratch.width = 0;
+    m_scratch.height = 0;
+    m_scratch.coverage.clear();
+    // Codepoints the font lacks are stored as '?' under their own key, so
+    // they are only rasterized once
+    if (!desc.rasterize || (!desc.rasterize(codepoint, pixelSize, m_scratch) &&
+                            (codepoint == '?' || !desc.rasterize('?', pixelSize, m_scratch)))) {
+        return GlyphAtlas::NO_GLYPH;
+    }
+    slot = m_atlas.insert(key, m_scratch);
+    if (slot != GlyphAtlas::NO_GLYPH) {
+        cached = slot;
+    }
+    return slot;
+}
+
+void TextRenderer::buildLayout(Layout& layout) {
+    layout.quads.clear();
+    layout.glyphSlots.clear();
+    layout.glyphGenerations.clear();
+    layout.complete = true;
+
+    const FontDesc& desc = m_fonts[layout.font];
+    const float size = static_cast<float>(layout.pixelSize);
+    const float lineAdvance = desc.lineHeight * size;
+    float baseline = desc.ascent * size;
+    float penX = 0.0f;
+    float width = 0.0f;
+    int lines = 1;
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(layout.text.data());
+    const unsigned char* end = p + layout.text.size();
+    while (p < end) {
+        uint32_t codepoint = decodeUtf8(p, end);
+        if (codepoint == '\n') {
+            penX = 0.0f;
+            baseline += lineAdvance;
+            ++lines;
+            continue;
+        }
+        uint32_t slot = resolveGlyph(layout.font, layout.pixelSize, codepoint);
+        if (slot == GlyphAtlas::NO_GLYPH) {
+            // Retried on the next draw, the atlas may have room by then
+            layout.complete = false;
+            ++m_stats.droppedGlyphs;
+            continue;
+        }
+        const AtlasGlyph& glyph = m_atlas.getGlyph(slot);
+        if (glyph.width > 0.0f) {
+            float left = penX + glyph.bearingX;
+            float top = baseline - glyph.bearingY;
+            layout.quads.push_back(GlyphQuad{ left, top, left + glyph.width, top + glyph.height,
+                                              glyph.u0, glyph.v0, glyph.u1, glyph.v1 });
+            layout.glyphSlots.push_back(slot);
+            layout.glyphGenerations.push_back(m_atlas.getGeneration(slot));
+        }
+        penX += glyph.advance;
+        width = std::max(width, penX);
+    }
+
+    layout.width = width;
+    layout.height = static_cast<float>(lines) * lineAdvance;
+    // Glyphs found or inserted above are stamped with this frame, so any
+    // eviction during the build cannot have touched them
+    layout.atlasEpoch = m_atlas.getEvictionCount();
+}
+
+SDL_Vertex* TextRenderer::emitQuads(SDL_Vertex* out, const GlyphQuad* quads, size_t count, float x, float y, SDL_FColor color) {
+#ifdef TEXT_USE_SSE2
+    static_assert(sizeof(SDL_Vertex) == 8 * sizeof(float), "SDL_Vertex must be position, color, tex_coord");
+    static_assert(sizeof(GlyphQuad) == 8 * sizeof(float), "GlyphQuad must be two 16-byte halves");
+    // Each vertex is two 16-byte stores: (x, y, r, g) and (b, a, u, v),
+    // shuffled out of the quad's corners, its UVs and the color
+    const __m128 offset = _mm_setr_ps(x, y, x, y);
+    const __m128 rgba = _mm_setr_ps(color.r, color.g, color.b, color.a);
+    const float* in = reinterpret_cast<const float*>(quads);
+    float* dst = reinterpret_cast<float*>(out);
+    for (size_t i = 0; i < count; ++i, in += 8, dst += 32) {
+        __m128 pos = _mm_add_ps(_mm_loadu_ps(in), offset); // left, top, right, bottom
+        __m128 uv = _mm_loadu_ps(in + 4);                  // u0, v0, u1, v1
+        _mm_storeu_ps(dst + 0, _mm_shuffle_ps(pos, rgba, _MM_SHUFFLE(1, 0, 1, 0)));
+        _mm_storeu_ps(dst + 4, _mm_shuffle_ps(rgba, uv, _MM_SHUFFLE(1, 0, 3, 2)));
+        _mm_storeu_ps(dst + 8, _mm_shuffle_ps(pos, rgba, _MM_SHUFFLE(1, 0, 1, 2)));
+        _mm_storeu_ps(dst + 12, _mm_shuffle_ps(rgba, uv, _MM_SHUFFLE(1, 2, 3, 2)));
+        _mm_storeu_ps(dst + 16, _mm_shuffle_ps(pos, rgba, _MM_SHUFFLE(1, 0, 3, 2)));
+        _mm_storeu_ps(dst + 20, _mm_shuffle_ps(rgba, uv, _MM_SHUFFLE(3, 2, 3, 2)));
+        _mm_storeu_ps(dst + 24, _mm_shuffle_ps(pos, rgba, _MM_SHUFFLE(1, 0, 3, 0)));
+        _mm_storeu_ps(dst + 28, _mm_shuffle_ps(rgba, uv, _MM_SHUFFLE(3, 0, 3, 2)));
+    }
+    return out + count * 4;
+#else
+    for (size_t i = 0; i < count; ++i, out += 4) {
+        const GlyphQuad& q = quads[i];
+        float left = q.left + x;
+        float top = q.top + y;
+        float right = q.right + x;
+        float bottom = q.bottom + y;
+        out[0] = SDL_Vertex{ {left, top}, color, {q.u0, q.v0} };
+        out[1] = SDL_Vertex{ {right, top}, color, {q.u1, q.v0} };
+        out[2] = SDL_Vertex{ {right, bottom}, color, {q.u1, q.v1} };
+        out[3] = SDL_Vertex{ {left, bottom}, color, {q.u0, q.v1} };
+    }
+    return out;
+#endif
+}
+
+void TextRenderer::writeVertices(VertexBatch& batch) {
+    m_atlas.upload();
+
+    size_t quadCount = 0;
+    for (const Draw& draw : m_draws) {
+        quadCount += m_layouts[draw.layout].quads.size();
+    }
+    if (quadCount > 0) {
+        SDL_Vertex* out = batch.getQuadVertices(batch.reserveQuads(m_atlas.getTexture(), quadCount));
+        for (const Draw& draw : m_draws) {
+            const Layout& layout = m_layouts[draw.layout];
+            out = emitQuads(out, layout.quads.data(), layout.quads.size(), draw.x, draw.y, draw.color);
+        }
+        m_stats.glyphsDrawn += quadCount;
+    }
+    m_draws.clear();
+}
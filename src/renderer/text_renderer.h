@@ -0,0 +1,138 @@
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include "glyph_atlas.h"
+#include "vertex_batch.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+using FontId = uint16_t;
+
+// A font is anything that can rasterize a codepoint at a pixel size. The
+// metrics are fractions of the pixel size, which is the line height.
+struct FontDesc {
+    std::function<bool(uint32_t codepoint, int pixelSize, GlyphBitmap& out)> rasterize;
+    float ascent = 0.8f; // Line top down to the baseline
+    float lineHeight = 1.0f;
+};
+
+struct TextStats {
+    size_t layoutHits = 0;
+    size_t layoutMisses = 0;
+    size_t glyphHits = 0; // Glyph lookups while building layouts
+    size_t glyphMisses = 0; // Of those, the ones that had to rasterize
+    size_t droppedGlyphs = 0; // Could not be placed in the atlas
+    size_t glyphsDrawn = 0;
+};
+
+// On-screen text drawn through a shared glyph atlas.
+//
+// Laying out a string (UTF-8 decoding, glyph lookup, pen advance) is cached
+// per string hash, font and size, so text that is drawn again costs a hash
+// lookup plus the quad copy. Cached layouts are evicted oldest first once
+// the cache is full. A layout stores its quads ready to emit, so when the
+// atlas evicts a glyph the layouts that used it are re-laid out on their
+// next draw rather than patched.
+//
+// Usage per frame: beginFrame(), any number of drawText() calls, then
+// writeVertices() once to upload new glyphs and emit every queued quad.
+class TextRenderer {
+public:
+    // renderer may be nullptr for headless use
+    explicit TextRenderer(SDL_Renderer* renderer, int atlasSize = 1024, size_t layoutCapacity = 16384);
+
+    FontId addFont(const FontDesc& desc);
+
+    void beginFrame();
+
+    // Queues text with its top left corner at (x, y); '\n' starts a new line
+    void drawText(const char* text, size_t length, FontId font, int pixelSize, float x, float y, SDL_FColor color);
+    void drawText(const std::string& text, FontId font, int pixelSize, float x, float y, SDL_FColor color) {
+        drawText(text.data(), text.size(), font, pixelSize, x, y, color);
+    }
+
+    // Size of the text block, laid out (and cached) like drawText would
+    SDL_FPoint measureText(const std::string& text, FontId font, int pixelSize);
+
+    // Uploads atlas changes and appends every queued glyph quad
+    void writeVertices(VertexBatch& batch);
+
+    const TextStats& getStats() const { return m_stats; }
+    void resetStats() { m_stats = TextStats(); }
+    size_t getCachedLayoutCount() const { return m_layoutTableCount; }
+    const GlyphAtlas& getAtlas() const { return m_atlas; }
+
+private:
+    // Glyph quad relative to the text origin, laid out for 16-byte loads
+    struct GlyphQuad {
+        float left, top, right, bottom;
+        float u0, v0, u1, v1;
+    };
+
+    struct Layout {
+        uint64_t hash = 0;
+        std::string text;
+        FontId font = 0;
+        int pixelSize = 0;
+        uint32_t lastUsed = 0;
+        uint64_t atlasEpoch = 0;
+        bool cached = false;
+        bool complete = false; // False if a glyph was dropped
+        float width = 0.0f;
+        float height = 0.0f;
+        std::vector<GlyphQuad> quads;
+        std::vector<uint32_t> glyphSlots; // Atlas slot per quad
+        std::vector<uint32_t> glyphGenerations;
+    };
+
+    // Open-addressing entry of the layout table, keyed by string hash
+    struct LayoutBucket {
+        uint64_t hash;
+        uint32_t layout;
+    };
+
+    struct Draw {
+        uint32_t layout;
+        float x;
+        float y;
+        SDL_FColor color;
+    };
+
+    uint32_t findLayout(const char* text, size_t length, FontId font, int pixelSize);
+    uint32_t lookupLayout(uint64_t hash) const;
+    void insertLayout(uint64_t hash, uint32_t layout);
+    void eraseLayout(uint64_t hash, uint32_t layout);
+    void growLayoutTable();
+    uint32_t allocateLayout();
+    void evictLayouts();
+    void buildLayout(Layout& layout);
+    bool glyphsResident(const Layout& layout) const;
+    uint32_t resolveGlyph(FontId font, int pixelSize, uint32_t codepoint);
+    static SDL_Vertex* emitQuads(SDL_Vertex* out, const GlyphQuad* quads, size_t count, float x, float y, SDL_FColor color);
+
+    GlyphAtlas m_atlas;
+    std::vector<FontDesc> m_fonts;
+    GlyphBitmap m_scratch;
+
+    // Front cache for atlas lookups while laying out, direct mapped by glyph
+    // key and checked against the atlas slot's current key
+    std::vector<uint32_t> m_glyphCache;
+
+    std::vector<Layout> m_layouts;
+    std::vector<uint32_t> m_freeLayouts;
+    // Linear probing over a flat array keeps hits to one or two cache lines,
+    // which matters with ten thousand lookups a frame
+    std::vector<LayoutBucket> m_layoutTable;
+    size_t m_layoutTableCount = 0;
+    size_t m_layoutCapacity;
+    std::vector<uint32_t> m_stampScratch;
+
+    std::vector<Draw> m_draws;
+    uint32_t m_frame = 1;
+    TextStats m_stats;
+};
+
+#endif // TEXT_RENDERER_H
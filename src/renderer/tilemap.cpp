@@ -0,0 +1,255 @@
+#include "tilemap.h"
+
+#include <algorithm>
+#include <cmath>
+
+Tilemap::Tilemap(int width, int height, int layerCount, float tileSize, const TilesetDesc& tileset, int chunkSize)
+    : m_width(std::max(width, 1)),
+      m_height(std::max(height, 1)),
+      m_layerCount(std::max(layerCount, 1)),
+      m_tileSize(tileSize),
+      m_tileset(tileset),
+      m_chunkSize(std::max(chunkSize, 1)) {
+    m_chunksX = (m_width + m_chunkSize - 1) / m_chunkSize;
+    m_chunksY = (m_height + m_chunkSize - 1) / m_chunkSize;
+    m_layers.assign(m_layerCount, std::vector<TileId>(static_cast<size_t>(m_width) * m_height, 0));
+    m_chunks.resize(static_cast<size_t>(m_chunksX) * m_chunksY);
+}
+
+void Tilemap::setTile(int layer, int x, int y, TileId tile) {
+    if (layer < 0 || layer >= m_layerCount || x < 0 || y < 0 || x >= m_width || y >= m_height) {
+        return;
+    }
+    TileId& cell = m_layers[layer][static_cast<size_t>(y) * m_width + x];
+    if (cell == tile) {
+        return;
+    }
+    cell = tile;
+    m_chunks[static_cast<size_t>(y / m_chunkSize) * m_chunksX + x / m_chunkSize].dirty = true;
+}
+
+TileId Tilemap::getTile(int layer, int x, int y) const {
+    if (layer < 0 || layer >= m_layerCount || x < 0 || y < 0 || x >= m_width || y >= m_height) {
+        return 0;
+    }
+    return m_layers[layer][static_cast<size_t>(y) * m_width + x];
+}
+
+void Tilemap::setTileAnimation(TileId tile, const std::vector<uint16_t>& atlasFrames, float frameDuration) {
+    if (tile == 0 || atlasFrames.empty()) {
+        return;
+    }
+    if (tile >= m_animationOfTile.size()) {
+        m_animationOfTile.resize(static_cast<size_t>(tile) + 1, -1);
+        m_currentUv.resize(static_cast<size_t>(tile) + 1);
+    }
+    int index = m_animationOfTile[tile];
+    if (index < 0) {
+        index = static_cast<int>(m_animations.size());
+        m_animations.push_back(Animation());
+        m_animationOfTile[tile] = index;
+        // The tile moves from baked to animated quads everywhere it is used
+        markAllDirty();
+    }
+    m_animations[index].frames = atlasFrames;
+    m_animations[index].frameDuration = std::max(frameDuration, 1e-3f);
+    m_currentUv[tile] = atlasUv(atlasFrames[0]);
+}
+
+void Tilemap::update(float dt) {
+    m_time += dt;
+    // Only the indirection table changes, cached chunk geometry stays put
+    for (size_t tile = 0; tile < m_animationOfTile.size(); ++tile) {
+        int index = m_animationOfTile[tile];
+        if (index < 0) {
+            continue;
+        }
+        const Animation& animation = m_animations[index];
+        size_t frame = static_cast<size_t>(m_time / animation.frameDuration) % animation.frames.size();
+        m_currentUv[tile] = atlasUv(animation.frames[frame]);
+    }
+}
+
+Tilemap::UvRect Tilemap::atlasUv(uint16_t atlasIndex) const {
+    const float du = 1.0f / static_cast<float>(m_tileset.columns);
+    const float dv = 1.0f / static_cast<float>(m_tileset.rows);
+    float u0 = static_cast<float>(atlasIndex % m_tileset.columns) * du;
+    float v0 = static_cast<float>(atlasIndex / m_tileset.columns) * dv;
+    return UvRect{u0, v0, u0 + du, v0 + dv};
+}
+
+void Tilemap::markAllDirty() {
+    for (Chunk& chunk : m_chunks) {
+        chunk.dirty = true;
+    }
+}
+
+size_t Tilemap::countQuads(const Chunk& chunk, const VisibleChunk& visible) const {
+    size_t count = 0;
+    for (int layer = 0; layer < m_layerCount; ++layer) {
+        const size_t base = static_cast<size_t>(layer) * (m_chunkSize + 1);
+        const uint32_t staticBegin = chunk.staticRowStart[base + visible.row0];
+        const uint32_t staticEnd = chunk.staticRowStart[base + visible.row1 + 1];
+        const uint32_t animatedBegin = chunk.animatedRowStart[base + visible.row0];
+        const uint32_t animatedEnd = chunk.animatedRowStart[base + visible.row1 + 1];
+        if (!visible.clipColumns) {
+            count += (staticEnd - staticBegin) + (animatedEnd - animatedBegin);
+            continue;
+        }
+        for (uint32_t q = staticBegin; q < staticEnd; ++q) {
+            float x = chunk.staticQuads[q].x;
+            count += (x >= visible.minX && x <= visible.maxX) ? 1 : 0;
+        }
+        for (uint32_t a = animatedBegin; a < animatedEnd; ++a) {
+            float x = chunk.animatedQuads[a].x;
+            count += (x >= visible.minX && x <= visible.maxX) ? 1 : 0;
+        }
+    }
+    return count;
+}
+
+void Tilemap::rebuildChunk(int chunkX, int chunkY) {
+    Chunk& chunk = m_chunks[static_cast<size_t>(chunkY) * m_chunksX + chunkX];
+    chunk.staticQuads.clear();
+    chunk.animatedQuads.clear();
+    chunk.staticRowStart.resize(static_cast<size_t>(m_layerCount) * (m_chunkSize + 1));
+    chunk.animatedRowStart.resize(chunk.staticRowStart.size());
+
+    const int x0 = chunkX * m_chunkSize;
+    const int y0 = chunkY * m_chunkSize;
+    const int x1 = std::min(x0 + m_chunkSize, m_width);
+    const int y1 = std::min(y0 + m_chunkSize, m_height);
+
+    for (int layer = 0; layer < m_layerCount; ++layer) {
+        const std::vector<TileId>& tiles = m_layers[layer];
+        uint32_t* staticRows = chunk.staticRowStart.data() + static_cast<size_t>(layer) * (m_chunkSize + 1);
+        uint32_t* animatedRows = chunk.animatedRowStart.data() + static_cast<size_t>(layer) * (m_chunkSize + 1);
+
+        for (int row = 0; row < m_chunkSize; ++row) {
+            staticRows[row] = static_cast<uint32_t>(chunk.staticQuads.size());
+            animatedRows[row] = static_cast<uint32_t>(chunk.animatedQuads.size());
+            const int y = y0 + row;
+            if (y >= y1) {
+                continue; // Past the map edge, the row stays empty
+            }
+            for (int x = x0; x < x1; ++x) {
+                TileId tile = tiles[static_cast<size_t>(y) * m_width + x];
+                if (tile == 0) {
+                    continue;
+                }
+                // Positions are local to the chunk origin
+                float left = static_cast<float>(x - x0) * m_tileSize;
+                float top = static_cast<float>(row) * m_tileSize;
+                if (tile < m_animationOfTile.size() && m_animationOfTile[tile] >= 0) {
+                    chunk.animatedQuads.push_back(AnimatedQuad{left, top, tile});
+                    continue;
+                }
+                UvRect uv = atlasUv(static_cast<uint16_t>(tile - 1));
+                chunk.staticQuads.push_back(StaticQuad{left, top, uv.u0, uv.v0});
+            }
+        }
+        staticRows[m_chunkSize] = static_cast<uint32_t>(chunk.staticQuads.size());
+        animatedRows[m_chunkSize] = static_cast<uint32_t>(chunk.animatedQuads.size());
+    }
+    chunk.dirty = false;
+}
+
+void Tilemap::render(VertexBatch& batch, const Camera2D& camera) {
+    m_visibleChunks = 0;
+    m_rebuiltChunks = 0;
+    m_visibleList.clear();
+
+    // Chunk range overlapping the camera rectangle
+    const float chunkPixels = m_tileSize * static_cast<float>(m_chunkSize);
+    int cx0 = std::max(0, static_cast<int>(std::floor(camera.getLeft() / chunkPixels)));
+    int cy0 = std::max(0, static_cast<int>(std::floor(camera.getTop() / chunkPixels)));
+    int cx1 = std::min(m_chunksX - 1, static_cast<int>(std::floor(camera.getRight() / chunkPixels)));
+    int cy1 = std::min(m_chunksY - 1, static_cast<int>(std::floor(camera.getBottom() / chunkPixels)));
+    // Tile rows and columns overlapping the view, clipped per chunk below
+    const int tileRow0 = static_cast<int>(std::floor(camera.getTop() / m_tileSize));
+    const int tileRow1 = static_cast<int>(std::floor(camera.getBottom() / m_tileSize));
+    const int tileCol0 = static_cast<int>(std::floor(camera.getLeft() / m_tileSize));
+    const int tileCol1 = static_cast<int>(std::floor(camera.getRight() / m_tileSize));
+
+    size_t quadCount = 0;
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        const int row0 = std::max(tileRow0 - cy * m_chunkSize, 0);
+        const int row1 = std::min(tileRow1 - cy * m_chunkSize, m_chunkSize - 1);
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            int index = cy * m_chunksX + cx;
+            // Dirty chunks off screen wait until they are actually seen
+            if (m_chunks[index].dirty) {
+                rebuildChunk(cx, cy);
+                ++m_rebuiltChunks;
+            }
+            const int col0 = std::max(tileCol0 - cx * m_chunkSize, 0);
+            const int col1 = std::min(tileCol1 - cx * m_chunkSize, m_chunkSize - 1);
+            // Half a tile of slack so the corner comparison is exact
+            VisibleChunk visible = { index, row0, row1, col0 > 0 || col1 < m_chunkSize - 1,
+                                     (static_cast<float>(col0) - 0.5f) * m_tileSize,
+                                     (static_cast<float>(col1) + 0.5f) * m_tileSize };
+            size_t chunkQuads = countQuads(m_chunks[index], visible);
+            if (chunkQuads > 0) {
+                m_visibleList.push_back(visible);
+                quadCount += chunkQuads;
+            }
+        }
+    }
+    m_visibleChunks = static_cast<int>(m_visibleList.size());
+    if (quadCount == 0) {
+        return;
+    }
+
+    size_t firstQuad = batch.reserveQuads(m_tileset.texture, quadCount);
+    SDL_Vertex* out = batch.getQuadVertices(firstQuad);
+    const float zoom = camera.zoom;
+    const float scaledTile = m_tileSize * zoom;
+    const float du = 1.0f / static_cast<float>(m_tileset.columns);
+    const float dv = 1.0f / static_cast<float>(m_tileset.rows);
+    const SDL_FColor white = {1.0f, 1.0f, 1.0f, 1.0f};
+
+    for (const VisibleChunk& visible : m_visibleList) {
+        const Chunk& chunk = m_chunks[visible.index];
+        const float originX = (static_cast<float>(visible.index % m_chunksX) * chunkPixels - camera.x) * zoom;
+        const float originY = (static_cast<float>(visible.index / m_chunksX) * chunkPixels - camera.y) * zoom;
+
+        for (int layer = 0; layer < m_layerCount; ++layer) {
+            const size_t base = static_cast<size_t>(layer) * (m_chunkSize + 1);
+
+            // Cached quads only need the camera applied
+            const uint32_t staticBegin = chunk.staticRowStart[base + visible.row0];
+            const uint32_t staticEnd = chunk.staticRowStart[base + visible.row1 + 1];
+            for (uint32_t q = staticBegin; q < staticEnd; ++q) {
+                const StaticQuad& quad = chunk.staticQuads[q];
+                if (visible.clipColumns && (quad.x < visible.minX || quad.x > visible.maxX)) {
+                    continue;
+                }
+                float left = originX + quad.x * zoom;
+                float top = originY + quad.y * zoom;
+                out[0] = SDL_Vertex{ {left, top}, white, {quad.u0, quad.v0} };
+                out[1] = SDL_Vertex{ {left + scaledTile, top}, white, {quad.u0 + du, quad.v0} };
+                out[2] = SDL_Vertex{ {left + scaledTile, top + scaledTile}, white, {quad.u0 + du, quad.v0 + dv} };
+                out[3] = SDL_Vertex{ {left, top + scaledTile}, white, {quad.u0, quad.v0 + dv} };
+                out += 4;
+            }
+
+            // Animated quads take their UVs from the indirection table
+            const uint32_t animatedBegin = chunk.animatedRowStart[base + visible.row0];
+            const uint32_t animatedEnd = chunk.animatedRowStart[base + visible.row1 + 1];
+            for (uint32_t a = animatedBegin; a < animatedEnd; ++a) {
+                const AnimatedQuad& quad = chunk.animatedQuads[a];
+                if (visible.clipColumns && (quad.x < visible.minX || quad.x > visible.maxX)) {
+                    continue;
+                }
+                const UvRect& uv = m_currentUv[quad.tile];
+                float left = originX + quad.x * zoom;
+                float top = originY + quad.y * zoom;
+                out[0] = SDL_Vertex{ {left, top}, white, {uv.u0, uv.v0} };
+                out[1] = SDL_Vertex{ {left + scaledTile, top}, white, {uv.u1, uv.v0} };
+                out[2] = SDL_Vertex{ {left + scaledTile, top + scaledTile}, white, {uv.u1, uv.v1} };
+                out[3] = SDL_Vertex{ {left, top + scaledTile}, white, {uv.u0, uv.v1} };
+                out += 4;
+            }
+        }
+    }
+}
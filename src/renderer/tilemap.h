@@ -0,0 +1,125 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include "camera.h"
+#include "vertex_batch.h"
+
+#include <cstdint>
+#include <vector>
+
+// Tile ids index the tileset atlas, offset by one: id 0 is an empty cell
+// and id n shows atlas tile n - 1 unless an animation is bound to it.
+using TileId = uint16_t;
+
+struct TilesetDesc {
+    SDL_Texture* texture = nullptr;
+    int columns = 1; // Atlas size in tiles
+    int rows = 1;
+};
+
+// Multi-layer tile map split into square chunks.
+//
+// Each chunk bakes its quads once, as a chunk-local corner plus resolved
+// atlas UV, and keeps them until an edit marks it dirty. Empty cells, layer
+// walks and atlas lookups are all paid at rebuild time. Animated tiles are
+// cached as a corner plus tile id and pick their current frame through a
+// per-id UV table, so advancing animations never rebuilds a chunk.
+// Rendering culls chunks and rows against the camera and expands the cached
+// quads of visible ones into a VertexBatch; the SDL renderer has no vertex
+// transform, so that pass applies the camera offset and zoom. The records
+// are 16 bytes rather than four full vertices, which keeps the pass from
+// being bound by reading back its own cache.
+class Tilemap {
+public:
+    Tilemap(int width, int height, int layerCount, float tileSize, const TilesetDesc& tileset, int chunkSize = 32);
+
+    void setTile(int layer, int x, int y, TileId tile);
+    TileId getTile(int layer, int x, int y) const;
+
+    // Cycles tile through atlas frames (zero-based atlas indices)
+    void setTileAnimation(TileId tile, const std::vector<uint16_t>& atlasFrames, float frameDuration);
+    void update(float dt);
+
+    // Rebuilds dirty visible chunks and appends visible quads to batch
+    void render(VertexBatch& batch, const Camera2D& camera);
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    int getChunkCount() const { return m_chunksX * m_chunksY; }
+    // Stats from the last render call
+    int getVisibleChunkCount() const { return m_visibleChunks; }
+    int getRebuiltChunkCount() const { return m_rebuiltChunks; }
+
+private:
+    struct UvRect {
+        float u0, v0, u1, v1;
+    };
+
+    struct StaticQuad {
+        float x; // Chunk-local top left corner
+        float y;
+        float u0; // Atlas top left, the extent is the same for every tile
+        float v0;
+    };
+
+    struct AnimatedQuad {
+        float x;
+        float y;
+        TileId tile;
+    };
+
+    // Quads are stored layer by layer, row by row. Row r of layer l starts
+    // at rowStart[l * (chunkSize + 1) + r], so a partly visible chunk only
+    // copies the rows inside the view.
+    struct Chunk {
+        bool dirty = true;
+        std::vector<StaticQuad> staticQuads;
+        std::vector<AnimatedQuad> animatedQuads;
+        std::vector<uint32_t> staticRowStart;
+        std::vector<uint32_t> animatedRowStart;
+    };
+
+    struct Animation {
+        std::vector<uint16_t> frames;
+        float frameDuration;
+    };
+
+    UvRect atlasUv(uint16_t atlasIndex) const;
+    void rebuildChunk(int chunkX, int chunkY);
+    void markAllDirty();
+    struct VisibleChunk;
+    size_t countQuads(const Chunk& chunk, const VisibleChunk& visible) const;
+
+    int m_width;
+    int m_height;
+    int m_layerCount;
+    float m_tileSize;
+    TilesetDesc m_tileset;
+    int m_chunkSize;
+    int m_chunksX;
+    int m_chunksY;
+
+    std::vector<std::vector<TileId>> m_layers;
+    std::vector<Chunk> m_chunks;
+
+    // Indirection for animated tiles: animation per tile id, and the UV
+    // of each id's current frame, refreshed by update()
+    std::vector<int> m_animationOfTile;
+    std::vector<Animation> m_animations;
+    std::vector<UvRect> m_currentUv;
+    float m_time = 0.0f;
+
+    int m_visibleChunks = 0;
+    int m_rebuiltChunks = 0;
+    struct VisibleChunk {
+        int index;
+        int row0; // Visible local rows, inclusive
+        int row1;
+        bool clipColumns; // Only set on chunks cut by the view's sides
+        float minX; // Chunk-local corner range of visible columns
+        float maxX;
+    };
+    std::vector<VisibleChunk> m_visibleList;
+};
+
+#endif // TILEMAP_H
@@ -0,0 +1,71 @@
+#include "vertex_batch.h"
+
+#include <algorithm>
+#include <cstring>
+
+size_t VertexBatch::reserveQuads(SDL_Texture* texture, size_t quadCount) {
+    size_t firstQuad = getQuadCount();
+    if (quadCount == 0) {
+        return firstQuad;
+    }
+    size_t needed = m_vertexCount + quadCount * 4;
+    if (needed > m_vertexCapacity) {
+        size_t capacity = std::max(needed, m_vertexCapacity * 2);
+        std::unique_ptr<SDL_Vertex[]> storage(new SDL_Vertex[capacity]);
+        if (m_vertexCount > 0) {
+            std::memcpy(storage.get(), m_vertices.get(), m_vertexCount * sizeof(SDL_Vertex));
+        }
+        m_vertices = std::move(storage);
+        m_vertexCapacity = capacity;
+    }
+    m_vertexCount = needed;
+
+    // Consecutive reservations with the same texture share one draw call
+    if (!m_runs.empty() && m_runs.back().texture == texture) {
+        m_runs.back().quadCount += quadCount;
+    } else {
+        m_runs.push_back(Run{texture, firstQuad, quadCount});
+    }
+    return firstQuad;
+}
+
+void VertexBatch::growIndices(size_t quadCount) {
+    size_t existing = m_indices.size() / 6;
+    if (existing >= quadCount) {
+        return;
+    }
+    // Indices are relative to the first vertex of a run, so one growing
+    // pattern serves every run
+    m_indices.resize(quadCount * 6);
+    for (size_t q = existing; q < quadCount; ++q) {
+        int base = static_cast<int>(q * 4);
+        int* idx = &m_indices[q * 6];
+        idx[0] = base;
+        idx[1] = base + 1;
+        idx[2] = base + 2;
+        idx[3] = base + 2;
+        idx[4] = base + 3;
+        idx[5] = base;
+    }
+}
+
+void VertexBatch::flush(SDL_Renderer* renderer) {
+    size_t largestRun = 0;
+    for (const Run& run : m_runs) {
+        largestRun = std::max(largestRun, run.quadCount);
+    }
+    growIndices(largestRun);
+
+    for (const Run& run : m_runs) {
+        SDL_RenderGeometry(renderer, run.texture,
+                           m_vertices.get() + run.firstQuad * 4, static_cast<int>(run.quadCount * 4),
+                           m_indices.data(), static_cast<int>(run.quadCount * 6));
+    }
+    clear();
+}
+
+void VertexBatch::clear() {
+    // Keep the capacity, the next frame is usually about the same size
+    m_vertexCount = 0;
+    m_runs.clear();
+}
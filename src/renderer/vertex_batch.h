@@ -0,0 +1,54 @@
+#ifndef VERTEX_BATCH_H
+#define VERTEX_BATCH_H
+
+#include <SDL3/SDL.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Frame-wide stream of textured quads. Systems reserve space, fill the
+// vertices directly (from worker threads if they like) and the whole stream
+// is drawn with one SDL_RenderGeometry call per texture run.
+//
+// Quad vertices are expected in the order top-left, top-right,
+// bottom-right, bottom-left; the index pattern is shared by every quad.
+class VertexBatch {
+public:
+    VertexBatch() = default;
+
+    // Reserves quadCount quads drawn with texture (nullptr for untextured)
+    // and returns the index of the first one. Reserving may move the vertex
+    // storage, so fetch pointers with getQuadVertices only after all
+    // reservations for the frame are done.
+    size_t reserveQuads(SDL_Texture* texture, size_t quadCount);
+
+    // Four vertices per quad, starting at firstQuad
+    SDL_Vertex* getQuadVertices(size_t firstQuad) { return m_vertices.get() + firstQuad * 4; }
+
+    // Draws every run in reservation order and empties the batch
+    void flush(SDL_Renderer* renderer);
+    void clear();
+
+    size_t getQuadCount() const { return m_vertexCount / 4; }
+    size_t getDrawCallCount() const { return m_runs.size(); }
+
+private:
+    void growIndices(size_t quadCount);
+
+    struct Run {
+        SDL_Texture* texture;
+        size_t firstQuad;
+        size_t quadCount;
+    };
+
+    // Raw storage rather than a vector so growing does not zero-fill
+    // vertices that are about to be overwritten anyway
+    std::unique_ptr<SDL_Vertex[]> m_vertices;
+    size_t m_vertexCount = 0;
+    size_t m_vertexCapacity = 0;
+    std::vector<int> m_indices;
+    std::vector<Run> m_runs;
+};
+
+#endif // VERTEX_BATCH_H
@@ -0,0 +1,90 @@
+#include "../src/coro/scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Resume cost of the coroutine scheduler with many live tasks: every task
+// yields each frame, or sleeps for a random time. Frames are allocated in
+// spawn order, or shuffled so that the resume order jumps around memory
+// the way it does after tasks have come and gone for a while.
+// Usage: coro_bench [tasks] [frames]
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// A little per-task state, as gameplay code would have
+static Task<void> ticker(Scheduler& scheduler, uint64_t& sink, uint32_t seed) {
+    uint32_t state = seed;
+    for (;;) {
+        state = state * 1664525u + 1013904223u;
+        sink += state >> 24;
+        co_await scheduler.nextFrame();
+    }
+}
+
+static Task<void> sleeper(Scheduler& scheduler, uint64_t& sink, uint32_t seed) {
+    uint32_t state = seed;
+    for (;;) {
+        state = state * 1664525u + 1013904223u;
+        sink += state >> 24;
+        co_await scheduler.wait(static_cast<float>(state >> 8) * (1.0f / 16777216.0f));
+    }
+}
+
+template <typename MakeTask>
+static void run(const char* name, size_t taskCount, int frames, bool shuffle, MakeTask makeTask) {
+    Scheduler scheduler;
+    uint64_t sink = 0;
+    std::vector<Task<void>> tasks;
+    tasks.reserve(taskCount);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < taskCount; ++i) {
+        tasks.push_back(makeTask(scheduler, sink, static_cast<uint32_t>(i)));
+    }
+    if (shuffle) {
+        std::shuffle(tasks.begin(), tasks.end(), std::mt19937(1234));
+    }
+    for (Task<void>& task : tasks) {
+        scheduler.spawn(std::move(task));
+    }
+    double spawnMs = elapsedMs(start);
+
+    // Warm-up frame starts every task
+    scheduler.update(1.0f / 60.0f);
+    size_t resumes = 0;
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        scheduler.update(1.0f / 60.0f);
+        resumes += scheduler.getResumeCount();
+    }
+    double updateMs = elapsedMs(start);
+
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(9) << updateMs / frames << " ms/frame" << std::setw(9) << resumes / frames << " resumes"
+              << std::setw(8) << std::setprecision(1) << updateMs * 1e6 / static_cast<double>(std::max<size_t>(resumes, 1))
+              << " ns/resume" << std::setw(8) << spawnMs * 1e6 / static_cast<double>(taskCount) << " ns/spawn"
+              << "  (" << (sink & 1) << ")\n";
+}
+
+int main(int argc, char const *argv[])
+{
+    const size_t taskCount = (argc > 1) ? static_cast<size_t>(std::atoi(argv[1])) : 100000;
+    const int frames = (argc > 2) ? std::atoi(argv[2]) : 100;
+
+    std::cout << taskCount << " live tasks, " << frames << " frames\n";
+    run("nextFrame, spawn order", taskCount, frames, false, ticker);
+    run("nextFrame, shuffled", taskCount, frames, true, ticker);
+    run("wait(0..1 s), spawn order", taskCount, frames, false, sleeper);
+    run("wait(0..1 s), shuffled", taskCount, frames, true, sleeper);
+
+    FramePoolStats stats = getFramePoolStats();
+    std::cout << "frame pool: " << stats.pooledBytes / 1024 << " KB in chunks, " << stats.heapFrames
+              << " frames from the heap\n";
+    return 0;
+}
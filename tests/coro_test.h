@@ -0,0 +1,168 @@
+#ifndef CORO_TEST_H
+#define CORO_TEST_H
+
+#include "../src/coro/scheduler.h"
+#include "../src/log/log.h"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+Task<void> countFrames(Scheduler& scheduler, int& frames, int limit) {
+    while (frames < limit) {
+        co_await scheduler.nextFrame();
+        ++frames;
+    }
+}
+
+Task<int> waitAndReturn(Scheduler& scheduler, float seconds, int value) {
+    co_await scheduler.wait(seconds);
+    co_return value;
+}
+
+// Waits on a nested task, then on several at once, recording the frame at
+// which each step finished
+Task<void> waitSteps(Scheduler& scheduler, std::vector<uint64_t>& frames, std::vector<int>& results) {
+    results.push_back(co_await waitAndReturn(scheduler, 0.5f, 7));
+    frames.push_back(scheduler.getFrame());
+
+    std::vector<Task<int>> tasks;
+    tasks.push_back(waitAndReturn(scheduler, 0.375f, 1));
+    tasks.push_back(waitAndReturn(scheduler, 0.0f, 2));
+    tasks.push_back(waitAndReturn(scheduler, 0.125f, 3));
+    for (int value : co_await whenAll(std::move(tasks))) {
+        results.push_back(value);
+    }
+    frames.push_back(scheduler.getFrame());
+}
+
+Task<void> loadAsset(Scheduler& scheduler, std::shared_ptr<AssetLoad> load, size_t& bytes) {
+    AssetLoad& loaded = co_await scheduler.waitFor(load);
+    bytes = loaded.succeeded ? loaded.data.size() : 0;
+}
+
+Task<void> throwAfterFrame(Scheduler& scheduler) {
+    co_await scheduler.nextFrame();
+    throw std::runtime_error("task failed");
+}
+
+Task<void> waitForever(Scheduler& scheduler) {
+    co_await waitAndReturn(scheduler, 1e9f, 0);
+}
+
+// Frame counting, waits, nesting and whenAll on a fixed 1/8 s step, which
+// keeps the clock exact
+int testCoroutineWaits() {
+    Scheduler scheduler;
+    int frames = 0;
+    scheduler.spawn(countFrames(scheduler, frames, 3));
+    std::vector<uint64_t> stepFrames;
+    std::vector<int> results;
+    scheduler.spawn(waitSteps(scheduler, stepFrames, results));
+    if (scheduler.getTaskCount() != 2) {
+        return 80;
+    }
+    for (int i = 0; i < 12; ++i) {
+        scheduler.update(0.125f);
+    }
+    // Started in update 1, then resumed in updates 2, 3 and 4
+    if (frames != 3) {
+        return 81;
+    }
+    // Started in update 1, so the half second wait ends in update 5. whenAll
+    // then finishes with its longest task, three updates later.
+    if (stepFrames.size() != 2 || stepFrames[0] != 5 || stepFrames[1] != 8) {
+        LOG_ERROR("Waits finished in the wrong frames");
+        return 82;
+    }
+    if (results != std::vector<int>{7, 1, 2, 3}) {
+        return 83;
+    }
+    if (scheduler.getTaskCount() != 0) {
+        return 84;
+    }
+    return 0;
+}
+
+// Loads completed on another thread, and exceptions leaving a task
+int testCoroutineSignals() {
+    Scheduler scheduler;
+    std::shared_ptr<AssetLoad> load = std::make_shared<AssetLoad>();
+    size_t bytes = 0;
+    scheduler.spawn(loadAsset(scheduler, load, bytes));
+    std::thread loader([load] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        load->data.assign(64, 0xAB);
+        load->complete(true);
+    });
+    for (int i = 0; i < 1000 && scheduler.getTaskCount() != 0; ++i) {
+        scheduler.update(0.016f);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    loader.join();
+    if (bytes != 64) {
+        return 85;
+    }
+
+    scheduler.spawn(throwAfterFrame(scheduler));
+    scheduler.update(0.016f);
+    bool thrown = false;
+    try {
+        scheduler.update(0.016f);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    if (!thrown || scheduler.getTaskCount() != 0) {
+        return 86;
+    }
+    return 0;
+}
+
+// Frames go back to the pool when tasks finish or the scheduler goes away
+int testCoroutineFrames() {
+    const size_t liveBefore = getFramePoolStats().liveFrames;
+    {
+        Scheduler scheduler;
+        int frames = 0;
+        for (int i = 0; i < 1000; ++i) {
+            scheduler.spawn(countFrames(scheduler, frames, 0));
+        }
+        scheduler.update(0.016f);
+        const size_t pooled = getFramePoolStats().pooledBytes;
+        if (getFramePoolStats().liveFrames != liveBefore) {
+            return 87;
+        }
+        // Reuses the frames just freed
+        for (int i = 0; i < 1000; ++i) {
+            scheduler.spawn(countFrames(scheduler, frames, 0));
+        }
+        scheduler.update(0.016f);
+        if (getFramePoolStats().pooledBytes != pooled) {
+            return 88;
+        }
+        for (int i = 0; i < 100; ++i) {
+            scheduler.spawn(waitForever(scheduler));
+        }
+        scheduler.update(0.016f);
+    }
+    if (getFramePoolStats().liveFrames != liveBefore) {
+        return 89;
+    }
+    return 0;
+}
+
+int test_coroutines() {
+    int result = testCoroutineWaits();
+    if (result != 0) {
+        return result;
+    }
+    result = testCoroutineSignals();
+    if (result != 0) {
+        return result;
+    }
+    return testCoroutineFrames();
+}
+
+#endif // CORO_TEST_H
@@ -0,0 +1,128 @@
+#include "../src/log/log.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Cost of a log call at the call site and end to end, against writing the
+// same lines synchronously through iostream with std::endl, the way engine
+// code used to. Everything goes to files in the temp directory.
+//
+// The call site is timed in short bursts right after a flush, while the
+// writer sleeps, so it is the cost of the call alone even on one core.
+// The end to end runs log more than the writer keeps up with, and include
+// the time to get everything on disk.
+// Usage: log_bench [messages] [threads]
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Runs log calls on threads threads; returns the mean ns per call seen by
+// the callers and sets totalMs to the time until all of it is written
+static double runLogged(size_t messages, size_t threads, double& totalMs) {
+    std::vector<double> callNs(threads, 0.0);
+    std::vector<std::thread> workers;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            const size_t count = messages / threads;
+            const auto begin = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < count; ++i) {
+                LOG_INFO("frame {} entity {} at {} {} state {}", i, t, 0.5 * i, -1.25, "moving");
+            }
+            callNs[t] = elapsedMs(begin) * 1e6 / count;
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    flushLog();
+    totalMs = elapsedMs(start);
+    double mean = 0.0;
+    for (double ns : callNs) {
+        mean += ns / threads;
+    }
+    return mean;
+}
+
+static double runIostream(const std::string& path, size_t messages, bool endl) {
+    std::ofstream file(path);
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < messages; ++i) {
+        file << "frame " << i << " entity " << 0 << " at " << 0.5 * i << " " << -1.25 << " state " << "moving";
+        if (endl) {
+            file << std::endl;
+        } else {
+            file << '\n';
+        }
+    }
+    file.flush();
+    return elapsedMs(start);
+}
+
+// Mean ns per call of log, in bursts small enough for one ring
+template <typename Log>
+static double callSiteNs(Log log) {
+    const size_t rounds = 200;
+    const size_t burst = 2048;
+    double totalMs = 0.0;
+    for (size_t round = 0; round < rounds; ++round) {
+        flushLog();
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < burst; ++i) {
+            log(i);
+        }
+        totalMs += elapsedMs(start);
+    }
+    return totalMs * 1e6 / (rounds * burst);
+}
+
+static void report(const char* name, size_t messages, double callNs, double totalMs) {
+    std::cout << "  " << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << callNs << " ns/call" << std::setprecision(2) << std::setw(8)
+              << messages / (totalMs * 1000.0) << " M lines/s\n";
+}
+
+int main(int argc, char const *argv[])
+{
+    const size_t messages = (argc > 1) ? static_cast<size_t>(std::atoi(argv[1])) : 1000000;
+    const size_t threads = (argc > 2) ? static_cast<size_t>(std::atoi(argv[2])) : 4;
+    const std::string path = (std::filesystem::temp_directory_path() / "game_engine_log_bench.txt").string();
+    std::cout << messages << " messages, " << threads << " threads\n";
+
+    const double endlMs = runIostream(path, messages, true);
+    report("iostream, std::endl", messages, endlMs * 1e6 / messages, endlMs);
+    const double newlineMs = runIostream(path, messages, false);
+    report("iostream, '\\n'", messages, newlineMs * 1e6 / messages, newlineMs);
+    std::filesystem::remove(path);
+
+    LogConfig config;
+    config.console = false;
+    config.filePath = path;
+    config.maxFileBytes = size_t(1) << 30;
+    configureLog(config);
+    const double oneArgNs = callSiteNs([](size_t i) { LOG_INFO("frame {}", i); });
+    const double fiveArgNs = callSiteNs([](size_t i) {
+        LOG_INFO("frame {} entity {} at {} {} state {}", i, 7, 0.5 * i, -1.25, "moving");
+    });
+    std::cout << "  log call site: " << std::setprecision(1) << oneArgNs << " ns with one integer, " << fiveArgNs
+              << " ns with the five arguments above\n";
+
+    for (size_t threadCount : {size_t(1), threads}) {
+        const uint64_t waits = getLogStats().waits;
+        double totalMs = 0.0;
+        const double callNs = runLogged(messages, threadCount, totalMs);
+        const std::string name = "log, " + std::to_string(threadCount) + " thread" + (threadCount > 1 ? "s" : "");
+        report(name.c_str(), messages, callNs, totalMs);
+        std::cout << "    " << getLogStats().waits - waits << " waits for a full ring\n";
+    }
+    configureLog(LogConfig());
+    std::filesystem::remove(path);
+    return 0;
+}
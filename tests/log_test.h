@@ -0,0 +1,258 @@
+#ifndef LOG_TEST_H
+#define LOG_TEST_H
+
+#include "../src/log/log.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Message text of every line in the file, without the time and level
+std::vector<std::string> readLogMessages(const std::string& path) {
+    std::vector<std::string> messages;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        // "<seconds> <level, 5 wide> <message>"
+        const size_t level = line.find_first_not_of(' ', line.find(' ', line.find_first_not_of(' ')));
+        messages.push_back(level == std::string::npos ? std::string() : line.substr(level + 6));
+    }
+    return messages;
+}
+
+std::string logTestPath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+void removeLogFiles(const std::string& path, int rotated) {
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    for (int i = 1; i <= rotated; ++i) {
+        std::filesystem::remove(path + "." + std::to_string(i), error);
+    }
+}
+
+// Arguments of every supported type come out as iostream would print them
+int testLogFormatting() {
+    const std::string path = logTestPath("game_engine_log_format.txt");
+    removeLogFiles(path, 0);
+    LogConfig config;
+    config.console = false;
+    config.filePath = path;
+    configureLog(config);
+
+    const std::string text = "string";
+    const std::string_view view = "view";
+    const char* missing = nullptr;
+    LOG_INFO("ints {} {} {} {}", 42, -7, 18446744073709551615ull, static_cast<short>(-3));
+    LOG_INFO("floats {} {} {}", 0.5, 2.25f, 1e20);
+    LOG_INFO("{} {} {}{}", true, false, 'x', '!');
+    LOG_WARN("strings {} {} {} {} {}", "literal", text, view, missing, std::string("temporary"));
+    LOG_ERROR("braces {{}} {}", 1);
+    LOG_DEBUG("too few {} {}", 1);
+    LOG_INFO("no placeholders");
+    flushLog();
+
+    std::vector<std::string> expected = {
+        "ints 42 -7 18446744073709551615 -3",
+        "floats 0.5 2.25 1e+20",
+        "true false x!",
+        "strings literal string view (null) temporary",
+        "braces {} 1",
+        "too few 1 {}",
+        "no placeholders",
+    };
+    std::vector<std::string> messages = readLogMessages(path);
+#if GAME_ENGINE_LOG_LEVEL > 1
+    expected.erase(expected.begin() + 5);
+#endif
+    configureLog(LogConfig());
+    removeLogFiles(path, 0);
+    if (messages != expected) {
+        for (const std::string& message : messages) {
+            LOG_ERROR("Logged: {}", message);
+        }
+        return 110;
+    }
+    return 0;
+}
+
+// Nothing is lost or reordered within a thread, even with rings small
+// enough to fill up and wrap many times
+int testLogThreads() {
+    const std::string path = logTestPath("game_engine_log_threads.txt");
+    removeLogFiles(path, 0);
+    LogConfig config;
+    config.console = false;
+    config.filePath = path;
+    config.threadBufferBytes = 16u << 10;
+    configureLog(config);
+
+    const int threadCount = 4;
+    const int perThread = 20000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([t] {
+            const std::string padding(t * 40, '.');
+            for (int i = 0; i < perThread; ++i) {
+                LOG_INFO("thread {} message {} {}", t, i, padding);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    flushLog();
+
+    std::vector<std::string> messages = readLogMessages(path);
+    configureLog(LogConfig());
+    removeLogFiles(path, 0);
+    if (messages.size() != static_cast<size_t>(threadCount * perThread)) {
+        LOG_ERROR("Logged {} of {} messages", messages.size(), threadCount * perThread);
+        return 111;
+    }
+    std::vector<int> next(threadCount, 0);
+    for (const std::string& message : messages) {
+        int t = -1;
+        int i = -1;
+        if (std::sscanf(message.c_str(), "thread %d message %d", &t, &i) != 2 || t < 0 || t >= threadCount ||
+            i != next[t]) {
+            return 112;
+        }
+        ++next[t];
+    }
+    return 0;
+}
+
+// The file is rotated before it outgrows the limit, keeping the newest
+// rotated files and dropping older ones
+int testLogRotation() {
+    const std::string path = logTestPath("game_engine_log_rotate.txt");
+    removeLogFiles(path, 4);
+    LogConfig config;
+    config.console = false;
+    config.filePath = path;
+    config.maxFileBytes = 4096;
+    config.maxFiles = 2;
+    configureLog(config);
+    for (int i = 0; i < 400; ++i) {
+        LOG_INFO("rotation line {}", i);
+    }
+    flushLog();
+    configureLog(LogConfig());
+
+    int result = 0;
+    int previous = 400;
+    for (int file = 0; file <= 2 && result == 0; ++file) {
+        const std::string name = (file == 0) ? path : path + "." + std::to_string(file);
+        std::error_code error;
+        const uintmax_t size = std::filesystem::file_size(name, error);
+        if (error || size == 0 || size > config.maxFileBytes) {
+            result = 113;
+            break;
+        }
+        // Each file ends where the newer one starts
+        std::vector<std::string> messages = readLogMessages(name);
+        int last = -1;
+        if (messages.empty() || std::sscanf(messages.back().c_str(), "rotation line %d", &last) != 1 ||
+            last != previous - 1) {
+            result = 114;
+            break;
+        }
+        int first = -1;
+        std::sscanf(messages.front().c_str(), "rotation line %d", &first);
+        previous = first;
+    }
+    if (result == 0 && std::filesystem::exists(path + ".3")) {
+        result = 115;
+    }
+    removeLogFiles(path, 4);
+    return result;
+}
+
+// A record with more string bytes than a small ring holds is cut short
+// rather than waiting forever for room, both at the start of the ring
+// and where it has to wrap around to the start
+int testLogLongRecords() {
+    const std::string path = logTestPath("game_engine_log_long.txt");
+    removeLogFiles(path, 0);
+    LogConfig config;
+    config.console = false;
+    config.filePath = path;
+    config.threadBufferBytes = 16u << 10;
+    configureLog(config);
+    const std::string half = std::string(4096, 'c') + std::string(4062, 'd');
+    for (bool wrap : {false, true}) {
+        std::thread thread([wrap] {
+            if (wrap) {
+                // A record of exactly half the ring, read before the long one
+                LOG_INFO("{}{}", std::string(4096, 'c'), std::string(4062, 'd'));
+                flushLog();
+            }
+            const std::string a(5000, 'a');
+            const std::string b(5000, 'b');
+            LOG_INFO("{} {} {} {}", a, b, a, b);
+            LOG_INFO("after");
+        });
+        thread.join();
+    }
+    flushLog();
+
+    std::vector<std::string> messages = readLogMessages(path);
+    configureLog(LogConfig());
+    removeLogFiles(path, 0);
+    // The first string whole, the second cut to fit, the others dropped
+    const size_t second = LOG_MAX_ARG_BYTES - LOG_MAX_STRING - 4 * 5;
+    const std::string cut = std::string(LOG_MAX_STRING, 'a') + " " + std::string(second, 'b') + "  ";
+    const std::vector<std::string> expected = {cut, "after", half, cut, "after"};
+    if (messages != expected) {
+        return 117;
+    }
+    return 0;
+}
+
+// Calls below GAME_ENGINE_LOG_LEVEL never evaluate their arguments
+int testLogLevels() {
+    int evaluated = 0;
+    auto count = [&evaluated]() { return ++evaluated; };
+    LOG_TRACE("trace {}", count());
+#if GAME_ENGINE_LOG_LEVEL > 0
+    if (evaluated != 0) {
+        return 116;
+    }
+#else
+    if (evaluated != 1) {
+        return 116;
+    }
+#endif
+    return 0;
+}
+
+int test_log() {
+#if GAME_ENGINE_LOG_LEVEL > 2
+    // Info is compiled out, which leaves nothing to read back
+    return testLogLevels();
+#endif
+    int result = testLogFormatting();
+    if (result != 0) {
+        return result;
+    }
+    result = testLogThreads();
+    if (result != 0) {
+        return result;
+    }
+    result = testLogRotation();
+    if (result != 0) {
+        return result;
+    }
+    result = testLogLongRecords();
+    if (result != 0) {
+        return result;
+    }
+    return testLogLevels();
+}
+
+#endif // LOG_TEST_H
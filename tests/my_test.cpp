@@ -2,39 +2,132 @@
 #include "../tools/compiler_integrity.h" // Include the integrity header file for the RuleOfThree class
 #include "../tools/datafile_integrity.h" // Include the datafile integrity header file for file operations
 #include "sdl_test.h" // Include the SDL test header file for SDL operations
+#include "physics_test.h" // Include the physics test header file for the rigid body world
+#include "particle_test.h" // Include the particle test header file for the particle system
+#include "tilemap_test.h" // Include the tilemap test header file for the chunked tile renderer
+#include "text_test.h" // Include the text test header file for the glyph atlas and text layout
+#include "string_id_test.h" // Include the string id test header file for hashed names
+#include "net_test.h" // Include the net test header file for snapshot replication
+#include "nav_test.h" // Include the nav test header file for hierarchical pathfinding
+#include "log_test.h" // Include the log test header file for the asynchronous logger
+#ifdef GAME_ENGINE_COROUTINES
+#include "coro_test.h" // Include the coroutine test header file for the task scheduler
+#endif
 #include <string.h>
-#include <iostream>
 
 int main(int argc, char const *argv[])
 {   
     (void)argc; // Suppress unused parameter warning
     (void)argv; // Suppress unused parameter warning
 
-    std::cout << "Test detected, running tests..." << std::endl;
+    LOG_INFO("Test detected, running tests...");
     
     int check = test_a(); // Call the test function from the integrity header
-    std::cout << "Test A returned: " << check << std::endl;
+    LOG_INFO("Test A returned: {}", check);
     if (check != 0) { // Check if the test function returned an error code
-        std::cerr << "Test 1 failed with error code: " << check << std::endl; // Print the error code
+        LOG_ERROR("Test 1 failed with error code: {}", check); // Print the error code
         return check; // Return the error code
     } else {
-        std::cout << "Test 1 passed successfully" << std::endl;
+        LOG_INFO("Test 1 passed successfully");
     }
     
     int check_b = test_b(); // Call the test function from the datafile integrity header
-    std::cout << "Test B returned: " << check_b << std::endl;
+    LOG_INFO("Test B returned: {}", check_b);
     if (check_b != 0) { // Check if the test function returned an error code
-        std::cerr << "Test 2 failed with error code: " << check_b << std::endl; // Print the error code
+        LOG_ERROR("Test 2 failed with error code: {}", check_b); // Print the error code
         return check_b; // Return the error code
     } else {
-        std::cout << "Test 2 passed successfully" << std::endl;
+        LOG_INFO("Test 2 passed successfully");
+    }
+
+    int check_c = test_physics(); // Call the test function from the physics test header
+    LOG_INFO("Test C returned: {}", check_c);
+    if (check_c != 0) { // Check if the test function returned an error code
+        LOG_ERROR("Test 3 failed with error code: {}", check_c); // Print the error code
+        return check_c; // Return the error code
+    } else {
+        LOG_INFO("Test 3 passed successfully");
+    }
+
+    int check_d = test_particles(); // Call the test function from the particle test header
+    LOG_INFO("Test D returned: {}", check_d);
+    if (check_d != 0) { // Check if the test function returned an error code
+        LOG_ERROR("Test 4 failed with error code: {}", check_d); // Print the error code
+        return check_d; // Return the error code
+    } else {
+        LOG_INFO("Test 4 passed successfully");
+    }
+
+    int check_e = test_tilemap(); // Call the test function from the tilemap test header
+    LOG_INFO("Test E returned: {}", check_e);
+    if (check_e != 0) { // Check if the test function returned an error code
+        LOG_ERROR("Test 5 failed with error code: {}", check_e); // Print the error code
+        return check_e; // Return the error code
+    } else {
+        LOG_INFO("Test 5 passed successfully");
+    }
+
+    int check_f = test_text(); // Call the test function from the text test header
+    LOG_INFO("Test F returned: {}", check_f);
+    if (check_f != 0) { // Check if the test function returned an error code
+        LOG_ERROR("Test 6 failed with error code: {}", check_f); // Print the error code
+        return check_f; // Return the error code
+    } else {
+        LOG_INFO("Test 6 passed successfully");
+    }
+
+    int check_g = test_string_id(); // Call the test function from the string id test header
+    LOG_INFO("Test G returned: {}", check_g);
+    if (check_g != 0) { // Check if the test function returned an error code
+        LOG_ERROR("Test 7 failed with error code: {}", check_g); // Print the error code
+        return check_g; // Return the error code
+    } else {
+        LOG_INFO("Test 7 passed successfully");
+    }
+
+#ifdef GAME_ENGINE_COROUTINES
+    int check_h = test_coroutines(); // Call the test function from the coroutine test header
+    LOG_INFO("Test H returned: {}", check_h);
+    if (check_h != 0) { // Check if the test function returned an error code
+        LOG_ERROR("Test 8 failed with error code: {}", check_h); // Print the error code
+        return check_h; // Return the error code
+    } else {
+        LOG_INFO("Test 8 passed successfully");
+    }
+#endif
+
+    int check_i = test_net(); // Call the test function from the net test header
+    LOG_INFO("Test I returned: {}", check_i);
+    if (check_i != 0) { // Check if the test function returned an error code
+        LOG_ERROR("Test 9 failed with error code: {}", check_i); // Print the error code
+        return check_i; // Return the error code
+    } else {
+        LOG_INFO("Test 9 passed successfully");
+    }
+
+    int check_j = test_nav(); // Call the test function from the nav test header
+    LOG_INFO("Test J returned: {}", check_j);
+    if (check_j != 0) { // Check if the test function returned an error code
+        LOG_ERROR("Test 10 failed with error code: {}", check_j); // Print the error code
+        return check_j; // Return the error code
+    } else {
+        LOG_INFO("Test 10 passed successfully");
+    }
+
+    int check_k = test_log(); // Call the test function from the log test header
+    LOG_INFO("Test K returned: {}", check_k);
+    if (check_k != 0) { // Check if the test function returned an error code
+        LOG_ERROR("Test 11 failed with error code: {}", check_k); // Print the error code
+        return check_k; // Return the error code
+    } else {
+        LOG_INFO("Test 11 passed successfully");
     }
     
-    std::cout << "All tests completed successfully" << std::endl;
+    LOG_INFO("All tests completed successfully");
     
 
-    std::cout << "Hello, World!" << std::endl; // Print a message to the console
-    std::cout << "Welcome to the C++ Game Engine" << std::endl; // Print another message  
+    LOG_INFO("Hello, World!"); // Print a message to the console
+    LOG_INFO("Welcome to the C++ Game Engine"); // Print another message  
     finish(); // Call the finish function from the SDL test header
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "../src/nav/path_service.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Pathfinding on a 2048x2048 map of scattered walls: builds the cluster
+// graph, then runs batches of long random queries with the cache cleared,
+// batches of agents heading to a few shared goals, and the same again
+// after a handful of edits. Flat A* over the whole grid on a sample of the
+// random queries gives the baseline speed and the best path cost.
+// Usage: nav_bench [queries] [threads] [clusterSize] [size]
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Textbook A* over every cell, with its arrays allocated once
+class FlatAStar {
+public:
+    explicit FlatAStar(const NavGrid& grid)
+        : m_grid(grid), m_g(static_cast<size_t>(grid.getWidth()) * grid.getHeight()), m_stamp(m_g.size(), 0) {}
+
+    uint32_t findCost(NavCell start, NavCell goal) {
+        ++m_generation;
+        m_open.clear();
+        const int width = m_grid.getWidth();
+        auto byF = [](const Entry& a, const Entry& b) { return a.f > b.f; };
+        m_g[start.y * width + start.x] = 0;
+        m_stamp[start.y * width + start.x] = m_generation;
+        m_open.push_back(Entry{navDistance(start.x, start.y, goal.x, goal.y), 0, start.y * width + start.x});
+        while (!m_open.empty()) {
+            std::pop_heap(m_open.begin(), m_open.end(), byF);
+            const Entry entry = m_open.back();
+            m_open.pop_back();
+            if (entry.g != m_g[entry.cell]) {
+                continue;
+            }
+            const int x = entry.cell % width;
+            const int y = entry.cell / width;
+            if (x == goal.x && y == goal.y) {
+                return entry.g;
+            }
+            m_grid.forEachNeighbour(x, y, 0, 0, width, m_grid.getHeight(), [&](int nx, int ny, uint32_t cost) {
+                const int cell = ny * width + nx;
+                const uint32_t g = entry.g + cost;
+                if (m_stamp[cell] != m_generation || g < m_g[cell]) {
+                    m_stamp[cell] = m_generation;
+                    m_g[cell] = g;
+                    m_open.push_back(Entry{g + navDistance(nx, ny, goal.x, goal.y), g, cell});
+                    std::push_heap(m_open.begin(), m_open.end(), byF);
+                }
+            });
+        }
+        return NAV_NO_PATH;
+    }
+
+private:
+    struct Entry {
+        uint32_t f;
+        uint32_t g;
+        int cell;
+    };
+
+    const NavGrid& m_grid;
+    std::vector<uint32_t> m_g;
+    std::vector<uint32_t> m_stamp;
+    std::vector<Entry> m_open;
+    uint32_t m_generation = 0;
+};
+
+struct BatchStats {
+    double wallMs = 0.0;
+    std::vector<double> searchMs;
+    size_t found = 0;
+    size_t fromCache = 0;
+};
+
+static void runBatches(PathService& service, const std::vector<PathQuery>& queries, size_t batchSize, bool clearCache,
+                       BatchStats& stats, std::vector<PathResult>* keep = nullptr) {
+    std::vector<PathQuery> batch;
+    std::vector<PathResult> results;
+    for (size_t first = 0; first < queries.size(); first += batchSize) {
+        batch.assign(queries.begin() + first, queries.begin() + std::min(queries.size(), first + batchSize));
+        if (clearCache) {
+            service.clearCache();
+        }
+        auto start = std::chrono::steady_clock::now();
+        service.findPaths(batch, results);
+        stats.wallMs += elapsedMs(start);
+        for (const PathResult& result : results) {
+            stats.found += result.found ? 1 : 0;
+            stats.fromCache += result.fromCache ? 1 : 0;
+            if (!result.fromCache) {
+                stats.searchMs.push_back(result.searchMs);
+            }
+            if (keep) {
+                keep->push_back(result);
+            }
+        }
+    }
+}
+
+static double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+static void report(const char* name, size_t queryCount, const BatchStats& stats) {
+    std::cout << "  " << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(9) << queryCount / (stats.wallMs / 1000.0) << " queries/s" << std::setprecision(1)
+              << std::setw(6) << 100.0 * stats.found / queryCount << "% found" << std::setw(6)
+              << 100.0 * stats.fromCache / queryCount << "% cached" << std::setprecision(3)
+              << std::setw(9) << percentile(stats.searchMs, 0.5) << " ms p50" << std::setw(9)
+              << percentile(stats.searchMs, 0.99) << " ms p99\n";
+}
+
+int main(int argc, char const *argv[])
+{
+    const size_t queryCount = (argc > 1) ? static_cast<size_t>(std::atoi(argv[1])) : 2000;
+    const size_t threads = (argc > 2) ? static_cast<size_t>(std::atoi(argv[2])) : std::thread::hardware_concurrency();
+    const int clusterSize = (argc > 3) ? std::atoi(argv[3]) : 32;
+    const int size = (argc > 4) ? std::atoi(argv[4]) : 2048;
+    const size_t batchSize = 256;
+
+    PathServiceConfig config;
+    config.clusterSize = clusterSize;
+    config.threadCount = threads;
+    config.maxCachedPaths = 8192;
+    PathService service(size, size, config);
+
+    uint32_t rng = 12345u;
+    auto next = [&rng]() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    };
+    // Walls of up to 40 cells over about a tenth of the map; a few spots
+    // end up walled in
+    for (int i = 0; i < size * size / 200; ++i) {
+        const int x = static_cast<int>(next() % size);
+        const int y = static_cast<int>(next() % size);
+        const int length = 1 + static_cast<int>(next() % 40);
+        const bool horizontal = next() % 2 == 0;
+        for (int k = 0; k < length; ++k) {
+            const int cx = horizontal ? x + k : x;
+            const int cy = horizontal ? y : y + k;
+            if (cx < size && cy < size) {
+                service.setPassable(cx, cy, false);
+            }
+        }
+    }
+    const NavGrid& grid = service.getGrid();
+    auto randomOpenCell = [&]() {
+        for (;;) {
+            NavCell cell(static_cast<int>(next() % size), static_cast<int>(next() % size));
+            if (grid.isPassable(cell.x, cell.y)) {
+                return cell;
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    const size_t clusters = service.updateGraph();
+    const double buildMs = elapsedMs(start);
+    size_t portals = 0;
+    for (int c = 0; c < service.getGraph().getClusterCount(); ++c) {
+        portals += service.getGraph().getPortalCount(c);
+    }
+    std::cout << size << "x" << size << " grid, " << clusterSize << "x" << clusterSize << " clusters, "
+              << threads << " threads, batches of " << batchSize << "\n";
+    std::cout << "  graph build: " << clusters << " clusters, " << portals << " portals, " << std::fixed
+              << std::setprecision(1) << buildMs << " ms\n";
+
+    std::vector<PathQuery> randomQueries;
+    for (size_t i = 0; i < queryCount; ++i) {
+        randomQueries.push_back(PathQuery{randomOpenCell(), randomOpenCell()});
+    }
+    BatchStats cold;
+    std::vector<PathResult> coldResults;
+    runBatches(service, randomQueries, batchSize, true, cold, &coldResults);
+    report("random, cache cleared", queryCount, cold);
+
+    // Flat A* is slow on long paths, a sample is enough
+    FlatAStar flat(grid);
+    const size_t sample = std::min<size_t>(50, queryCount);
+    double flatMs = 0.0;
+    uint64_t hpaCost = 0;
+    uint64_t bestCost = 0;
+    for (size_t i = 0; i < sample; ++i) {
+        start = std::chrono::steady_clock::now();
+        const uint32_t best = flat.findCost(randomQueries[i].start, randomQueries[i].goal);
+        flatMs += elapsedMs(start);
+        if (best != NAV_NO_PATH && coldResults[i].found) {
+            hpaCost += coldResults[i].cost;
+            bestCost += best;
+        }
+    }
+    std::cout << "  flat A*, one thread:     " << std::setprecision(3) << std::setw(9) << flatMs / sample
+              << " ms/query; HPA* paths are " << std::setprecision(1)
+              << (bestCost ? 100.0 * hpaCost / bestCost - 100.0 : 0.0) << "% longer\n";
+
+    // Crowds: many agents sharing a few destinations and spawn points
+    std::vector<NavCell> goals;
+    std::vector<NavCell> spawns;
+    for (int i = 0; i < 16; ++i) {
+        goals.push_back(randomOpenCell());
+    }
+    for (int i = 0; i < 128; ++i) {
+        spawns.push_back(randomOpenCell());
+    }
+    std::vector<PathQuery> crowdQueries;
+    for (size_t i = 0; i < queryCount; ++i) {
+        crowdQueries.push_back(PathQuery{spawns[next() % spawns.size()], goals[next() % goals.size()]});
+    }
+    service.clearCache();
+    BatchStats crowd;
+    runBatches(service, crowdQueries, batchSize, false, crowd);
+    report("shared goals, first pass", queryCount, crowd);
+    BatchStats warm;
+    runBatches(service, crowdQueries, batchSize, false, warm);
+    report("shared goals, warm cache", queryCount, warm);
+
+    // Doors opening and closing: only paths through those clusters go
+    for (int i = 0; i < 32; ++i) {
+        const NavCell cell(static_cast<int>(next() % size), static_cast<int>(next() % size));
+        service.setPassable(cell.x, cell.y, !grid.isPassable(cell.x, cell.y));
+    }
+    start = std::chrono::steady_clock::now();
+    const size_t rebuilt = service.updateGraph();
+    const double rebuildMs = elapsedMs(start);
+    BatchStats edited;
+    runBatches(service, crowdQueries, batchSize, false, edited);
+    std::cout << "  32 edits: " << rebuilt << " clusters rebuilt in " << std::setprecision(2) << rebuildMs << " ms\n";
+    report("shared goals, after edits", queryCount, edited);
+    return 0;
+}
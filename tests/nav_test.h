@@ -0,0 +1,233 @@
+#ifndef NAV_TEST_H
+#define NAV_TEST_H
+
+#include "../src/log/log.h"
+#include "../src/nav/path_service.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <vector>
+
+// Scattered short walls; map sizes in the tests are not all multiples of
+// the cluster size
+void buildNavTestMap(PathService& service, uint32_t seed) {
+    const NavGrid& grid = service.getGrid();
+    uint32_t rng = seed;
+    auto next = [&rng]() {
+        rng = rng * 1664525u + 1013904223u;
+        return rng >> 8;
+    };
+    for (int i = 0; i < grid.getWidth() * grid.getHeight() / 40; ++i) {
+        const int x = static_cast<int>(next() % grid.getWidth());
+        const int y = static_cast<int>(next() % grid.getHeight());
+        const int length = 1 + static_cast<int>(next() % 12);
+        const bool horizontal = next() % 2 == 0;
+        for (int k = 0; k < length; ++k) {
+            const int cx = horizontal ? x + k : x;
+            const int cy = horizontal ? y : y + k;
+            if (cx < grid.getWidth() && cy < grid.getHeight()) {
+                service.setPassable(cx, cy, false);
+            }
+        }
+    }
+}
+
+// Plain Dijkstra over the whole grid, the reference for the best cost
+uint32_t navReferenceCost(const NavGrid& grid, NavCell start, NavCell goal) {
+    if (!grid.isPassable(start.x, start.y) || !grid.isPassable(goal.x, goal.y)) {
+        return NAV_NO_PATH;
+    }
+    std::vector<uint32_t> cost(static_cast<size_t>(grid.getWidth()) * grid.getHeight(), NAV_NO_PATH);
+    using Entry = std::pair<uint32_t, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    cost[start.y * grid.getWidth() + start.x] = 0;
+    open.push(Entry(0, start.y * grid.getWidth() + start.x));
+    while (!open.empty()) {
+        const Entry entry = open.top();
+        open.pop();
+        if (entry.first != cost[entry.second]) {
+            continue;
+        }
+        const int x = entry.second % grid.getWidth();
+        const int y = entry.second / grid.getWidth();
+        if (x == goal.x && y == goal.y) {
+            return entry.first;
+        }
+        grid.forEachNeighbour(x, y, 0, 0, grid.getWidth(), grid.getHeight(), [&](int nx, int ny, uint32_t step) {
+            const int index = ny * grid.getWidth() + nx;
+            if (entry.first + step < cost[index]) {
+                cost[index] = entry.first + step;
+                open.push(Entry(cost[index], index));
+            }
+        });
+    }
+    return NAV_NO_PATH;
+}
+
+// Every step is a legal move and the steps add up to the reported cost
+bool navPathValid(const NavGrid& grid, const PathQuery& query, const PathResult& result) {
+    if (result.path.empty() || result.path.front() != query.start || result.path.back() != query.goal) {
+        return false;
+    }
+    uint32_t total = 0;
+    for (size_t i = 1; i < result.path.size(); ++i) {
+        const NavCell from = result.path[i - 1];
+        const NavCell to = result.path[i];
+        uint32_t step = 0;
+        grid.forEachNeighbour(from.x, from.y, 0, 0, grid.getWidth(), grid.getHeight(), [&](int nx, int ny, uint32_t cost) {
+            if (nx == to.x && ny == to.y) {
+                step = cost;
+            }
+        });
+        if (step == 0) {
+            return false;
+        }
+        total += step;
+    }
+    return total == result.cost;
+}
+
+std::vector<PathQuery> navTestQueries(const NavGrid& grid, size_t count, uint32_t seed) {
+    std::vector<PathQuery> queries;
+    uint32_t rng = seed;
+    while (queries.size() < count) {
+        rng = rng * 1664525u + 1013904223u;
+        const int sx = static_cast<int>((rng >> 8) % grid.getWidth());
+        rng = rng * 1664525u + 1013904223u;
+        const int sy = static_cast<int>((rng >> 8) % grid.getHeight());
+        rng = rng * 1664525u + 1013904223u;
+        const int gx = static_cast<int>((rng >> 8) % grid.getWidth());
+        rng = rng * 1664525u + 1013904223u;
+        const int gy = static_cast<int>((rng >> 8) % grid.getHeight());
+        if (grid.isPassable(sx, sy) && grid.isPassable(gx, gy)) {
+            queries.push_back(PathQuery{NavCell(sx, sy), NavCell(gx, gy)});
+        }
+    }
+    return queries;
+}
+
+// Paths are legal, found exactly when one exists, and close to the best
+int testNavPaths() {
+    PathServiceConfig config;
+    config.clusterSize = 16;
+    config.threadCount = 1;
+    PathService service(120, 100, config);
+    buildNavTestMap(service, 7);
+    const NavGrid& grid = service.getGrid();
+
+    std::vector<PathQuery> queries = navTestQueries(grid, 300, 11);
+    std::vector<PathResult> results;
+    service.findPaths(queries, results);
+    uint64_t found = 0;
+    uint64_t optimal = 0;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const uint32_t best = navReferenceCost(grid, queries[i].start, queries[i].goal);
+        if (results[i].found != (best != NAV_NO_PATH)) {
+            LOG_ERROR("Query {} disagrees with Dijkstra on reachability", i);
+            return 100;
+        }
+        if (!results[i].found) {
+            continue;
+        }
+        if (!navPathValid(grid, queries[i], results[i])) {
+            return 101;
+        }
+        if (results[i].cost < best) {
+            return 102;
+        }
+        found += results[i].cost;
+        optimal += best;
+    }
+    if (found > optimal * 110 / 100) {
+        LOG_ERROR("Paths are {}% longer than the best", found * 100 / optimal - 100);
+        return 102;
+    }
+
+    std::vector<PathQuery> bad = {PathQuery{NavCell(-1, 0), NavCell(5, 5)}, PathQuery{NavCell(5, 5), NavCell(120, 3)}};
+    service.findPaths(bad, results);
+    if (results[0].found || results[1].found) {
+        return 103;
+    }
+    return 0;
+}
+
+// Repeated queries come from the cache until an edit touches their path
+int testNavCache() {
+    PathServiceConfig config;
+    config.clusterSize = 16;
+    config.threadCount = 1;
+    PathService service(128, 128, config);
+    buildNavTestMap(service, 3);
+    const NavGrid& grid = service.getGrid();
+
+    // Across the top of the map, well clear of the bottom rows
+    std::vector<PathQuery> queries = {PathQuery{NavCell(2, 2), NavCell(125, 30)}};
+    service.setPassable(2, 2, true);
+    service.setPassable(125, 30, true);
+    std::vector<PathResult> first;
+    service.findPaths(queries, first);
+    std::vector<PathResult> second;
+    service.findPaths(queries, second);
+    if (!first[0].found || first[0].fromCache || !second[0].fromCache || second[0].path != first[0].path) {
+        return 104;
+    }
+    for (const NavCell& cell : first[0].path) {
+        if (cell.y >= 96) {
+            return 104; // The map changed so much the test no longer works
+        }
+    }
+
+    service.setPassable(5, 120, !grid.isPassable(5, 120));
+    service.findPaths(queries, second);
+    if (!second[0].fromCache) {
+        return 105;
+    }
+
+    const NavCell blocked = first[0].path[first[0].path.size() / 2];
+    service.setPassable(blocked.x, blocked.y, false);
+    service.findPaths(queries, second);
+    if (!second[0].found || second[0].fromCache || !navPathValid(grid, queries[0], second[0]) ||
+        std::find(second[0].path.begin(), second[0].path.end(), blocked) != second[0].path.end()) {
+        return 106;
+    }
+    return 0;
+}
+
+// The thread count changes nothing about the answers
+int testNavThreads() {
+    PathServiceConfig config;
+    config.clusterSize = 16;
+    config.threadCount = 1;
+    PathService single(200, 150, config);
+    config.threadCount = 4;
+    PathService threaded(200, 150, config);
+    buildNavTestMap(single, 21);
+    buildNavTestMap(threaded, 21);
+
+    std::vector<PathQuery> queries = navTestQueries(single.getGrid(), 200, 5);
+    std::vector<PathResult> a;
+    std::vector<PathResult> b;
+    single.findPaths(queries, a);
+    threaded.findPaths(queries, b);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        if (a[i].found != b[i].found || a[i].cost != b[i].cost || a[i].path != b[i].path) {
+            return 107;
+        }
+    }
+    return 0;
+}
+
+int test_nav() {
+    int result = testNavPaths();
+    if (result != 0) {
+        return result;
+    }
+    result = testNavCache();
+    if (result != 0) {
+        return result;
+    }
+    return testNavThreads();
+}
+
+#endif // NAV_TEST_H
@@ -0,0 +1,150 @@
+#include "../src/core/thread_pool.h"
+#include "../src/net/replication.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Snapshot encoding for many entities and clients, in memory: every tick
+// the server writes one snapshot per client, each client applies what it
+// gets, and acks come back two ticks later with 5% of snapshots lost.
+// Reports bytes per client per tick, how many entities those carry, and
+// the time to write all snapshots.
+// Usage: net_bench [entities] [clients] [threads] [ticks]
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Scenario {
+    const char* name;
+    float movingFraction; // Entities changed every tick, the rest sit still
+    size_t bytesPerTick;
+};
+
+static void run(const Scenario& scenario, size_t entityCount, size_t clientCount, ThreadPool& pool, int ticks) {
+    ReplicationConfig config;
+    config.maxEntities = entityCount;
+    config.bytesPerTick = scenario.bytesPerTick;
+    ReplicationServer server(config);
+    std::vector<ReplicationClient> clients(clientCount, ReplicationClient(entityCount));
+    std::vector<int> ids(clientCount);
+    for (size_t c = 0; c < clientCount; ++c) {
+        ids[c] = server.addClient();
+        server.setClientFocus(ids[c], static_cast<float>(c % 8) * 250.0f, static_cast<float>(c / 8) * 250.0f);
+    }
+
+    // A 2 km square of wandering entities
+    std::vector<EntityState> states(entityCount);
+    for (size_t e = 0; e < entityCount; ++e) {
+        states[e].kind = static_cast<uint8_t>(1 + e % 4);
+        states[e].x = static_cast<float>((e * 7919) % 2000);
+        states[e].y = static_cast<float>((e * 104729) % 2000);
+        server.setEntity(e, states[e]);
+    }
+    const size_t moving = static_cast<size_t>(static_cast<float>(entityCount) * scenario.movingFraction);
+
+    const size_t bufferSize = 1 << 16;
+    std::vector<uint8_t> packets(clientCount * bufferSize);
+    std::vector<size_t> sizes(clientCount);
+    std::deque<std::vector<std::vector<uint8_t>>> ackQueue;
+    uint32_t rng = 0x9E3779B9u;
+
+    double encodeMs = 0.0;
+    double decodeMs = 0.0;
+    size_t totalBytes = 0;
+    size_t totalEntities = 0;
+    size_t totalChanged = 0;
+    size_t samples = 0;
+    for (int tick = 0; tick < ticks; ++tick) {
+        const float t = static_cast<float>(tick) / 60.0f;
+        for (size_t e = 0; e < moving; ++e) {
+            EntityState& state = states[e];
+            state.vx = std::cos(t * 0.7f + e) * 3.0f;
+            state.vy = std::sin(t * 0.3f + e) * 3.0f;
+            state.x += state.vx / 60.0f;
+            state.y += state.vy / 60.0f;
+            state.angle = std::atan2(state.vy, state.vx);
+            server.setEntity(e, state);
+        }
+        server.beginTick();
+
+        auto start = std::chrono::steady_clock::now();
+        pool.parallelFor(clientCount, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                sizes[c] = server.writeSnapshot(ids[c], packets.data() + c * bufferSize, bufferSize);
+            }
+        });
+        const double tickEncodeMs = elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        std::vector<std::vector<uint8_t>> acks(clientCount);
+        for (size_t c = 0; c < clientCount; ++c) {
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            if (rng % 100 >= 5) {
+                clients[c].readSnapshot(packets.data() + c * bufferSize, sizes[c]);
+            }
+            acks[c].resize(16);
+            acks[c].resize(clients[c].writeAck(acks[c].data(), acks[c].size()));
+        }
+        const double tickDecodeMs = elapsedMs(start);
+        ackQueue.push_back(std::move(acks));
+        if (ackQueue.size() > 2) {
+            for (size_t c = 0; c < clientCount; ++c) {
+                const std::vector<uint8_t>& ack = ackQueue.front()[c];
+                server.readAck(ids[c], ack.data(), ack.size());
+            }
+            ackQueue.pop_front();
+        }
+
+        // The first second fills every client with full states
+        if (tick >= 60) {
+            encodeMs += tickEncodeMs;
+            decodeMs += tickDecodeMs;
+            for (size_t c = 0; c < clientCount; ++c) {
+                const SnapshotStats& stats = server.getSnapshotStats(ids[c]);
+                totalBytes += stats.bytes;
+                totalEntities += stats.entitiesSent;
+                totalChanged += stats.entitiesChanged;
+            }
+            ++samples;
+        }
+    }
+
+    const double perClient = static_cast<double>(samples * clientCount);
+    std::cout << std::left << std::setw(34) << scenario.name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << totalBytes / perClient << " B/client/tick" << std::setw(8)
+              << totalEntities / perClient << " sent" << std::setw(8) << totalChanged / perClient << " pending"
+              << std::setw(7) << (totalEntities ? totalBytes * 8.0 / totalEntities : 0.0) << " bits/entity"
+              << std::setprecision(3) << std::setw(9) << encodeMs / samples << " ms encode" << std::setw(8)
+              << decodeMs / samples << " ms decode\n";
+}
+
+int main(int argc, char const *argv[])
+{
+    const size_t entityCount = (argc > 1) ? static_cast<size_t>(std::atoi(argv[1])) : 5000;
+    const size_t clientCount = (argc > 2) ? static_cast<size_t>(std::atoi(argv[2])) : 64;
+    const size_t threads = (argc > 3) ? static_cast<size_t>(std::atoi(argv[3])) : std::thread::hardware_concurrency();
+    const int ticks = (argc > 4) ? std::atoi(argv[4]) : 300;
+    ThreadPool pool(threads);
+
+    std::cout << entityCount << " entities, " << clientCount << " clients, " << pool.getThreadCount()
+              << " threads; a full state is " << sizeof(EntityState) << " B raw\n";
+    const Scenario scenarios[] = {
+        {"all moving, 1200 B budget", 1.0f, 1200},
+        {"10% moving, 1200 B budget", 0.1f, 1200},
+        {"10% moving, unlimited", 0.1f, 1 << 16},
+        {"all moving, unlimited", 1.0f, 1 << 16},
+    };
+    for (const Scenario& scenario : scenarios) {
+        run(scenario, entityCount, clientCount, pool, ticks);
+    }
+    return 0;
+}
@@ -0,0 +1,305 @@
+#ifndef NET_TEST_H
+#define NET_TEST_H
+
+#include "../src/log/log.h"
+#include "../src/net/link_simulator.h"
+#include "../src/net/replication.h"
+#include "../src/net/udp_socket.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// Bit packing and the field delta codec round-trip, and measuring a delta
+// agrees with writing it
+int testNetEncoding() {
+    uint8_t buffer[256];
+    BitWriter writer(buffer, sizeof(buffer));
+    uint32_t rng = 12345;
+    for (int i = 0; i < 100; ++i) {
+        rng = rng * 1664525u + 1013904223u;
+        writer.writeBits(rng, 1 + i % 32);
+    }
+    const size_t bytes = writer.finish();
+    BitReader reader(buffer, bytes);
+    rng = 12345;
+    for (int i = 0; i < 100; ++i) {
+        rng = rng * 1664525u + 1013904223u;
+        if (reader.readBits(1 + i % 32) != (rng & BitWriter::lowBits(1 + i % 32))) {
+            return 90;
+        }
+    }
+    if (reader.hasError()) {
+        return 90;
+    }
+    reader.readBits(16);
+    if (!reader.hasError()) {
+        return 90; // Reading past the end must be flagged
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+        EntityState a;
+        a.kind = static_cast<uint8_t>(1 + i % 7);
+        a.x = std::sin(i * 0.37f) * 4000.0f;
+        a.y = std::cos(i * 0.11f) * 100.0f;
+        a.angle = i * 0.9f - 300.0f;
+        a.vx = std::sin(i * 1.3f) * 70.0f; // Past the range, clamped
+        a.vy = -5.0f;
+        EntityState b = a;
+        b.x += (i % 5) * 0.05f * static_cast<float>(i % 50);
+        b.angle += 0.01f * static_cast<float>(i % 40);
+        b.vy = (i % 3 == 0) ? 60.0f : b.vy;
+        const QuantizedEntity qa = quantizeEntity(a);
+        const QuantizedEntity qb = quantizeEntity(b);
+
+        EntityState back = dequantizeEntity(qa);
+        const float angleError = std::remainder(back.angle - a.angle, 6.28318531f);
+        const float clampedVx = std::fmax(std::fmin(a.vx, NET_VELOCITY_EXTENT - 1.0f / NET_VELOCITY_SCALE), -NET_VELOCITY_EXTENT);
+        if (std::fabs(back.x - a.x) > 0.6f / NET_POSITION_SCALE || std::fabs(angleError) > 0.004f ||
+            std::fabs(back.vx - clampedVx) > 0.6f / NET_VELOCITY_SCALE) {
+            LOG_ERROR("Quantization error too large for entity {}", i);
+            return 91;
+        }
+
+        BitWriter deltaWriter(buffer, sizeof(buffer));
+        writeEntityDelta(deltaWriter, qa, qb);
+        if (static_cast<int>(deltaWriter.getBitCount()) != measureEntityDelta(qa, qb)) {
+            return 92;
+        }
+        BitReader deltaReader(buffer, deltaWriter.finish());
+        if (readEntityDelta(deltaReader, qa) != qb || deltaReader.hasError()) {
+            return 92;
+        }
+    }
+    return 0;
+}
+
+// A client with its own socket and its own bad link to the server
+struct LoopbackClient {
+    UdpSocket socket;
+    LinkSimulator link;
+    ReplicationClient replication;
+    int id = -1;
+
+    LoopbackClient(const LinkConditions& conditions, size_t maxEntities)
+        : link(conditions), replication(maxEntities) {}
+};
+
+EntityState loopbackEntity(size_t index, int tick) {
+    EntityState state;
+    state.kind = static_cast<uint8_t>(1 + index % 3);
+    const float t = static_cast<float>(tick) / 60.0f;
+    state.x = static_cast<float>(index % 40) * 3.0f + std::sin(t + index) * 2.0f;
+    state.y = static_cast<float>(index / 40) * 3.0f + std::cos(t * 0.5f + index) * 2.0f;
+    state.angle = t + index;
+    state.vx = std::cos(t + index) * 2.0f;
+    state.vy = -std::sin(t * 0.5f + index);
+    return state;
+}
+
+// Server and clients over real loopback sockets with 20% loss each way,
+// 50-80 ms of latency and reordering. Once the world stops changing every
+// client must end up with exactly the server's quantized state.
+int testReplicationLoopback() {
+    const size_t entityCount = 600;
+    const int clientCount = 3;
+    ReplicationConfig config;
+    config.maxEntities = 1024;
+    config.bytesPerTick = 400; // Tight, so prioritization matters
+    ReplicationServer server(config);
+
+    UdpSocket serverSocket;
+    if (!serverSocket.open(NET_LOOPBACK_IP, 0)) {
+        LOG_ERROR("Could not open a loopback UDP socket");
+        return 93;
+    }
+    LinkConditions conditions;
+    conditions.lossRate = 0.2f;
+    conditions.latency = 0.05;
+    conditions.jitter = 0.03;
+    LinkSimulator serverLink(conditions);
+
+    std::vector<std::unique_ptr<LoopbackClient>> clients;
+    for (int c = 0; c < clientCount; ++c) {
+        conditions.seed = 100 + c;
+        clients.emplace_back(new LoopbackClient(conditions, config.maxEntities));
+        if (!clients.back()->socket.open(NET_LOOPBACK_IP, 0)) {
+            return 93;
+        }
+    }
+
+    std::vector<Datagram> inbox(64);
+    Datagram outgoing;
+    outgoing.address = serverSocket.getLocalAddress();
+    for (int tick = 0; tick < 900; ++tick) {
+        const double now = tick / 60.0;
+
+        // Everything moves for five seconds, then a few entities go away
+        // and the rest settle
+        for (size_t e = 0; e < entityCount; ++e) {
+            if (tick < 300) {
+                server.setEntity(e, loopbackEntity(e, tick));
+            } else if (tick == 300 && e % 10 == 0) {
+                server.removeEntity(e);
+            }
+        }
+        server.beginTick();
+
+        size_t received = serverSocket.receiveBatch(inbox.data(), inbox.size());
+        for (size_t i = 0; i < received; ++i) {
+            const Datagram& datagram = inbox[i];
+            LoopbackClient* from = nullptr;
+            for (auto& client : clients) {
+                if (client->socket.getLocalAddress() == datagram.address) {
+                    from = client.get();
+                }
+            }
+            PacketType type = readPacketType(datagram.data, datagram.size);
+            if (from && type == PacketType::Connect && from->id < 0) {
+                from->id = server.addClient();
+                server.setClientFocus(from->id, 30.0f * (from - clients.front().get()), 20.0f);
+            } else if (from && type == PacketType::Ack && from->id >= 0) {
+                server.readAck(from->id, datagram.data, datagram.size);
+            }
+        }
+
+        for (auto& client : clients) {
+            if (client->id < 0) {
+                continue;
+            }
+            Datagram snapshot;
+            snapshot.address = client->socket.getLocalAddress();
+            snapshot.size = static_cast<uint16_t>(server.writeSnapshot(client->id, snapshot.data, NET_MAX_DATAGRAM));
+            if (snapshot.size == 0 || snapshot.size > config.bytesPerTick) {
+                return 94;
+            }
+            serverLink.send(snapshot, now);
+        }
+        serverLink.flush(serverSocket, now);
+
+        for (auto& client : clients) {
+            received = client->socket.receiveBatch(inbox.data(), inbox.size());
+            for (size_t i = 0; i < received; ++i) {
+                client->replication.readSnapshot(inbox[i].data, inbox[i].size);
+            }
+            // Keep asking until the server knows us, then ack every tick
+            outgoing.size = static_cast<uint16_t>(client->replication.getSnapshotCount() == 0
+                                                      ? writeConnectPacket(outgoing.data, NET_MAX_DATAGRAM)
+                                                      : client->replication.writeAck(outgoing.data, NET_MAX_DATAGRAM));
+            client->link.send(outgoing, now);
+            client->link.flush(client->socket, now);
+        }
+    }
+
+    for (auto& client : clients) {
+        if (client->id < 0 || client->replication.getSnapshotCount() < 100) {
+            return 95;
+        }
+        for (size_t e = 0; e < config.maxEntities; ++e) {
+            const QuantizedEntity expected = e < entityCount && e % 10 != 0 ? quantizeEntity(server.getEntity(e)) : QuantizedEntity();
+            if (client->replication.getQuantizedEntity(e) != expected) {
+                LOG_ERROR("Client {} has entity {} out of date", client->id, e);
+                return 96;
+            }
+        }
+        // Settled: only the header is left to send
+        if (server.getSnapshotStats(client->id).entitiesChanged != 0) {
+            return 97;
+        }
+    }
+    return 0;
+}
+
+// Acks that come back slower than the ack window still move baselines
+// forward, and entities removed before any ack came back still reach the
+// client
+int testReplicationSlowAcks() {
+    ReplicationConfig config;
+    config.maxEntities = 64;
+    ReplicationServer server(config);
+    ReplicationClient client(config.maxEntities);
+    const int id = server.addClient();
+    const size_t ackDelay = 40;
+    std::vector<std::vector<uint8_t>> acks;
+    size_t fullStates = 1;
+    uint8_t packet[NET_MAX_DATAGRAM];
+    for (int tick = 0; tick < 300; ++tick) {
+        // Some are removed long before the ack of their first send comes
+        // back, the rest move, settle and move once more after every
+        // ack has arrived
+        for (size_t e = 0; e < 32; ++e) {
+            if (e % 4 == 0 && tick == 5) {
+                server.removeEntity(e);
+            } else if ((tick < 100 || tick == 250) && (e % 4 != 0 || tick < 5)) {
+                server.setEntity(e, loopbackEntity(e, tick));
+            }
+        }
+        server.beginTick();
+        const size_t size = server.writeSnapshot(id, packet, sizeof(packet));
+        client.readSnapshot(packet, size);
+        if (tick == 250) {
+            fullStates = server.getSnapshotStats(id).fullStates;
+        }
+
+        acks.emplace_back(NET_MAX_DATAGRAM);
+        acks.back().resize(client.writeAck(acks.back().data(), NET_MAX_DATAGRAM));
+        if (acks.size() > ackDelay) {
+            server.readAck(id, acks.front().data(), acks.front().size());
+            acks.erase(acks.begin());
+        }
+    }
+
+    for (size_t e = 0; e < config.maxEntities; ++e) {
+        const EntityState& state = server.getEntity(e);
+        const QuantizedEntity expected = state.kind != 0 ? quantizeEntity(state) : QuantizedEntity();
+        if (client.getQuantizedEntity(e) != expected) {
+            LOG_ERROR("Client has entity {} out of date with acks {} ticks late", e, ackDelay);
+            return 108;
+        }
+    }
+    // The last move went out as deltas, and nothing is left to send
+    if (fullStates != 0 || server.getSnapshotStats(id).entitiesChanged != 0) {
+        return 109;
+    }
+    return 0;
+}
+
+// Snapshots that are repeated, cut short or not ours are rejected
+int testReplicationRejects() {
+    ReplicationConfig config;
+    config.maxEntities = 64;
+    ReplicationServer server(config);
+    ReplicationClient client(config.maxEntities);
+    for (size_t e = 0; e < 64; ++e) {
+        server.setEntity(e, loopbackEntity(e, 0));
+    }
+    int id = server.addClient();
+    uint8_t packet[NET_MAX_DATAGRAM];
+    size_t size = server.writeSnapshot(id, packet, sizeof(packet));
+    if (client.readSnapshot(packet, size - 1) || !client.readSnapshot(packet, size) || client.readSnapshot(packet, size)) {
+        return 98;
+    }
+    packet[0] ^= 0xFF;
+    if (readPacketType(packet, size) != PacketType::Invalid || client.readSnapshot(packet, size)) {
+        return 99;
+    }
+    return 0;
+}
+
+int test_net() {
+    int result = testNetEncoding();
+    if (result != 0) {
+        return result;
+    }
+    result = testReplicationRejects();
+    if (result != 0) {
+        return result;
+    }
+    result = testReplicationSlowAcks();
+    if (result != 0) {
+        return result;
+    }
+    return testReplicationLoopback();
+}
+
+#endif // NET_TEST_H
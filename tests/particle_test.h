@@ -0,0 +1,119 @@
+#ifndef PARTICLE_TEST_H
+#define PARTICLE_TEST_H
+
+#include "../src/core/cpu_features.h"
+#include "../src/log/log.h"
+#include "../src/particles/particle_system.h"
+
+#include <cmath>
+#include <vector>
+
+// Runs the same particles through the scalar and AVX2 kernels and checks
+// they agree, including bounces off a floor plane
+int testParticleKernels() {
+    if (!cpuSupportsAvx2Fma()) {
+        return 0; // Nothing to compare against
+    }
+    const size_t count = 1003; // Not a multiple of 8, exercises the tail
+    ParticlePool poolA(count);
+    ParticlePool poolB(count);
+    poolA.spawn(count);
+    poolB.spawn(count);
+    ParticleArrays a = poolA.getArrays();
+    ParticleArrays b = poolB.getArrays();
+    for (size_t i = 0; i < count; ++i) {
+        a.x[i] = b.x[i] = static_cast<float>(i % 97);
+        a.y[i] = b.y[i] = static_cast<float>(i % 13) - 2.0f;
+        a.vx[i] = b.vx[i] = static_cast<float>(i % 7) - 3.0f;
+        a.vy[i] = b.vy[i] = -static_cast<float>(i % 11);
+        a.age[i] = b.age[i] = 0.0f;
+        a.invLifetime[i] = b.invLifetime[i] = 1.0f / (0.5f + static_cast<float>(i % 5));
+    }
+
+    float sizeCurve[PARTICLE_CURVE_SAMPLES];
+    uint32_t colorCurve[PARTICLE_CURVE_SAMPLES];
+    for (int s = 0; s < PARTICLE_CURVE_SAMPLES; ++s) {
+        sizeCurve[s] = static_cast<float>(s);
+        colorCurve[s] = 0xFF000000u | static_cast<uint32_t>(s);
+    }
+    ParticleKernelParams params;
+    params.dt = 1.0f / 60.0f;
+    params.accelY = -9.8f;
+    params.damping = 0.99f;
+    params.planeCount = 1;
+    params.planes[0] = ParticlePlane{0.0f, 1.0f, 0.0f};
+    params.sizeCurve = sizeCurve;
+    params.colorCurve = colorCurve;
+
+    for (int step = 0; step < 30; ++step) {
+        updateParticlesScalar(a, 0, count, params);
+        if (!updateParticlesAvx2(b, 0, count, params)) {
+            return 0; // Built without the AVX2 kernel
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (std::fabs(a.x[i] - b.x[i]) > 1e-3f || std::fabs(a.y[i] - b.y[i]) > 1e-3f) {
+            LOG_ERROR("Particle {} differs between kernels", i);
+            return 20;
+        }
+        if (a.y[i] < 0.0f || b.y[i] < 0.0f) {
+            LOG_ERROR("Particle {} is below the floor plane", i);
+            return 21;
+        }
+    }
+    return 0;
+}
+
+// Checks spawning, swap-remove compaction and quad output
+int testParticleSystem() {
+    ParticleSystem system(nullptr, 2);
+    EmitterDesc desc;
+    desc.rate = 0.0f;
+    desc.capacity = 500;
+    desc.lifetimeMin = 0.5f;
+    desc.lifetimeMax = 1.5f;
+    EmitterId first = system.addEmitter(desc);
+    system.addEmitter(desc);
+    system.burst(first, 800); // More than capacity, must clamp
+
+    system.update(0.1f);
+    if (system.getLiveCount() != 500) {
+        LOG_ERROR("Live particles after burst: {}", system.getLiveCount());
+        return 30;
+    }
+
+    // After a second, only particles with lifetime over 1.1 are left
+    for (int i = 0; i < 10; ++i) {
+        system.update(0.1f);
+    }
+    size_t alive = system.getLiveCount();
+    if (alive == 0 || alive >= 500) {
+        LOG_ERROR("Live particles after one second: {}", alive);
+        return 31;
+    }
+
+    VertexBatch batch;
+    system.writeVertices(batch);
+    if (batch.getQuadCount() != alive || batch.getDrawCallCount() != 1) {
+        LOG_ERROR("Quads written: {}", batch.getQuadCount());
+        return 32;
+    }
+
+    for (int i = 0; i < 10; ++i) {
+        system.update(0.1f);
+    }
+    if (system.getLiveCount() != 0) {
+        return 33;
+    }
+    return 0;
+}
+
+int test_particles() {
+    int result = testParticleKernels();
+    if (result != 0) {
+        return result;
+    }
+    return testParticleSystem();
+}
+
+#endif // PARTICLE_TEST_H
@@ -0,0 +1,86 @@
+#include "../src/physics/physics_world.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+// Drops bodyCount mixed circles and boxes into a wide container and reports
+// the average step time once the pile is in contact.
+// Usage: physics_bench [measuredSteps]
+
+static void buildScene(PhysicsWorld& world, int bodyCount) {
+    const int columns = 250;
+    const float width = columns * 1.0f;
+
+    BodyDef wall;
+    wall.type = BodyType::Static;
+    wall.position = Vec2(0.0f, -1.0f);
+    wall.shape = makeBox(width * 0.5f + 2.0f, 1.0f);
+    world.createBody(wall);
+    wall.shape = makeBox(1.0f, 200.0f);
+    wall.position = Vec2(-width * 0.5f - 1.0f, 200.0f);
+    world.createBody(wall);
+    wall.position = Vec2(width * 0.5f + 1.0f, 200.0f);
+    world.createBody(wall);
+
+    const Vec2 triangle[3] = { Vec2(-0.4f, -0.3f), Vec2(0.4f, -0.3f), Vec2(0.0f, 0.4f) };
+    for (int i = 0; i < bodyCount; ++i) {
+        BodyDef def;
+        int column = i % columns;
+        int row = i / columns;
+        def.position = Vec2(-width * 0.5f + 0.5f + column + 0.1f * (row % 3), 0.5f + row * 1.05f);
+        switch (i % 3) {
+            case 0: def.shape = makeCircle(0.45f); break;
+            case 1: def.shape = makeBox(0.4f, 0.4f); break;
+            default: def.shape = makePolygon(triangle, 3); break;
+        }
+        world.createBody(def);
+    }
+}
+
+int main(int argc, char const *argv[])
+{
+    const int measuredSteps = (argc > 1) ? std::atoi(argv[1]) : 120;
+    const int warmupSteps = 60;
+    const int bodyCounts[] = { 10000, 50000 };
+    const size_t threadCounts[] = { 1, 2, 4, 8 };
+    const float dt = 1.0f / 60.0f;
+
+    std::cout << std::setw(8) << "bodies" << std::setw(9) << "threads"
+              << std::setw(12) << "ms/step" << std::setw(10) << "speedup"
+              << std::setw(11) << "contacts" << std::setw(9) << "islands"
+              << std::setw(8) << "awake" << "\n";
+
+    for (int bodyCount : bodyCounts) {
+        double singleThreadMs = 0.0;
+        for (size_t threads : threadCounts) {
+            WorldSettings settings;
+            settings.threadCount = threads;
+            PhysicsWorld world(settings);
+            buildScene(world, bodyCount);
+
+            for (int i = 0; i < warmupSteps; ++i) {
+                world.step(dt);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < measuredSteps; ++i) {
+                world.step(dt);
+            }
+            auto end = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(end - start).count() / measuredSteps;
+            if (threads == 1) {
+                singleThreadMs = ms;
+            }
+
+            std::cout << std::setw(8) << bodyCount << std::setw(9) << threads
+                      << std::setw(12) << std::fixed << std::setprecision(3) << ms
+                      << std::setw(10) << std::setprecision(2) << (singleThreadMs / ms)
+                      << std::setw(11) << world.getContactCount()
+                      << std::setw(9) << world.getIslandCount()
+                      << std::setw(8) << world.getAwakeBodyCount() << "\n";
+        }
+    }
+    return 0;
+}
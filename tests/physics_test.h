@@ -0,0 +1,115 @@
+#ifndef PHYSICS_TEST_H
+#define PHYSICS_TEST_H
+
+#include "../src/log/log.h"
+#include "../src/physics/physics_world.h"
+
+#include <cmath>
+#include <cstring>
+
+// Ground box plus a small pile of mixed shapes, used by the checks below
+void buildPhysicsScene(PhysicsWorld& world) {
+    BodyDef ground;
+    ground.type = BodyType::Static;
+    ground.position = Vec2(0.0f, -1.0f);
+    ground.shape = makeBox(50.0f, 1.0f);
+    world.createBody(ground);
+
+    for (int i = 0; i < 40; ++i) {
+        BodyDef def;
+        def.position = Vec2(-4.0f + static_cast<float>(i % 8), 1.0f + static_cast<float>(i / 8) * 1.1f);
+        def.angle = 0.1f * static_cast<float>(i % 3);
+        def.shape = (i % 2 == 0) ? makeBox(0.4f, 0.4f) : makeCircle(0.45f);
+        world.createBody(def);
+    }
+}
+
+// Checks that a body dropped on the ground comes to rest on top of it
+int testPhysicsResting() {
+    WorldSettings settings;
+    PhysicsWorld world(settings);
+
+    BodyDef ground;
+    ground.type = BodyType::Static;
+    ground.shape = makeBox(10.0f, 0.5f);
+    world.createBody(ground);
+
+    BodyDef box;
+    box.position = Vec2(0.0f, 3.0f);
+    box.shape = makeBox(0.5f, 0.5f);
+    BodyId boxId = world.createBody(box);
+
+    BodyDef ball;
+    ball.position = Vec2(3.0f, 3.0f);
+    ball.shape = makeCircle(0.5f);
+    BodyId ballId = world.createBody(ball);
+
+    for (int i = 0; i < 240; ++i) {
+        world.step(1.0f / 60.0f);
+    }
+
+    // Resting height is ground top (0.5) plus half extent (0.5)
+    if (std::fabs(world.getBody(boxId).position.y - 1.0f) > 0.05f) {
+        LOG_ERROR("Box resting height: {}", world.getBody(boxId).position.y);
+        return 1;
+    }
+    if (std::fabs(world.getBody(ballId).position.y - 1.0f) > 0.05f) {
+        LOG_ERROR("Ball resting height: {}", world.getBody(ballId).position.y);
+        return 2;
+    }
+    // Both should have fallen asleep by now
+    if (world.getAwakeBodyCount() != 0) {
+        LOG_ERROR("Awake bodies after settling: {}", world.getAwakeBodyCount());
+        return 3;
+    }
+
+    // Touching a sleeping body wakes it up again
+    world.applyLinearImpulse(boxId, Vec2(0.0f, 5.0f));
+    world.step(1.0f / 60.0f);
+    if (world.getAwakeBodyCount() == 0 || world.getBody(boxId).position.y <= 1.0f) {
+        return 4;
+    }
+    return 0;
+}
+
+// Checks that the same scene gives bit-identical results on 1 and 4 threads
+int testPhysicsDeterminism() {
+    WorldSettings single;
+    single.threadCount = 1;
+    WorldSettings multi;
+    multi.threadCount = 4;
+    PhysicsWorld worldA(single);
+    PhysicsWorld worldB(multi);
+    buildPhysicsScene(worldA);
+    buildPhysicsScene(worldB);
+
+    for (int i = 0; i < 120; ++i) {
+        worldA.step(1.0f / 60.0f);
+        worldB.step(1.0f / 60.0f);
+    }
+
+    for (size_t i = 0; i < worldA.getBodyCount(); ++i) {
+        const Body& a = worldA.getBody(static_cast<BodyId>(i));
+        const Body& b = worldB.getBody(static_cast<BodyId>(i));
+        if (std::memcmp(&a.position, &b.position, sizeof(Vec2)) != 0 || a.angle != b.angle) {
+            LOG_ERROR("Body {} diverged between thread counts", i);
+            return 10;
+        }
+        // Nothing should tunnel through the ground
+        if (a.type == BodyType::Dynamic && a.position.y < 0.0f) {
+            LOG_ERROR("Body {} fell through the ground", i);
+            return 11;
+        }
+    }
+    return 0;
+}
+
+int test_physics() {
+    int result = testPhysicsResting();
+    if (result != 0) {
+        return result;
+    }
+    return testPhysicsDeterminism();
+}
+
+#endif // PHYSICS_TEST_H
@@ -0,0 +1,78 @@
+#include "../src/core/string_id.h"
+#include "../src/core/string_id_map.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Lookup benchmark: asset-style names in std::unordered_map<std::string, T>
+// against the same entries in StringIdMap<T> keyed by precomputed ids.
+// Usage: string_id_bench [entries] [lookups]
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char const *argv[])
+{
+    const size_t entries = (argc > 1) ? static_cast<size_t>(std::atoi(argv[1])) : 10000;
+    const size_t lookups = (argc > 2) ? static_cast<size_t>(std::atoi(argv[2])) : 10000000;
+
+    std::vector<std::string> names;
+    names.reserve(entries);
+    for (size_t i = 0; i < entries; ++i) {
+        names.push_back("assets/textures/props/prop_" + std::to_string(i) + ".png");
+    }
+
+    std::unordered_map<std::string, uint32_t> byString;
+    StringIdMap<uint32_t> byId;
+    std::vector<StringId> ids;
+    for (size_t i = 0; i < entries; ++i) {
+        byString.emplace(names[i], static_cast<uint32_t>(i));
+        ids.push_back(internStringId(names[i]));
+        byId.insert(ids.back(), static_cast<uint32_t>(i));
+    }
+
+    // The same pseudo-random access order for every variant
+    std::vector<uint32_t> order(lookups);
+    uint32_t rng = 0x2545F491u;
+    for (size_t i = 0; i < lookups; ++i) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        order[i] = rng % entries;
+    }
+
+    uint64_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; ++i) {
+        sink += byString.find(names[order[i]])->second;
+    }
+    double stringMs = elapsedMs(start);
+
+    // Callers usually hold a literal, which has to become a std::string
+    // (and here, past the small string buffer, an allocation) first
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; ++i) {
+        sink += byString.find(std::string(names[order[i]].c_str()))->second;
+    }
+    double literalMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; ++i) {
+        sink += *byId.find(ids[order[i]]);
+    }
+    double idMs = elapsedMs(start);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << entries << " entries, " << lookups << " lookups (checksum " << sink % 1000 << ")\n";
+    std::cout << "  unordered_map<string>, string key:  " << stringMs * 1e6 / lookups << " ns/lookup\n";
+    std::cout << "  unordered_map<string>, char* key:   " << literalMs * 1e6 / lookups << " ns/lookup\n";
+    std::cout << "  StringIdMap, precomputed id:        " << idMs * 1e6 / lookups << " ns/lookup ("
+              << stringMs / idMs << "x)\n";
+    return 0;
+}
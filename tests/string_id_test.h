@@ -0,0 +1,95 @@
+#ifndef STRING_ID_TEST_H
+#define STRING_ID_TEST_H
+
+#include "../src/core/string_id.h"
+#include "../src/core/string_id_map.h"
+#include "../src/log/log.h"
+#include "../tools/datafile_integrity.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+// Published FNV-1a 64 test vectors, checked by the compiler
+static_assert(""_sid.getHash() == 0xcbf29ce484222325ULL, "FNV-1a of the empty string");
+static_assert("a"_sid.getHash() == 0xaf63dc4c8601ec8cULL, "FNV-1a of \"a\"");
+static_assert("foobar"_sid == StringId(0x85944171f73967e8ULL), "FNV-1a of \"foobar\"");
+
+// Literal, runtime and file hashes agree, and names round-trip in builds
+// that keep them
+int testStringIds() {
+    if (StringId(std::string("foobar")) != "foobar"_sid) {
+        return 70;
+    }
+
+    // The file checksum is FNV-1a of the contents with the size mixed in
+    const char* path = "string_id_test.tmp";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "foobar";
+    }
+    uint_fast64_t fileHash = calculateFileHash(path);
+    std::remove(path);
+    if (fileHash != ((fnv1a("foobar", 6) ^ 6u) * FNV1A_PRIME)) {
+        return 71;
+    }
+
+    if (registerStringId(StringId(), "", 0)) {
+        return 72; // The invalid id is reserved
+    }
+    if (!stringIdNamesEnabled()) {
+        return 0;
+    }
+    StringId goblin = internStringId("enemy/goblin");
+    const char* name = getStringIdName(goblin);
+    if (goblin != "enemy/goblin"_sid || !name || std::string(name) != "enemy/goblin") {
+        return 73;
+    }
+    // A second name under a taken id is a collision, the same name is not
+    StringId taken(0x1234u);
+    if (!registerStringId(taken, "first", 5) || registerStringId(taken, "second", 6) ||
+        !registerStringId(taken, "first", 5) || std::string(getStringIdName(taken)) != "first") {
+        return 74;
+    }
+    return 0;
+}
+
+int testStringIdMap() {
+    StringIdMap<int> map;
+    const int count = 1000;
+    for (int i = 0; i < count; ++i) {
+        if (!map.insert(StringId("asset/" + std::to_string(i)), i)) {
+            return 75;
+        }
+    }
+    if (map.size() != count || map.insert("asset/7"_sid, 0) || map.insert(StringId(), 0)) {
+        return 76;
+    }
+    for (int i = 0; i < count; i += 2) {
+        if (!map.erase(StringId("asset/" + std::to_string(i)))) {
+            return 77;
+        }
+    }
+    // Erasing shifts entries back, every survivor must still be reachable
+    for (int i = 0; i < count; ++i) {
+        const int* value = map.find(StringId("asset/" + std::to_string(i)));
+        if ((i % 2 == 0) != (value == nullptr) || (value && *value != i)) {
+            LOG_ERROR("Lookup of asset/{} after erase is wrong", i);
+            return 78;
+        }
+    }
+    if (map.size() != count / 2 || map.find("asset/1000"_sid) != nullptr) {
+        return 79;
+    }
+    return 0;
+}
+
+int test_string_id() {
+    int result = testStringIds();
+    if (result != 0) {
+        return result;
+    }
+    return testStringIdMap();
+}
+
+#endif // STRING_ID_TEST_H
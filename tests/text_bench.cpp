@@ -0,0 +1,93 @@
+#include "../src/renderer/builtin_font.h"
+#include "../src/renderer/text_renderer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Headless text benchmark: 10k strings change every frame and are drawn
+// through the layout cache and glyph atlas. Reports glyph throughput and
+// cache hit rates for two workloads:
+//   counters - values from a bounded range (damage numbers, HUD stats),
+//              so changed strings have usually been seen before
+//   labels   - coordinates that are new nearly every frame, the miss path
+// Usage: text_bench [frames] [strings]
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void runWorkload(const char* name, bool labels, int frames, int stringCount) {
+    TextRenderer text(nullptr);
+    FontId font = text.addFont(makeBuiltinFont());
+    const int sizes[] = {12, 16, 24};
+    const SDL_FColor white = {1.0f, 1.0f, 1.0f, 1.0f};
+    VertexBatch batch;
+    std::vector<std::string> strings(stringCount);
+
+    uint32_t rng = 0x12345678u;
+    auto next = [&rng]() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    };
+    char buffer[64];
+    auto refresh = [&](int frame) {
+        for (int i = 0; i < stringCount; ++i) {
+            if (labels) {
+                std::snprintf(buffer, sizeof(buffer), "unit %d at %d,%d", i, frame * 3 + i % 7, static_cast<int>(next() % 4096));
+            } else {
+                std::snprintf(buffer, sizeof(buffer), "%u", next() % 1000);
+            }
+            strings[i] = buffer;
+        }
+    };
+
+    double totalMs = 0.0;
+    const int warmup = 10;
+    for (int f = 0; f < warmup + frames; ++f) {
+        refresh(f); // String formatting is the caller's cost, not timed
+        if (f == warmup) {
+            text.resetStats();
+            totalMs = 0.0;
+        }
+        auto start = std::chrono::steady_clock::now();
+        text.beginFrame();
+        for (int i = 0; i < stringCount; ++i) {
+            float x = static_cast<float>((i % 100) * 19);
+            float y = static_cast<float>((i / 100) * 11);
+            text.drawText(strings[i], font, sizes[i % 3], x, y, white);
+        }
+        batch.clear();
+        text.writeVertices(batch);
+        totalMs += elapsedMs(start);
+    }
+
+    const TextStats& stats = text.getStats();
+    double layoutHitRate = 100.0 * static_cast<double>(stats.layoutHits) / static_cast<double>(stats.layoutHits + stats.layoutMisses);
+    size_t glyphLookups = stats.glyphHits + stats.glyphMisses;
+    double glyphHitRate = glyphLookups ? 100.0 * static_cast<double>(stats.glyphHits) / static_cast<double>(glyphLookups) : 100.0;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << name << ": " << stringCount << " strings/frame, " << stats.glyphsDrawn / frames << " glyphs/frame\n";
+    std::cout << "  frame:            " << totalMs / frames << " ms\n";
+    std::cout << "  throughput:       " << std::setprecision(1)
+              << static_cast<double>(stats.glyphsDrawn) / (totalMs / 1000.0) / 1e6 << " M glyphs/s\n";
+    std::cout << "  layout hit rate:  " << layoutHitRate << " %\n";
+    std::cout << "  glyph hit rate:   " << glyphHitRate << " % of " << glyphLookups / frames << " lookups/frame\n";
+    std::cout << "  atlas:            " << text.getAtlas().getResidentCount() << " glyphs, "
+              << text.getAtlas().getEvictionCount() << " evictions, " << stats.droppedGlyphs << " dropped\n";
+}
+
+int main(int argc, char const *argv[])
+{
+    const int frames = (argc > 1) ? std::atoi(argv[1]) : 200;
+    const int strings = (argc > 2) ? std::atoi(argv[2]) : 10000;
+    runWorkload("counters", false, frames, strings);
+    runWorkload("labels", true, frames, strings);
+    return 0;
+}
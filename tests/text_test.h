@@ -0,0 +1,173 @@
+#ifndef TEXT_TEST_H
+#define TEXT_TEST_H
+
+#include "../src/log/log.h"
+#include "../src/renderer/builtin_font.h"
+#include "../src/renderer/text_renderer.h"
+
+#include <string>
+
+// The built-in font at 9 pixels is its 5x7 grid one to one
+int testBuiltinFont() {
+    GlyphBitmap glyph;
+    if (!rasterizeBuiltinGlyph('T', 9, glyph) || glyph.width != 5 || glyph.height != 7 || glyph.advance != 6.0f) {
+        return 50;
+    }
+    // Top bar fully covered, then only the middle column
+    for (int x = 0; x < 5; ++x) {
+        if (glyph.coverage[x] != 255 || glyph.coverage[5 + x] != (x == 2 ? 255 : 0)) {
+            return 51;
+        }
+    }
+    if (!rasterizeBuiltinGlyph(' ', 9, glyph) || glyph.width != 0 || rasterizeBuiltinGlyph(0x263A, 9, glyph)) {
+        return 52;
+    }
+    return 0;
+}
+
+// Checks layout caching, quad output and atlas eviction
+int testTextRenderer() {
+    TextRenderer text(nullptr, 128, 4); // 64 cells of 16 pixels, 4 layouts
+    FontId font = text.addFont(makeBuiltinFont());
+    const SDL_FColor red = {1.0f, 0.0f, 0.0f, 1.0f};
+
+    text.beginFrame();
+    text.drawText("Hi there", font, 9, 10.2f, 20.0f, red);
+    VertexBatch batch;
+    text.writeVertices(batch);
+    if (batch.getQuadCount() != 7 || text.getStats().layoutMisses != 1) {
+        LOG_ERROR("Glyph quads: {}", batch.getQuadCount());
+        return 53;
+    }
+    // 'H' at the rounded origin, one font unit down from the line top
+    const SDL_Vertex* v = batch.getQuadVertices(0);
+    if (v[0].position.x != 10.0f || v[0].position.y != 21.0f || v[2].position.x != 15.0f ||
+        v[2].position.y != 28.0f || v[1].tex_coord.x <= v[0].tex_coord.x ||
+        v[3].tex_coord.y <= v[0].tex_coord.y || v[3].color.r != 1.0f || v[3].color.g != 0.0f) {
+        return 54;
+    }
+    // 'i' follows one advance later
+    if (batch.getQuadVertices(1)[0].position.x != 16.0f) {
+        return 55;
+    }
+
+    // Drawing it again is a cache hit that touches no glyph lookups
+    text.beginFrame();
+    text.resetStats();
+    text.drawText("Hi there", font, 9, 10.0f, 20.0f, red);
+    if (text.getStats().layoutHits != 1 || text.getStats().glyphHits + text.getStats().glyphMisses != 0) {
+        return 56;
+    }
+    SDL_FPoint size = text.measureText("ab\ncd", font, 9);
+    if (size.x != 12.0f || size.y != 18.0f) {
+        return 57;
+    }
+    text.writeVertices(batch);
+
+    // Fill the atlas with 64 glyphs in one frame, which evicts the ten
+    // from above, then 30 new ones next frame must evict 30 more
+    std::string first;
+    std::string second;
+    for (char c = 33; c < 97; ++c) {
+        first += c;
+    }
+    for (char c = 97; c < 127; ++c) {
+        second += c;
+    }
+    text.beginFrame();
+    text.drawText(first, font, 10, 0.0f, 0.0f, red);
+    uint64_t evictions = text.getAtlas().getEvictionCount();
+    text.beginFrame();
+    text.drawText(second, font, 10, 0.0f, 0.0f, red);
+    evictions = text.getAtlas().getEvictionCount() - evictions;
+    if (evictions != 30 || text.getStats().droppedGlyphs != 0) {
+        LOG_ERROR("Evictions: {}", evictions);
+        return 58;
+    }
+
+    // The first string lost glyphs, so its cached layout is rebuilt and
+    // anything that does not fit this frame is dropped, not overwritten
+    text.beginFrame();
+    text.resetStats();
+    text.drawText(first, font, 10, 0.0f, 0.0f, red);
+    text.drawText(second, font, 10, 0.0f, 20.0f, red);
+    if (text.getStats().glyphMisses == 0 || text.getStats().droppedGlyphs == 0) {
+        return 59;
+    }
+    batch.clear();
+    text.writeVertices(batch);
+    if (batch.getQuadCount() != 64 + 30 - text.getStats().droppedGlyphs) {
+        return 60;
+    }
+
+    // The layout cache stays near its capacity
+    for (int i = 0; i < 20; ++i) {
+        text.beginFrame();
+        text.drawText(std::to_string(i), font, 9, 0.0f, 0.0f, red);
+    }
+    if (text.getCachedLayoutCount() > 4) {
+        LOG_ERROR("Cached layouts: {}", text.getCachedLayoutCount());
+        return 61;
+    }
+    return 0;
+}
+
+// Square glyph bitmap of the given size, all covered
+GlyphBitmap solidGlyph(int size) {
+    GlyphBitmap glyph;
+    glyph.width = size;
+    glyph.height = size;
+    glyph.coverage.assign(static_cast<size_t>(size) * size, 255);
+    return glyph;
+}
+
+// A size class that finds the page full of another class takes its
+// shelves over once they are no longer in use this frame
+int testGlyphAtlasShelves() {
+    GlyphAtlas atlas(nullptr, 128); // One shelf of 128 or eight of 16
+    const GlyphBitmap small = solidGlyph(10);
+    const GlyphBitmap large = solidGlyph(100);
+    atlas.beginFrame();
+    for (uint64_t key = 1; key <= 64; ++key) {
+        if (atlas.insert(key, small) == GlyphAtlas::NO_GLYPH) {
+            return 62;
+        }
+    }
+    const uint32_t smallSlot = atlas.find(1);
+    const uint32_t smallGeneration = atlas.getGeneration(smallSlot);
+
+    // Every small glyph is still in use this frame
+    if (atlas.insert(100, large) != GlyphAtlas::NO_GLYPH) {
+        return 63;
+    }
+    atlas.beginFrame();
+    const uint64_t evictions = atlas.getEvictionCount();
+    const uint32_t largeSlot = atlas.insert(100, large);
+    if (largeSlot == GlyphAtlas::NO_GLYPH || atlas.getResidentCount() != 1 ||
+        atlas.getEvictionCount() - evictions != 64 || atlas.find(1) != GlyphAtlas::NO_GLYPH ||
+        atlas.getGeneration(smallSlot) == smallGeneration || atlas.getGlyph(largeSlot).v0 != 0.0f) {
+        LOG_ERROR("Resident glyphs after taking the page over: {}", atlas.getResidentCount());
+        return 64;
+    }
+
+    // And back again once the large glyph is idle
+    atlas.beginFrame();
+    if (atlas.insert(1, small) == GlyphAtlas::NO_GLYPH || atlas.find(100) != GlyphAtlas::NO_GLYPH) {
+        return 65;
+    }
+    return 0;
+}
+
+int test_text() {
+    int result = testBuiltinFont();
+    if (result != 0) {
+        return result;
+    }
+    result = testGlyphAtlasShelves();
+    if (result != 0) {
+        return result;
+    }
+    return testTextRenderer();
+}
+
+#endif // TEXT_TEST_H
@@ -0,0 +1,127 @@
+#include "../src/renderer/tilemap.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Headless tilemap benchmark: a 1024x1024 map with two layers and animated
+// water, a camera panning across it and a few edits per frame. Compares the
+// cached chunk path against rebuilding every visible tile quad each frame.
+// Usage: tilemap_bench [frames] [editsPerFrame]
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char const *argv[])
+{
+    const int frames = (argc > 1) ? std::atoi(argv[1]) : 600;
+    const int editsPerFrame = (argc > 2) ? std::atoi(argv[2]) : 4;
+    const int size = 1024;
+    const float tileSize = 16.0f;
+    const float dt = 1.0f / 60.0f;
+
+    TilesetDesc tileset;
+    tileset.columns = 16;
+    tileset.rows = 16;
+    Tilemap map(size, size, 2, tileSize, tileset, 32);
+
+    uint32_t rng = 12345u;
+    auto next = [&rng]() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    };
+    std::vector<std::vector<TileId>> reference(2, std::vector<TileId>(static_cast<size_t>(size) * size, 0));
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            // Ground everywhere, water (id 1) on a few percent, props on layer 1
+            TileId ground = (next() % 100 < 5) ? 1 : static_cast<TileId>(2 + next() % 30);
+            map.setTile(0, x, y, ground);
+            reference[0][static_cast<size_t>(y) * size + x] = ground;
+            if (next() % 100 < 20) {
+                TileId prop = static_cast<TileId>(40 + next() % 40);
+                map.setTile(1, x, y, prop);
+                reference[1][static_cast<size_t>(y) * size + x] = prop;
+            }
+        }
+    }
+    map.setTileAnimation(1, {200, 201, 202, 203}, 0.25f);
+
+    Camera2D camera;
+    camera.viewportWidth = 1920.0f;
+    camera.viewportHeight = 1080.0f;
+    VertexBatch batch;
+    map.render(batch, camera); // Warm up the starting view
+
+    double cachedMs = 0.0;
+    long long visibleChunks = 0;
+    long long rebuilds = 0;
+    size_t quads = 0;
+    for (int f = 0; f < frames; ++f) {
+        camera.x = static_cast<float>(f) * 20.0f;
+        camera.y = static_cast<float>(f) * 8.0f;
+        auto start = std::chrono::steady_clock::now();
+        for (int e = 0; e < editsPerFrame; ++e) {
+            // Edits land near the view, like a player digging
+            int x = static_cast<int>(camera.x / tileSize) + static_cast<int>(next() % 120);
+            int y = static_cast<int>(camera.y / tileSize) + static_cast<int>(next() % 68);
+            map.setTile(1, x, y, static_cast<TileId>(next() % 80));
+        }
+        map.update(dt);
+        batch.clear();
+        map.render(batch, camera);
+        cachedMs += elapsedMs(start);
+        visibleChunks += map.getVisibleChunkCount();
+        rebuilds += map.getRebuiltChunkCount();
+        quads += batch.getQuadCount();
+    }
+
+    // Naive path: one quad per visible non-empty tile, UVs resolved every frame
+    double naiveMs = 0.0;
+    const SDL_FColor white = {1.0f, 1.0f, 1.0f, 1.0f};
+    for (int f = 0; f < frames; ++f) {
+        camera.x = static_cast<float>(f) * 20.0f;
+        camera.y = static_cast<float>(f) * 8.0f;
+        auto start = std::chrono::steady_clock::now();
+        batch.clear();
+        int x0 = static_cast<int>(camera.getLeft() / tileSize);
+        int y0 = static_cast<int>(camera.getTop() / tileSize);
+        int x1 = std::min(size - 1, static_cast<int>(camera.getRight() / tileSize));
+        int y1 = std::min(size - 1, static_cast<int>(camera.getBottom() / tileSize));
+        for (int layer = 0; layer < 2; ++layer) {
+            for (int y = y0; y <= y1; ++y) {
+                for (int x = x0; x <= x1; ++x) {
+                    TileId tile = reference[layer][static_cast<size_t>(y) * size + x];
+                    if (tile == 0) {
+                        continue;
+                    }
+                    int atlas = (tile == 1) ? 200 + (f / 15) % 4 : tile - 1;
+                    float u0 = static_cast<float>(atlas % 16) / 16.0f;
+                    float v0 = static_cast<float>(atlas / 16) / 16.0f;
+                    float left = static_cast<float>(x) * tileSize - camera.x;
+                    float top = static_cast<float>(y) * tileSize - camera.y;
+                    SDL_Vertex* v = batch.getQuadVertices(batch.reserveQuads(nullptr, 1));
+                    v[0] = SDL_Vertex{ {left, top}, white, {u0, v0} };
+                    v[1] = SDL_Vertex{ {left + tileSize, top}, white, {u0 + 0.0625f, v0} };
+                    v[2] = SDL_Vertex{ {left + tileSize, top + tileSize}, white, {u0 + 0.0625f, v0 + 0.0625f} };
+                    v[3] = SDL_Vertex{ {left, top + tileSize}, white, {u0, v0 + 0.0625f} };
+                }
+            }
+        }
+        naiveMs += elapsedMs(start);
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << size << "x" << size << " map, 2 layers, " << map.getChunkCount() << " chunks, "
+              << editsPerFrame << " edits/frame\n";
+    std::cout << "  visible chunks:  " << static_cast<double>(visibleChunks) / frames << " per frame\n";
+    std::cout << "  chunk rebuilds:  " << static_cast<double>(rebuilds) / frames << " per frame\n";
+    std::cout << "  quads:           " << quads / frames << " per frame\n";
+    std::cout << "  cached chunks:   " << cachedMs / frames << " ms/frame\n";
+    std::cout << "  per-tile rebuild: " << naiveMs / frames << " ms/frame\n";
+    return 0;
+}
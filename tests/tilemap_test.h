@@ -0,0 +1,92 @@
+#ifndef TILEMAP_TEST_H
+#define TILEMAP_TEST_H
+
+#include "../src/log/log.h"
+#include "../src/renderer/tilemap.h"
+
+// Checks chunk culling, dirty-chunk rebuilds and that animation only
+// changes UVs without rebuilding cached geometry
+int test_tilemap() {
+    TilesetDesc tileset;
+    tileset.columns = 4;
+    tileset.rows = 4;
+    Tilemap map(256, 256, 2, 16.0f, tileset, 32); // 8x8 chunks of 512 px
+    for (int y = 0; y < map.getHeight(); ++y) {
+        for (int x = 0; x < map.getWidth(); ++x) {
+            map.setTile(0, x, y, static_cast<TileId>(1 + (x + y) % 3));
+        }
+    }
+    map.setTile(1, 5, 5, 4);
+    map.setTileAnimation(2, {1, 2, 3}, 0.1f);
+
+    // 800x600 at the origin touches 2x2 chunks
+    Camera2D camera;
+    VertexBatch batch;
+    map.render(batch, camera);
+    if (map.getVisibleChunkCount() != 4 || map.getRebuiltChunkCount() != 4) {
+        LOG_ERROR("Visible chunks: {}, rebuilt: {}", map.getVisibleChunkCount(), map.getRebuiltChunkCount());
+        return 40;
+    }
+    // Layer 0 quads of map rows 0..37 and columns 0..50, plus the prop
+    const size_t visibleQuads = 38 * 51 + 1;
+    if (batch.getQuadCount() != visibleQuads || batch.getDrawCallCount() != 1) {
+        LOG_ERROR("Tile quads: {}", batch.getQuadCount());
+        return 41;
+    }
+
+    // Nothing changed, nothing is rebuilt, animation included
+    batch.clear();
+    map.update(0.15f);
+    map.render(batch, camera);
+    if (map.getRebuiltChunkCount() != 0) {
+        return 42;
+    }
+    // A lone animated tile shows the current frame after update
+    Tilemap small(4, 4, 1, 16.0f, tileset, 4);
+    small.setTile(0, 1, 0, 2);
+    small.setTileAnimation(2, {1, 2, 3}, 0.1f);
+    VertexBatch smallBatch;
+    small.render(smallBatch, camera);
+    small.update(0.15f);
+    smallBatch.clear();
+    small.render(smallBatch, camera);
+    const SDL_Vertex* quad = smallBatch.getQuadVertices(0);
+    if (small.getRebuiltChunkCount() != 0 || quad[0].tex_coord.x != 0.5f || quad[0].position.x != 16.0f) {
+        LOG_ERROR("Animated tile UV: {}", quad[0].tex_coord.x);
+        return 43;
+    }
+
+    // An edit dirties only its own chunk, an unchanged write nothing
+    map.setTile(0, 40, 3, 0);
+    map.setTile(0, 41, 3, map.getTile(0, 41, 3));
+    batch.clear();
+    map.render(batch, camera);
+    if (map.getRebuiltChunkCount() != 1 || batch.getQuadCount() != visibleQuads - 1) {
+        return 44;
+    }
+
+    // Camera offset and zoom are applied on the way into the batch. The
+    // view starts at column 37, which is animated, so the first static
+    // quad in the batch is column 38.
+    camera.x = 600.0f;
+    camera.y = 10.0f;
+    camera.zoom = 2.0f;
+    batch.clear();
+    map.render(batch, camera);
+    quad = batch.getQuadVertices(0);
+    if (map.getVisibleChunkCount() != 1 || quad[0].position.x != (38.0f * 16.0f - 600.0f) * 2.0f) {
+        LOG_ERROR("Zoomed view: {} chunks, first quad at {}", map.getVisibleChunkCount(), quad[0].position.x);
+        return 45;
+    }
+
+    // Off the map entirely
+    camera.x = -5000.0f;
+    batch.clear();
+    map.render(batch, camera);
+    if (map.getVisibleChunkCount() != 0 || batch.getQuadCount() != 0) {
+        return 46;
+    }
+    return 0;
+}
+
+#endif // TILEMAP_TEST_H
@@ -1,6 +1,6 @@
 #ifndef INTEGRITY_H
 #define INTEGRITY_H
-#include <iostream>
+#include "../src/log/log.h" // Asynchronous logger for test output
 #include <string>
 #include <vector>
 #include <memory>
@@ -344,19 +344,19 @@ void testMemoryAlignment() {
     };
     
     AlignedStruct s;
-     std::cout << "AlignedStruct alignment: "
-              << (reinterpret_cast<uintptr_t>(&s) % 64 == 0 ? "correct" : "incorrect") << "\n";
+    LOG_INFO("AlignedStruct alignment: {}",
+             reinterpret_cast<uintptr_t>(&s) % 64 == 0 ? "correct" : "incorrect");
     
     // Simpler approach using aligned objects directly
     alignas(16) int aligned_int = 42;
-    std::cout << "Aligned int value: " << aligned_int << "\n";
-    std::cout << "Aligned int alignment: "
-              << (reinterpret_cast<uintptr_t>(&aligned_int) % 16 == 0 ? "correct" : "incorrect") << "\n";
+    LOG_INFO("Aligned int value: {}", aligned_int);
+    LOG_INFO("Aligned int alignment: {}",
+             reinterpret_cast<uintptr_t>(&aligned_int) % 16 == 0 ? "correct" : "incorrect");
     
     // Test with std::vector which handles alignment internally
     std::vector<double> aligned_vector(5, 3.14);
-    std::cout << "Vector alignment: "
-              << (reinterpret_cast<uintptr_t>(aligned_vector.data()) % alignof(double) == 0 ? "correct" : "incorrect") << "\n";
+    LOG_INFO("Vector alignment: {}",
+             reinterpret_cast<uintptr_t>(aligned_vector.data()) % alignof(double) == 0 ? "correct" : "incorrect");
 }
 
 // Test SFINAE
@@ -375,10 +375,8 @@ auto sum(Args... args) {
 void testTemplateMetaprogramming() {
     // std::cout << "\n===== Testing Template Metaprogramming =====\n";
     
-    std::cout << "Vector has size(): " 
-              << std::boolalpha << decltype(testHasSize<std::vector<int>>(0))::value << "\n";
-    std::cout << "Int has size(): " 
-              << std::boolalpha << decltype(testHasSize<int>(0))::value << "\n";
+    LOG_INFO("Vector has size(): {}", decltype(testHasSize<std::vector<int>>(0))::value);
+    LOG_INFO("Int has size(): {}", decltype(testHasSize<int>(0))::value);
     
     // std::cout << "Sum of 1,2,3,4,5: " << sum(1,2,3,4,5) << "\n";
 }
@@ -413,12 +411,12 @@ void testOptimization() {
     auto start = std::chrono::high_resolution_clock::now();
     volatile int sum = 0;
     for (int i = 0; i < 10000000; ++i) {
-        sum += i & 1;
+        sum = sum + (i & 1);
     }
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double, std::milli> elapsed = end - start;
     
-    std::cout << "Loop execution time: " << elapsed.count() << "ms\n";
+    LOG_INFO("Loop execution time: {}ms", elapsed.count());
 }
 int test_a() {
     // std::cout << "Testing the Rule of Three/Five/Zero\n";
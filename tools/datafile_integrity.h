@@ -1,7 +1,6 @@
 #ifndef DATAFILE_INTEGRITY_H
 #define DATAFILE_INTEGRITY_H
 
-#include <iostream>
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -9,6 +8,8 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>  // For setw, setfill
+#include "../src/core/fnv1a.h" // Shared FNV-1a step and parameters
+#include "../src/log/log.h" // Asynchronous logger for error reports
 
 namespace fs = std::filesystem;
 
@@ -43,14 +44,11 @@ uint_fast64_t calculateFileHash(const std::string &filePath)
     std::ifstream file(filePath, std::ios::binary);
     if (!file)
     {
-        std::cerr << "Error opening file for hashing: " << filePath << std::endl;
+        LOG_ERROR("Error opening file for hashing: {}", filePath);
         return 0;
     }
-    // FNV-1a hash parameters
-    const uint_fast64_t FNV_PRIME = 1099511628211ULL;
-    const uint_fast64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
     // Initialize hash value
-    uint_fast64_t hash = FNV_OFFSET_BASIS;
+    uint_fast64_t hash = FNV1A_OFFSET_BASIS;
     // Use a buffer for efficient reading
     char buffer[16384]; // 16KB buffer
     // Process the file in chunks
@@ -60,13 +58,8 @@ uint_fast64_t calculateFileHash(const std::string &filePath)
         std::streamsize bytesRead = file.gcount();
         if (bytesRead == 0)
             break;
-        // Process each byte in the buffer
-        for (std::streamsize i = 0; i < bytesRead; ++i)
-        {
-            // FNV-1a hash algorithm
-            hash ^= static_cast<unsigned char>(buffer[i]);
-            hash *= FNV_PRIME;
-        }
+        // FNV-1a over the chunk, continuing from the previous one
+        hash = fnv1a(buffer, static_cast<size_t>(bytesRead), hash);
     }
     // Get file size
     uint_fast64_t fileSize = 0;
@@ -75,7 +68,7 @@ uint_fast64_t calculateFileHash(const std::string &filePath)
         fileSize = fs::file_size(filePath);
         // Mix in the file size
         hash ^= fileSize;
-        hash *= FNV_PRIME;
+        hash *= FNV1A_PRIME;
     }
     catch (...)
     {
@@ -115,7 +108,7 @@ std::vector<FileInfo> listFilesWithHash(const std::string &path)
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Error processing directory: " << path << " - " << e.what() << std::endl;
+        LOG_ERROR("Error processing directory: {} - {}", path, e.what());
     }
     return fileInfoList;
 }
@@ -126,7 +119,7 @@ bool saveFileInfoToTxt(const std::vector<FileInfo> &fileInfoList, const std::str
     std::ofstream outFile(outputPath);
     if (!outFile)
     {
-        std::cerr << "Error creating output file: " << outputPath << std::endl;
+        LOG_ERROR("Error creating output file: {}", outputPath);
         return false;
     }
     
@@ -226,7 +219,7 @@ int test_b()
     }
     else
     {
-        std::cerr << "Failed to save file information to: " << outputFileName << std::endl;
+        LOG_ERROR("Failed to save file information to: {}", outputFileName);
     }
     
     return 0;